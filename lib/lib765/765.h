@@ -50,6 +50,11 @@ extern "C" {
 #define SHORT_TIMEOUT   1000	/* Timeouts, in machine cycles */
 #define LONGER_TIMEOUT  1333333L
 
+/* Timing accuracy of the FDC, see fdc_set_timing() */
+#define FDC_TIMING_INSTANT 0	/* Phases start at once, as in older versions */
+#define FDC_TIMING_DEFAULT 1	/* Phases start after the timeouts above */
+#define FDC_TIMING_EXACT   2	/* Step rate and rotational latency */
+
 /* EXT: called by the FDC to print debugging messages
  * 
  * We assume that the normal debug level is 0. As we get more and more 
@@ -167,6 +172,42 @@ void	 fdd_setfilename(FDRV_PTR fd, const char *s);
  * FDC. It is intended for use by administration interfaces */
 fd_err_t fdd_new_dsk(FDRV_PTR fd);
 
+/* Subclass of FLOPPY_DRIVE: a drive whose disc is implemented by the host
+ * application. The host supplies a table of operations and a context
+ * pointer, which is passed back to every operation. The drive takes care
+ * of the motor, the read-only flag and the current cylinder; "cylinder"
+ * below is the cylinder under the head. */
+
+typedef struct fdh_ops
+{
+	/* No. of cylinders on the disc, or -1 if there is no disc */
+	int      (*fdh_cylinders)   (void *host);
+	fd_err_t (*fdh_read_id)     (void *host, int cylinder, int head,
+			int sector, fdc_byte *buf);
+	fd_err_t (*fdh_read_sector) (void *host, int cylinder, int xcylinder,
+			int xhead, int head, int sector, fdc_byte *buf,
+			int len, int *deleted, int skip_deleted, int mfm,
+			int multi);
+	fd_err_t (*fdh_read_track)  (void *host, int cylinder, int xcylinder,
+			int xhead, int head, fdc_byte *buf, int *len);
+	fd_err_t (*fdh_write_sector)(void *host, int cylinder, int xcylinder,
+			int xhead, int head, int sector, fdc_byte *buf,
+			int len, int deleted, int skip_deleted, int mfm,
+			int multi);
+	fd_err_t (*fdh_format_track)(void *host, int cylinder, int head,
+			int sectors, fdc_byte *track, fdc_byte filler);
+	/* ST1 / ST2 recorded for the last sector read */
+	void     (*fdh_sector_status)(void *host, fdc_byte *st1,
+			fdc_byte *st2);
+	int      (*fdh_dirty)       (void *host);
+	void     (*fdh_eject)       (void *host);
+} FDH_OPS;
+
+FDRV_PTR fd_newhost(const FDH_OPS *ops, void *host);
+
+/* Get the host context of this drive, NULL if it is not a host drive */
+void *   fdh_gethost(FDRV_PTR fd);
+
 
 #ifdef DSK_ERR_OK	/* LIBDSK headers included */
 /* Subclass of FLOPPY_DRIVE: a drive which emulates discs using LIBDSK
@@ -226,6 +267,10 @@ fd_err_t fd_seek_cylinder(FDRV_PTR fd, int cylinder);
  * which should increase every time you call this function, to simulate 
  * the rotation of the disc. Fills the buffer at "buf" with the sector ID. */
 fd_err_t fd_read_id(FDRV_PTR fd, int head, int sector, fdc_byte *buf);
+/* Return 1 if fd_read_id() returns the ID at position "sector" on the track
+ * of head "head", 0 if it only returns the next ID whatever "sector" is.
+ * Exact timings need the former. */
+int fd_indexed(FDRV_PTR fd, int head);
 /* Read a sector. xcylinder and xhead are values expected from the sector ID;
  * while "head" and "sector" are the actual place to look on the disc. 
  * Data will be returned to "buf", maximum "len" bytes. */
@@ -259,6 +304,9 @@ void fd_eject(FDRV_PTR fd);
 void fd_set_datarate(FDRV_PTR fd, fdc_byte rate);
 /* Reset the drive */
 void fd_reset(FDRV_PTR fd);
+/* Get the ST1 / ST2 flags recorded on the disc for the last sector read.
+ * Both are 0 for drives which do not record them. */
+void fd_sector_status(FDRV_PTR fd, fdc_byte *st1, fdc_byte *st2);
 
 
 
@@ -278,6 +326,22 @@ void fdc_set_terminal_count(FDC_PTR self, fdc_byte value);
 void fdc_set_motor(FDC_PTR self, fdc_byte running);
 /* Call this once every cycle round the emulator's main loop */
 void fdc_tick(FDC_PTR self);
+/* Or call this with the number of cycles elapsed since the last call... */
+void fdc_advance(FDC_PTR self, long cycles);
+/* ...and this to know how many cycles may elapse before the next call.
+ * Returns 0 if the FDC has nothing to wait for. */
+long fdc_next_event(FDC_PTR self);
+/* Set the timing accuracy (FDC_TIMING_*). 'rate' is the number of cycles
+ * per second, used by FDC_TIMING_EXACT. fdc_reset() sets it back to
+ * FDC_TIMING_INSTANT */
+void fdc_set_timing(FDC_PTR self, int timing, long rate);
+int  fdc_get_timing(FDC_PTR self);
+/* Save / restore the state of the FDC and of the motor, cylinder and
+ * changeline of its drives into a buffer of fdc_state_size() bytes. The
+ * drive pointers, the interrupt callback and the timing are left as is */
+size_t fdc_state_size(void);
+void fdc_save_state(FDC_PTR self, fdc_byte *data);
+void fdc_load_state(FDC_PTR self, const fdc_byte *data);
 /* Write to the Digital Output Register. Write -1 to disable DOR emulation */
 void fdc_write_dor(FDC_PTR self, int value);
 /* Read from the Digital Input Register. */
@@ -51,6 +51,17 @@ fd_err_t  fd_read_id(FDRV_PTR fd, int head, int sector, fdc_byte *buf)
 	return FD_E_NOTRDY;
 }
 
+/* Can READ ID address the IDs of the track by their position? Drives
+ * index them unless they say otherwise */
+int fd_indexed(FDRV_PTR fd, int head)
+{
+	if (fd && (fd->fd_vtable->fdv_indexed))
+	{
+		return (*fd->fd_vtable->fdv_indexed)(fd, head);
+	}
+	return 1;
+}
+
 /* Read a sector. xcylinder and xhead are the expected values for the 
  * sector header; head is the actual head to use. */
 fd_err_t  fd_read_sector(FDRV_PTR fd, int xcylinder, 
@@ -162,6 +173,14 @@ void fd_reset(FDRV_PTR fd)
 		(*fd->fd_vtable->fdv_reset)(fd);
 }
 
+/* Get the ST1 / ST2 flags of the last sector read */
+void fd_sector_status(FDRV_PTR fd, fdc_byte *st1, fdc_byte *st2)
+{
+	*st1 = *st2 = 0;
+	if (fd && (fd->fd_vtable->fdv_sector_status)) 
+		(*fd->fd_vtable->fdv_sector_status)(fd, st1, st2);
+}
+
 /* Set data rate */
 void fd_set_datarate(FDRV_PTR fd, fdc_byte rate)
 {
@@ -99,6 +99,9 @@ void fdc_reset(FDC_765 *self)
 	self->fdc_terminal_count = 0;
 	self->fdc_isr            = NULL;
 	self->fdc_isr_countdown  = 0L;
+	self->fdc_timing         = FDC_TIMING_INSTANT;
+	self->fdc_rate           = 0L;
+	self->fdc_rotation       = 0L;
 	self->fdc_dor		 = -1;	/* Not using the DOR at all */
 	memset(self->fdc_drive,     0, sizeof(self->fdc_drive));
 	fdc_part_reset(self);
@@ -172,6 +175,21 @@ static void fdc_xlt_error(FDC_765 *self, fd_err_t error)
 
 }
 
+/* Merge the ST1 / ST2 flags recorded on the disc for the last sector read,
+ * as extended DSK images do. Only the error bits are kept: CM is handled
+ * by the deleted data logic. */
+static void fdc_xlt_status(FDC_765 *self, FLOPPY_DRIVE *fd)
+{
+	fdc_byte st1, st2;
+
+	fd_sector_status(fd, &st1, &st2);
+	st1 &= 0x25;	/* DE, ND, MA */
+	st2 &= 0x21;	/* DD, MD */
+	if ((st1 & 0x05) || (st2 & 0x01)) self->fdc_st0 |= 0x40;
+	self->fdc_st1 |= st1;
+	self->fdc_st2 |= st2;
+}
+
 /* Fill out 7 result bytes
  * XXX Bytes 2,3,4,5 should change the way the real FDC does it. */
 static void fdc_results_7(FDC_765 *self)
@@ -221,6 +239,93 @@ static void fdc_exec_interrupt(FDC_765 *self)
         self->fdc_interrupting  = 2;    /* Execution-phase interrupt */
 }
 
+/* Delay before an interrupt: 'timeout' cycles, or the 'exact' number of 
+ * cycles worked out for FDC_TIMING_EXACT */
+static int fdc_delay(FDC_765 *self, long timeout, long exact)
+{
+	if (self->fdc_timing != FDC_TIMING_EXACT) return timeout;
+	return (exact > 0) ? exact : 1;
+}
+
+/* Is the FDC still waiting for the interrupt that starts the execution
+ * or the result phase? */
+static int fdc_waiting(FDC_765 *self)
+{
+	if (self->fdc_timing == FDC_TIMING_INSTANT) return 0;
+	if (self->fdc_isr_countdown <= 0) return 0;
+	return (self->fdc_interrupting == 1 || self->fdc_interrupting == 2);
+}
+
+/* Is a SEEK or RECALIBRATE still stepping? */
+static int fdc_seeking(FDC_765 *self)
+{
+	if (self->fdc_timing == FDC_TIMING_INSTANT) return 0;
+	return (self->fdc_interrupting == 4 && self->fdc_isr_countdown > 0);
+}
+
+/* The drives turn at 300rpm: cycles taken by one revolution */
+static long fdc_revolution(FDC_765 *self)
+{
+	return self->fdc_rate / 5;
+}
+
+/* Cycles until the given position on the track passes under the head */
+static long fdc_position_latency(FDC_765 *self, long position)
+{
+	long revolution = fdc_revolution(self);
+
+	return (position - self->fdc_rotation + revolution) % revolution;
+}
+
+/* Cycles taken to step the head. The step rate of the SPECIFY command
+ * is in 2ms units, as the Amstrad FDCs are clocked at 4MHz */
+static long fdc_step_latency(FDC_765 *self, int steps)
+{
+	long srt = 16 - ((self->fdc_specify[0] >> 4) & 0x0F);
+
+	if (steps < 0) steps = -steps;
+	return steps * srt * (self->fdc_rate / 500);
+}
+
+/* Number of sector IDs on the current track, 0 if none */
+static int fdc_count_ids(FDC_765 *self, FLOPPY_DRIVE *fd)
+{
+	fdc_byte first[4], id[4];
+	int n;
+
+	if (fd_read_id(fd, self->fdc_curhead, 0, first)) return 0;
+	for (n = 1; n < 256; n++)
+	{
+		if (fd_read_id(fd, self->fdc_curhead, n, id)) break;
+		if (!memcmp(id, first, 4)) break;
+	}
+	return n;
+}
+
+/* Cycles until the ID of a sector passes under the head. If there is no
+ * such sector, the FDC gives up at the second index pulse */
+static long fdc_sector_latency(FDC_765 *self, FLOPPY_DRIVE *fd, int sector)
+{
+	long revolution = fdc_revolution(self);
+	fdc_byte id[4];
+	int count, n;
+
+	if (self->fdc_timing != FDC_TIMING_EXACT || !fd) return 0;
+	/* The drive can't tell where the sector is: no rotational delay */
+	if (!fd_indexed(fd, self->fdc_curhead)) return 0;
+
+	count = fdc_count_ids(self, fd);
+	for (n = 0; n < count; n++)
+	{
+		if (fd_read_id(fd, self->fdc_curhead, n, id)) break;
+		if (id[2] == sector) 
+		{
+			return fdc_position_latency(self, revolution * n / count);
+		}
+	}
+	return 2 * revolution - self->fdc_rotation;
+}
+
 /* Compare two bytes - for the SCAN commands */
 static void fdc_scan_byte(FDC_765 *self, fdc_byte fdcbyte, fdc_byte cpubyte)
 {
@@ -387,6 +492,9 @@ static void fdc_read_track(FDC_765 *self)
 	}
 
         fdc_exec_interrupt(self);
+	if (self->fdc_timing == FDC_TIMING_EXACT)	/* Wait for the index */
+		self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+				fdc_position_latency(self, 0));
 	self->fdc_mainstat = 0xF0;	/* Ready to transfer data */
 	self->fdc_exec_pos = 0;
 }
@@ -421,6 +529,7 @@ static void fdc_read(FDC_765 *self, int deleted)
 	FLOPPY_DRIVE *fd;
 	int sector;
 	size_t lensector;
+	long latency;
 	fdc_byte *buf = self->fdc_exec_buf;
 
 	self->fdc_st0 = self->fdc_st1 = self->fdc_st2 = 0;
@@ -428,6 +537,8 @@ static void fdc_read(FDC_765 *self, int deleted)
 	
 	fdc_get_drive(self);	
 
+	latency = fdc_sector_latency(self, self->fdc_dor_drive[self->fdc_curunit],
+			self->fdc_cmd_buf[4]);
 	self->fdc_exec_len = 0;
 	/* 0.4.0: Support for multisector reads. Do it naively by reading
 	 * all the sectors in one go. */
@@ -460,6 +571,7 @@ static void fdc_read(FDC_765 *self, int deleted)
 		{
 			break;
 		}
+		fdc_xlt_status(self, fd);
 		buf += lensector;
 		self->fdc_exec_len += lensector;
 		++self->fdc_cmd_buf[4];		/* Next sector */
@@ -469,10 +581,12 @@ static void fdc_read(FDC_765 *self, int deleted)
 	{
 		fdc_end_execution_phase(self);
 		fdc_result_interrupt(self);
+		self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT, latency);
 		return;
 	}
 
         fdc_exec_interrupt(self);
+	self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT, latency);
 	self->fdc_mainstat = 0xF0;	/* Ready to transfer data */
 	self->fdc_exec_pos = 0;
 }
@@ -517,6 +631,8 @@ static void fdc_write(FDC_765 *self, int deleted)
 	else
 	{
 		fdc_exec_interrupt(self);
+		self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+			fdc_sector_latency(self, fd, self->fdc_cmd_buf[4]));
 		self->fdc_mainstat = 0xB0;	/* Ready to receive data */
 		self->fdc_exec_pos = 0;
 	}
@@ -541,6 +657,9 @@ static void fdc_recalibrate(FDC_765 *self)
 	self->fdc_st2 &= 0xFD;
 	self->fdc_st0 |= 0x20;
 
+	if (fd) self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+			fdc_step_latency(self, fd->fd_cylinder));
+
 	/* Seek the drive to track 0 */
         if (!fdc_isready(self, fd))
         {
@@ -557,7 +676,7 @@ static void fdc_recalibrate(FDC_765 *self)
 /* SENSE INTERRUPT STATUS */
 static void fdc_sense_int(FDC_765 *self)
 {
-        if (self->fdc_interrupting > 2) 
+        if (self->fdc_interrupting > 2 && !fdc_seeking(self)) 
 		/* FDC interrupted, and is ready to return status */
         {
 		fdc_byte cyl = 0;
@@ -572,13 +691,17 @@ static void fdc_sense_int(FDC_765 *self)
         }
         else    /* FDC did not interrupt, error */
         {
-                self->fdc_st0 = 0x80;
-		self->fdc_result_buf[0] = self->fdc_st0;
+		/* Keep ST0 for the end of a seek still in progress */
+                if (!fdc_seeking(self)) self->fdc_st0 = 0x80;
+		self->fdc_result_buf[0] = 0x80;
                 self->fdc_result_len = 1;
 		fdc_dprintf(7, "SENSE INTERRUPT STATUS: Return 0x80\n");
         }
 	fdc_end_execution_phase(self);
 
+	/* Still seeking: the interrupt is yet to come */
+	if (fdc_seeking(self)) return;
+
 	/* Drop the interrupt line */
         self->fdc_isr_countdown = 0;
         self->fdc_interrupting = 0;
@@ -595,6 +718,7 @@ static void fdc_read_id(FDC_765 *self)
 {
         FLOPPY_DRIVE *fd;
 	int ret;
+	long latency = 0;
 
 	self->fdc_result_len = 7;
 	self->fdc_st0 = self->fdc_st1 = self->fdc_st2 = 0;
@@ -609,6 +733,21 @@ static void fdc_read_id(FDC_765 *self)
         }
 	else
 	{
+		if (self->fdc_timing == FDC_TIMING_EXACT &&
+		    fd_indexed(fd, self->fdc_curhead))
+		{
+			/* Return the next ID to pass under the head */
+			long revolution = fdc_revolution(self);
+			int count = fdc_count_ids(self, fd);
+
+			if (count > 0)
+			{
+				self->fdc_lastidread = ((self->fdc_rotation * 
+					count + revolution - 1) / revolution) % count;
+				latency = fdc_position_latency(self, 
+					revolution * self->fdc_lastidread / count);
+			}
+		}
 		ret=(*fd->fd_vtable->fdv_read_id)(fd, self->fdc_curhead,
 				self->fdc_lastidread++, self->fdc_cmd_buf + 2);
 
@@ -625,6 +764,7 @@ static void fdc_read_id(FDC_765 *self)
 	}
 	fdc_results_7(self);
 	fdc_result_interrupt(self);
+	self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT, latency);
 	fdc_end_execution_phase(self);
 }
 
@@ -659,6 +799,9 @@ static void fdc_format(FDC_765 *self)
 	else
 	{
 		fdc_exec_interrupt(self);
+		if (self->fdc_timing == FDC_TIMING_EXACT) /* Wait for the index */
+			self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+				fdc_position_latency(self, 0));
 		self->fdc_mainstat = 0xB0;	/* Ready to receive data */
 		self->fdc_exec_pos = 0;
 		self->fdc_exec_len = 4 * self->fdc_cmd_buf[3];
@@ -682,6 +825,8 @@ static void fdc_seek(FDC_765 *self)
 	self->fdc_st0 |= 0x20;
 
 	fd = self->fdc_dor_drive[self->fdc_curunit];
+	if (fd) self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+			fdc_step_latency(self, cylinder - fd->fd_cylinder));
 
         if (!fdc_isready(self, fd))
         {
@@ -736,6 +881,9 @@ static void fdc_scan(FDC_765 *self)
                 return;
         }
         fdc_exec_interrupt(self);
+	self->fdc_isr_countdown = fdc_delay(self, SHORT_TIMEOUT,
+		fdc_sector_latency(self, self->fdc_dor_drive[self->fdc_curunit],
+			self->fdc_cmd_buf[4]));
 	self->fdc_st2 |= 8;
         self->fdc_mainstat = 0xB0;      /* Ready to transfer data */
 	self->fdc_exec_pos = 0;
@@ -918,8 +1066,12 @@ fdc_byte fdc_read_data (FDC_765 *self)
 /* Read the FDC's main control register */
 fdc_byte fdc_read_ctrl (FDC_765 *self)
 {
-	fdc_dprintf(5, "FDC: Read main status: %02x\n", self->fdc_mainstat);
-	return self->fdc_mainstat;
+	fdc_byte value = self->fdc_mainstat;
+
+	/* Not ready until the execution or result phase has started */
+	if (fdc_waiting(self)) value &= 0x7F;
+	fdc_dprintf(5, "FDC: Read main status: %02x\n", value);
+	return value;
 }
 
 
@@ -1002,6 +1154,137 @@ void fdc_tick(FDC_765 *self)
 }
 
 
+/* Same as calling fdc_tick() 'cycles' times */
+void fdc_advance(FDC_765 *self, long cycles)
+{
+	long revolution = fdc_revolution(self);
+
+	if (cycles <= 0) return;
+	if (revolution > 0)
+		self->fdc_rotation = (self->fdc_rotation + cycles) % revolution;
+	if (!self->fdc_isr_countdown) return;
+	if (cycles < self->fdc_isr_countdown)
+	{
+		self->fdc_isr_countdown -= cycles;
+		return;
+	}
+	self->fdc_isr_countdown = 1;
+	fdc_tick(self);
+}
+
+
+/* Cycles before the next interrupt or, while a motor is running in 
+ * FDC_TIMING_EXACT mode, before the next index pulse */
+long fdc_next_event(FDC_765 *self)
+{
+	long next = self->fdc_isr_countdown;
+	long revolution = fdc_revolution(self);
+	int n;
+
+	if (revolution <= 0) return next;
+	for (n = 0; n < 4; n++)
+	{
+		if (self->fdc_drive[n] && self->fdc_drive[n]->fd_motor)
+		{
+			long index = revolution - self->fdc_rotation;
+			if (!next || index < next) next = index;
+			break;
+		}
+	}
+	return next;
+}
+
+
+void fdc_set_timing(FDC_765 *self, int timing, long rate)
+{
+	/* Exact timings can't be worked out without the rate */
+	if (timing == FDC_TIMING_EXACT && rate < 500) timing = FDC_TIMING_DEFAULT;
+
+	self->fdc_timing   = timing;
+	self->fdc_rate     = (timing == FDC_TIMING_EXACT) ? rate : 0L;
+	self->fdc_rotation = 0L;
+}
+
+
+int fdc_get_timing(FDC_765 *self)
+{
+	return self->fdc_timing;
+}
+
+
+/* The drive state saved alongside the controller */
+typedef struct fdc_drive_state
+{
+	int fds_motor;
+	int fds_cylinder;
+	int fds_changed;
+} FDC_DRIVE_STATE;
+
+
+size_t fdc_state_size(void)
+{
+	return sizeof(FDC_765) + 4 * sizeof(FDC_DRIVE_STATE);
+}
+
+
+void fdc_save_state(FDC_765 *self, fdc_byte *data)
+{
+	FDC_DRIVE_STATE drive;
+	int n;
+
+	memcpy(data, self, sizeof(FDC_765));
+	data += sizeof(FDC_765);
+	for (n = 0; n < 4; n++)
+	{
+		FLOPPY_DRIVE *fd = self->fdc_drive[n];
+
+		memset(&drive, 0, sizeof(drive));
+		if (fd)
+		{
+			drive.fds_motor    = fd->fd_motor;
+			drive.fds_cylinder = fd->fd_cylinder;
+			drive.fds_changed  = fd->fd_changed;
+		}
+		memcpy(data, &drive, sizeof(drive));
+		data += sizeof(drive);
+	}
+}
+
+
+void fdc_load_state(FDC_765 *self, const fdc_byte *data)
+{
+	FDC_DRIVE_STATE drive;
+	FDC_765 saved = *self;
+	int n;
+
+	memcpy(self, data, sizeof(FDC_765));
+	data += sizeof(FDC_765);
+	/* Keep what belongs to the host rather than to the controller */
+	self->fdc_isr    = saved.fdc_isr;
+	self->fdc_timing = saved.fdc_timing;
+	self->fdc_rate   = saved.fdc_rate;
+	for (n = 0; n < 4; n++) self->fdc_drive[n] = saved.fdc_drive[n];
+	fdc_dorcheck(self);
+
+	for (n = 0; n < 4; n++)
+	{
+		FLOPPY_DRIVE *fd = self->fdc_drive[n];
+
+		memcpy(&drive, data, sizeof(drive));
+		data += sizeof(drive);
+		if (!fd) continue;
+		fd->fd_motor   = drive.fds_motor;
+		fd->fd_changed = drive.fds_changed;
+		/* Seek so that the drive drops what it cached of the old track */
+		if (fd->fd_cylinder != drive.fds_cylinder)
+		{
+			fd_seek_cylinder(fd, drive.fds_cylinder);
+			fd->fd_cylinder = drive.fds_cylinder;
+		}
+	}
+}
+
+
 /* Simulate the Digital Output Register in the IBM PC and clones
  * This is not part of the uPD765A itself, but part of the support 
  * circuitry.
@@ -0,0 +1,230 @@
+/*
+ * 765host.c - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "765i.h"
+
+/* This drive hands every disc access over to the host application, which
+ * keeps the disc image itself. The drive only deals with the motor, the
+ * read-only flag and the current cylinder, so that the host does not have
+ * to know about the FDC.
+ */
+
+extern fdc_byte fdd_drive_status(FLOPPY_DRIVE *fd);
+
+static FLOPPY_DRIVE_VTABLE fdv_host;
+
+
+/* No. of cylinders on the disc in the drive, -1 if no disc */
+static int host_cylinders(HOST_FLOPPY_DRIVE *fdh)
+{
+	return (*fdh->fdh_ops->fdh_cylinders)(fdh->fdh_host);
+}
+
+
+/* Return 1 if this drive is ready, else 0 */
+static int host_isready(FLOPPY_DRIVE *fd)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	if (!fd->fd_motor) return 0;	/* Motor is not running */
+
+	return host_cylinders(fdh) >= 0;
+}
+
+
+/* Seek to a cylinder. Allows one cylinder past the end of the disc, so
+ * that it can be formatted. */
+static fd_err_t host_seek_cylinder(FLOPPY_DRIVE *fd, int cylinder)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+	int cylinders = host_cylinders(fdh);
+
+	fdc_dprintf(4, "host_seek_cylinder: cylinder=%d\n", cylinder);
+
+	if (cylinders < 0)        return FD_E_NOTRDY;
+	if (cylinder > cylinders) return FD_E_SEEKFAIL;
+
+	fd->fd_cylinder = cylinder;
+	return 0;
+}
+
+
+/* Read a sector ID from the current track */
+static fd_err_t host_read_id(FLOPPY_DRIVE *fd, int head, int sector,
+		fdc_byte *buf)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	fdc_dprintf(4, "host_read_id: head=%d\n", head);
+
+	if (host_cylinders(fdh) < 0) return FD_E_NOTRDY;
+
+	return (*fdh->fdh_ops->fdh_read_id)(fdh->fdh_host, fd->fd_cylinder,
+			head, sector, buf);
+}
+
+
+/* Read a sector */
+static fd_err_t host_read_sector(FLOPPY_DRIVE *fd, int xcylinder, int xhead,
+		int head, int sector, fdc_byte *buf, int len, int *deleted,
+		int skip_deleted, int mfm, int multi)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	fdc_dprintf(4, "host_read_sector: cyl=%d xc=%d xh=%d h=%d s=%d "
+		"len=%d\n", fd->fd_cylinder, xcylinder, xhead, head, sector,
+		len);
+
+	if (host_cylinders(fdh) < 0) return FD_E_NOTRDY;
+
+	return (*fdh->fdh_ops->fdh_read_sector)(fdh->fdh_host,
+			fd->fd_cylinder, xcylinder, xhead, head, sector,
+			buf, len, deleted, skip_deleted, mfm, multi);
+}
+
+
+/* Read a track */
+static fd_err_t host_read_track(FLOPPY_DRIVE *fd, int xcylinder, int xhead,
+		int head, fdc_byte *buf, int *len)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	fdc_dprintf(4, "host_read_track: xc=%d xh=%d h=%d\n",
+			xcylinder, xhead, head);
+
+	if (host_cylinders(fdh) < 0) return FD_E_NOTRDY;
+
+	return (*fdh->fdh_ops->fdh_read_track)(fdh->fdh_host,
+			fd->fd_cylinder, xcylinder, xhead, head, buf, len);
+}
+
+
+/* Write a sector */
+static fd_err_t host_write_sector(FLOPPY_DRIVE *fd, int xcylinder, int xhead,
+		int head, int sector, fdc_byte *buf, int len, int deleted,
+		int skip_deleted, int mfm, int multi)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	fdc_dprintf(4, "host_write_sector: xc=%d xh=%d h=%d s=%d\n",
+			xcylinder, xhead, head, sector);
+
+	if (host_cylinders(fdh) < 0) return FD_E_NOTRDY;
+	if (fd->fd_readonly)         return FD_E_READONLY;
+
+	return (*fdh->fdh_ops->fdh_write_sector)(fdh->fdh_host,
+			fd->fd_cylinder, xcylinder, xhead, head, sector,
+			buf, len, deleted, skip_deleted, mfm, multi);
+}
+
+
+/* Format the current track */
+static fd_err_t host_format_track(FLOPPY_DRIVE *fd, int head,
+		int sectors, fdc_byte *track, fdc_byte filler)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	fdc_dprintf(4, "host_format_track: cyl=%d h=%d s=%d\n",
+			fd->fd_cylinder, head, sectors);
+
+	if (host_cylinders(fdh) < 0) return FD_E_NOTRDY;
+	if (fd->fd_readonly)         return FD_E_READONLY;
+
+	return (*fdh->fdh_ops->fdh_format_track)(fdh->fdh_host,
+			fd->fd_cylinder, head, sectors, track, filler);
+}
+
+
+/* ST1 / ST2 recorded for the last sector read */
+static void host_sector_status(FLOPPY_DRIVE *fd, fdc_byte *st1, fdc_byte *st2)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	if (fdh->fdh_ops->fdh_sector_status)
+		(*fdh->fdh_ops->fdh_sector_status)(fdh->fdh_host, st1, st2);
+}
+
+
+/* Has this floppy been written to since it was inserted? */
+static int host_dirty(FLOPPY_DRIVE *fd)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	if (!fdh->fdh_ops->fdh_dirty) return FD_D_UNAVAILABLE;
+
+	return (*fdh->fdh_ops->fdh_dirty)(fdh->fdh_host) ? FD_D_DIRTY
+							 : FD_D_CLEAN;
+}
+
+
+/* Eject the disc: the host writes it back and forgets it */
+static void host_eject(FLOPPY_DRIVE *fd)
+{
+	HOST_FLOPPY_DRIVE *fdh = (HOST_FLOPPY_DRIVE *)fd;
+
+	if (fdh->fdh_ops->fdh_eject)
+		(*fdh->fdh_ops->fdh_eject)(fdh->fdh_host);
+}
+
+
+static FLOPPY_DRIVE_VTABLE fdv_host =
+{
+	host_seek_cylinder,
+	host_read_id,
+	host_read_sector,
+	host_read_track,
+	host_write_sector,
+	host_format_track,
+	fdd_drive_status,
+	host_isready,
+	host_dirty,
+	host_eject,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	host_sector_status
+};
+
+/* Initialise a host drive */
+FDRV_PTR fd_newhost(const FDH_OPS *ops, void *host)
+{
+	FDRV_PTR fd;
+	HOST_FLOPPY_DRIVE *fdh;
+
+	if (!ops) return NULL;
+
+	fd = fd_inew(sizeof(HOST_FLOPPY_DRIVE));
+	if (!fd) return NULL;
+
+	fdh = (HOST_FLOPPY_DRIVE *)fd;
+	fdh->fdh_ops  = ops;
+	fdh->fdh_host = host;
+
+	fd->fd_vtable = &fdv_host;
+	return fd;
+}
+
+
+/* Get the host context of this drive */
+void *   fdh_gethost(FDRV_PTR fd)
+{
+	if (fd && fd->fd_vtable == &fdv_host)
+	{
+		return ((HOST_FLOPPY_DRIVE *)fd)->fdh_host;
+	}
+	return NULL;
+}
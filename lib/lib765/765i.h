@@ -53,6 +53,9 @@ typedef struct floppy_drive_vtable
 	void     (*fdv_reset  )(FDRV_PTR fd);
 	void     (*fdv_destroy)(FDRV_PTR fd);
 	int	 (*fdv_changed)(FDRV_PTR fd);
+	void     (*fdv_sector_status)(FDRV_PTR fd, fdc_byte *st1,
+		fdc_byte *st2);
+	int      (*fdv_indexed)(FDRV_PTR fd, int head);
 } FLOPPY_DRIVE_VTABLE;
 
 
@@ -103,6 +106,21 @@ typedef struct dsk_floppy_drive
 } DSK_FLOPPY_DRIVE;
 
 #ifdef DSK_ERR_OK	/* LIBDSK headers included */
+#define LDSK_MAX_SECTORS 64
+
+/* A track read ahead through LIBDSK: the sector IDs in the order they pass
+ * under the head, and the data of the sectors that could be read */
+typedef struct ldsk_track_cache
+{
+	int ltc_valid;		/* 1 if loaded, -1 if the track can't be cached,
+				 * 0 if it has not been loaded yet */
+	int ltc_count;		/* No. of sector IDs on the track */
+	DSK_FORMAT ltc_ids[LDSK_MAX_SECTORS];	 /* Sector IDs */
+	int    ltc_cached[LDSK_MAX_SECTORS];	 /* Is the sector data cached? */
+	size_t ltc_offset[LDSK_MAX_SECTORS];	 /* Offset of the sector data */
+	fdc_byte *ltc_data;	/* Sector data, NULL if none */
+} LDSK_TRACK_CACHE;
+
 typedef struct libdsk_floppy_drive
 {
 /* PUBLIC variables: */
@@ -115,9 +133,22 @@ typedef struct libdsk_floppy_drive
 /* PRIVATE variables: */
 	DSK_PDRIVER  fdl_diskp;	
 	DSK_GEOMETRY fdl_diskg;		/* Autoprobed geometry */
+	LDSK_TRACK_CACHE fdl_cache[2];	/* Current track, one per head */
 } LIBDSK_FLOPPY_DRIVE;
 #endif	/* ifdef DSK_ERR_OK */
 
+/* Subclass of FLOPPY_DRIVE: a drive whose disc is implemented by the host
+ * application, through a table of operations */
+
+typedef struct host_floppy_drive
+{
+/* PUBLIC variables: */
+	FLOPPY_DRIVE fdh;		/* Base class */
+/* PRIVATE variables: */
+	const FDH_OPS *fdh_ops;		/* Host operations */
+	void *fdh_host;			/* Host context */
+} HOST_FLOPPY_DRIVE;
+
 typedef struct nc9_floppy_drive
 {
 	FLOPPY_DRIVE fdd;		/* Base class */
@@ -169,6 +200,9 @@ typedef struct fdc_765
 
 	int fdc_terminal_count;	/* Set to abort a transfer */	
 	int fdc_isr_countdown;	/* Countdown to interrupt */
+	int fdc_timing;		/* Timing accuracy, FDC_TIMING_* */
+	long fdc_rate;		/* Cycles per second */
+	long fdc_rotation;	/* Cycles since the last index pulse */
 
 	int fdc_dor;		/* Are we using that horrible kludge, the
 				 * Digital Output Register, rather than
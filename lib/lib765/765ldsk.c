@@ -32,10 +32,94 @@
 extern fdc_byte fdd_drive_status(FLOPPY_DRIVE *fd);
 
 
+/* Forget the tracks read ahead. Called on seek, on write and on eject */
+static void fdl_cache_clear(LIBDSK_FLOPPY_DRIVE *fdl)
+{
+	int head;
+
+	for (head = 0; head < 2; head++)
+	{
+		LDSK_TRACK_CACHE *ltc = &fdl->fdl_cache[head];
+
+		if (ltc->ltc_data) free(ltc->ltc_data);
+		ltc->ltc_data  = NULL;
+		ltc->ltc_valid = 0;
+		ltc->ltc_count = 0;
+	}
+}
+
+
+/* Read the current track of a head: one turn of sector IDs, then the data
+ * of each sector. Tracks with repeated sector IDs are left to LIBDSK, and
+ * so are the sectors which can't be read cleanly (deleted data, CRC errors
+ * or weak sectors), so that they behave exactly as before. */
+static LDSK_TRACK_CACHE *fdl_cache_load(LIBDSK_FLOPPY_DRIVE *fdl, int head)
+{
+	LDSK_TRACK_CACHE *ltc = &fdl->fdl_cache[head & 1];
+	FLOPPY_DRIVE *fd = &fdl->fdl;
+	DSK_GEOMETRY dg;
+	DSK_FORMAT fmt, *ids = ltc->ltc_ids;
+	size_t total;
+	int n, m, deleted;
+	dsk_err_t err;
+
+	if (ltc->ltc_valid) return (ltc->ltc_valid > 0) ? ltc : NULL;
+
+	ltc->ltc_valid = -1;
+	for (;;)
+	{
+		err = dsk_psecid(fdl->fdl_diskp, &fdl->fdl_diskg,
+				fd->fd_cylinder, head, &fmt);
+		if (err) return NULL;
+		if (ltc->ltc_count &&
+		    fmt.fmt_cylinder == ids[0].fmt_cylinder &&
+		    fmt.fmt_head     == ids[0].fmt_head &&
+		    fmt.fmt_sector   == ids[0].fmt_sector &&
+		    fmt.fmt_secsize  == ids[0].fmt_secsize) break;
+		if (ltc->ltc_count >= LDSK_MAX_SECTORS) return NULL;
+		for (m = 0; m < ltc->ltc_count; m++)
+		{
+			if (fmt.fmt_cylinder == ids[m].fmt_cylinder &&
+			    fmt.fmt_head     == ids[m].fmt_head &&
+			    fmt.fmt_sector   == ids[m].fmt_sector) return NULL;
+		}
+		ids[ltc->ltc_count++] = fmt;
+	}
+
+	total = 0;
+	for (n = 0; n < ltc->ltc_count; n++)
+	{
+		ltc->ltc_offset[n] = total;
+		total += ids[n].fmt_secsize;
+	}
+	ltc->ltc_data = malloc(total);
+	if (!ltc->ltc_data) return NULL;
+
+	memcpy(&dg, &fdl->fdl_diskg, sizeof(dg));
+	dg.dg_noskip  = 1;
+	dg.dg_fm      = 0;
+	dg.dg_nomulti = 1;
+	for (n = 0; n < ltc->ltc_count; n++)
+	{
+		deleted = 0;
+		err = dsk_xread(fdl->fdl_diskp, &dg,
+			ltc->ltc_data + ltc->ltc_offset[n], fd->fd_cylinder,
+			head, ids[n].fmt_cylinder, ids[n].fmt_head,
+			ids[n].fmt_sector, ids[n].fmt_secsize, &deleted);
+		ltc->ltc_cached[n] = (err == DSK_ERR_OK && !deleted);
+	}
+	fdc_dprintf(4, "fdl_cache_load: cyl=%d h=%d sectors=%d\n",
+			fd->fd_cylinder, head, ltc->ltc_count);
+	ltc->ltc_valid = 1;
+	return ltc;
+}
+
+
 /* Reset variables: No DSK loaded. Called on eject and on initialisation */
 void fdl_reset(FLOPPY_DRIVE *fd)
 {
 	LIBDSK_FLOPPY_DRIVE *fdl = (LIBDSK_FLOPPY_DRIVE *)fd;
+	fdl_cache_clear(fdl);
         fdl->fdl_filename[0] = 0;	
 	fdl->fdl_type = NULL;
 	fdl->fdl_compress = NULL;
@@ -125,23 +209,48 @@ static fd_err_t fdl_seek_cylinder(FLOPPY_DRIVE *fd, int cylinder)
 	if (err == DSK_ERR_NOTIMPL || err == DSK_ERR_OK)
 	{
 		fdc_dprintf(6, "fdl_seek_cylinder: OK\n");
+		if (fd->fd_cylinder != req_cyl) fdl_cache_clear(fdl);
 		fd->fd_cylinder = req_cyl;	
 		return 0;
 	}
+	fdl_cache_clear(fdl);
 	fdc_dprintf(6, "fdl_seek_cylinder: fails, LIBDSK error %d\n", err);
 	/* Check if the DSK image goes out to the correct cylinder */
 	return fdl_xlt_error(err);
 }
 
+/* Only the IDs of a cached track can be read by their position: LIBDSK
+ * itself returns the next ID whatever is asked */
+static int fdl_indexed(FLOPPY_DRIVE *fd, int head)
+{
+	LIBDSK_FLOPPY_DRIVE *fdl = (LIBDSK_FLOPPY_DRIVE *)fd;
+
+	if (!fdl->fdl_diskp) return 1;
+	return fdl_cache_load(fdl, head) != NULL;
+}
+
 /* Read a sector ID from the current track */
 static fd_err_t fdl_read_id(FLOPPY_DRIVE *fd, int head, int sector, fdc_byte *buf)
 {
 	LIBDSK_FLOPPY_DRIVE *fdl = (LIBDSK_FLOPPY_DRIVE *)fd;
+	LDSK_TRACK_CACHE *ltc;
 	dsk_err_t err;
 	DSK_FORMAT fmt;
 
 	fdc_dprintf(4, "fdl_read_id: head=%d\n", head);
 	if (!fdl->fdl_diskp) return FD_E_NOTRDY;
+
+	ltc = fdl_cache_load(fdl, head);
+	if (ltc)
+	{
+		DSK_FORMAT *id = &ltc->ltc_ids[(unsigned)sector % ltc->ltc_count];
+
+		buf[0] = id->fmt_cylinder;
+		buf[1] = id->fmt_head;
+		buf[2] = id->fmt_sector;
+		buf[3] = dsk_get_psh(id->fmt_secsize);
+		return 0;
+	}
 	err = dsk_psecid(fdl->fdl_diskp, &fdl->fdl_diskg, fd->fd_cylinder,
 			 head, &fmt);
 	if (err == DSK_ERR_NOTIMPL)
@@ -168,12 +277,30 @@ static fd_err_t fdl_read_sector(FLOPPY_DRIVE *fd, int xcylinder, int xhead,
 		int skip_deleted, int mfm, int multi)
 {
 	LIBDSK_FLOPPY_DRIVE *fdl = (LIBDSK_FLOPPY_DRIVE *)fd;
+	LDSK_TRACK_CACHE *ltc;
 	dsk_err_t err;
+	int n;
 
 	fdc_dprintf(4, "fdl_read_sector: cyl=%d xc=%d xh=%d h=%d s=%d len=%d\n", 
 			fd->fd_cylinder, xcylinder, xhead, head, sector, len);
 	if (!fdl->fdl_diskp) return FD_E_NOTRDY;
 
+	/* Plain MFM reads of a clean sector are served from the track cache */
+	ltc = (mfm && !(deleted && *deleted)) ? fdl_cache_load(fdl, head) : NULL;
+	for (n = 0; ltc && n < ltc->ltc_count; n++)
+	{
+		DSK_FORMAT *id = &ltc->ltc_ids[n];
+
+		if (id->fmt_sector   != (dsk_psect_t)sector ||
+		    id->fmt_cylinder != (dsk_pcyl_t)xcylinder ||
+		    id->fmt_head     != (dsk_phead_t)xhead) continue;
+		if (!ltc->ltc_cached[n] || id->fmt_secsize != (size_t)len) break;
+
+		memcpy(buf, ltc->ltc_data + ltc->ltc_offset[n], len);
+		if (deleted) *deleted = 0;
+		return FD_E_OK;
+	}
+
 	fdl->fdl_diskg.dg_noskip  = skip_deleted ? 0 : 1;
 	fdl->fdl_diskg.dg_fm      = mfm ? 0 : 1;
 	fdl->fdl_diskg.dg_nomulti = multi ? 0 : 1;
@@ -223,6 +350,8 @@ static fd_err_t fdl_write_sector(FLOPPY_DRIVE *fd, int xcylinder, int xhead,
 			xcylinder, xhead, head, sector);
 	if (!fdl->fdl_diskp) return FD_E_NOTRDY;
 
+	fdl_cache_clear(fdl);
+
 	fdl->fdl_diskg.dg_noskip  = skip_deleted ? 0 : 1;
 /* lib765 0.3.3: Oops. Get the FM/MFM flag round the right way. */
 	fdl->fdl_diskg.dg_fm      = mfm ? 0 : 1;
@@ -252,6 +381,8 @@ static fd_err_t fdl_format_track(FLOPPY_DRIVE *fd, int head,
 			fd->fd_cylinder, head, sectors);
 	if (!fdl->fdl_diskp) return FD_E_NOTRDY;
 
+	fdl_cache_clear(fdl);
+
 	formbuf = malloc(sectors * sizeof(DSK_FORMAT));
 	if (!formbuf) return FD_E_READONLY;
 
@@ -381,7 +512,10 @@ static FLOPPY_DRIVE_VTABLE fdv_libdsk =
 	fdl_eject,
 	fdl_set_datarate,
 	NULL,
-	fdl_reset
+	fdl_reset,
+	NULL,
+	NULL,
+	fdl_indexed
 };
 
 /* Initialise a DSK-based drive */
@@ -390,6 +524,8 @@ FDRV_PTR fd_newldsk(void)
 	FDRV_PTR fd = fd_inew(sizeof(LIBDSK_FLOPPY_DRIVE));
 
 	fd->fd_vtable = &fdv_libdsk;
+	memset(((LIBDSK_FLOPPY_DRIVE *)fd)->fdl_cache, 0,
+		sizeof(((LIBDSK_FLOPPY_DRIVE *)fd)->fdl_cache));
 	fdl_reset(fd);
 	return fd;
 	}
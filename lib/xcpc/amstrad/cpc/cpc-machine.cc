@@ -42,7 +42,7 @@ namespace cpc {
 
 Machine::Machine(Settings& settings)
     : xcpc::Machine()
-    , _audio()
+    , _audio(settings.opt_audio)
     , _backend()
     , _mainboard(*this, settings)
 {
@@ -108,6 +108,86 @@ auto Machine::save_snapshot(const std::string& filename) -> void
     return _mainboard.save_snapshot(filename);
 }
 
+auto Machine::serialize(Buffer& buffer) -> void
+{
+    return _mainboard.serialize(buffer);
+}
+
+auto Machine::deserialize(const Buffer& buffer) -> void
+{
+    return _mainboard.deserialize(buffer);
+}
+
+auto Machine::save_checkpoint(Checkpoint& checkpoint) -> void
+{
+    return _mainboard.save_checkpoint(checkpoint);
+}
+
+auto Machine::load_checkpoint(const Checkpoint& checkpoint) -> void
+{
+    return _mainboard.load_checkpoint(checkpoint);
+}
+
+auto Machine::rewind() -> bool
+{
+    return _mainboard.rewind();
+}
+
+auto Machine::quick_save(const unsigned slot) -> void
+{
+    return _mainboard.quick_save(slot);
+}
+
+auto Machine::quick_load(const unsigned slot) -> bool
+{
+    return _mainboard.quick_load(slot);
+}
+
+auto Machine::digest_frame(FrameDigest& digest) -> void
+{
+    return _mainboard.digest_frame(digest);
+}
+
+auto Machine::start_psg_log(const std::string& filename) -> void
+{
+    return _mainboard.start_psg_log(filename);
+}
+
+auto Machine::stop_psg_log() -> void
+{
+    return _mainboard.stop_psg_log();
+}
+
+auto Machine::start_audio_capture(const std::string& filename, const std::string& format) -> void
+{
+    return _mainboard.start_audio_capture(filename, format);
+}
+
+auto Machine::stop_audio_capture() -> void
+{
+    return _mainboard.stop_audio_capture();
+}
+
+auto Machine::start_movie_record(const std::string& filename) -> void
+{
+    return _mainboard.start_movie_record(filename);
+}
+
+auto Machine::stop_movie_record() -> void
+{
+    return _mainboard.stop_movie_record();
+}
+
+auto Machine::start_movie_replay(const std::string& filename) -> void
+{
+    return _mainboard.start_movie_replay(filename);
+}
+
+auto Machine::stop_movie_replay() -> void
+{
+    return _mainboard.stop_movie_replay();
+}
+
 auto Machine::create_disk_into_drive0(const std::string& filename) -> void
 {
     return _mainboard.create_disk_into_drive0(filename);
@@ -123,6 +203,11 @@ auto Machine::remove_disk_from_drive0() -> void
     return _mainboard.remove_disk_from_drive0();
 }
 
+auto Machine::flush_disk_in_drive0() -> void
+{
+    return _mainboard.flush_disk_in_drive0();
+}
+
 auto Machine::create_disk_into_drive1(const std::string& filename) -> void
 {
     return _mainboard.create_disk_into_drive1(filename);
@@ -138,6 +223,11 @@ auto Machine::remove_disk_from_drive1() -> void
     return _mainboard.remove_disk_from_drive1();
 }
 
+auto Machine::flush_disk_in_drive1() -> void
+{
+    return _mainboard.flush_disk_in_drive1();
+}
+
 auto Machine::set_volume(const float volume) -> void
 {
     return _mainboard.set_volume(volume);
@@ -228,6 +318,11 @@ auto Machine::get_statistics() const -> std::string
     return _mainboard.get_statistics();
 }
 
+auto Machine::get_audio_statistics() const -> AudioStats
+{
+    return _mainboard.get_audio_statistics();
+}
+
 auto Machine::get_backend() const -> const Backend*
 {
     return &_backend;
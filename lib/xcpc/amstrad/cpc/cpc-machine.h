@@ -51,18 +51,54 @@ public: // public interface
 
     auto save_snapshot(const std::string& filename) -> void;
 
+    auto serialize(Buffer& buffer) -> void;
+
+    auto deserialize(const Buffer& buffer) -> void;
+
+    auto save_checkpoint(Checkpoint& checkpoint) -> void;
+
+    auto load_checkpoint(const Checkpoint& checkpoint) -> void;
+
+    auto rewind() -> bool;
+
+    auto quick_save(const unsigned slot) -> void;
+
+    auto quick_load(const unsigned slot) -> bool;
+
+    auto digest_frame(FrameDigest& digest) -> void;
+
+    auto start_psg_log(const std::string& filename) -> void;
+
+    auto stop_psg_log() -> void;
+
+    auto start_audio_capture(const std::string& filename, const std::string& format) -> void;
+
+    auto stop_audio_capture() -> void;
+
+    auto start_movie_record(const std::string& filename) -> void;
+
+    auto stop_movie_record() -> void;
+
+    auto start_movie_replay(const std::string& filename) -> void;
+
+    auto stop_movie_replay() -> void;
+
     auto create_disk_into_drive0(const std::string& filename) -> void;
 
     auto insert_disk_into_drive0(const std::string& filename) -> void;
 
     auto remove_disk_from_drive0() -> void;
 
+    auto flush_disk_in_drive0() -> void;
+
     auto create_disk_into_drive1(const std::string& filename) -> void;
 
     auto insert_disk_into_drive1(const std::string& filename) -> void;
 
     auto remove_disk_from_drive1() -> void;
 
+    auto flush_disk_in_drive1() -> void;
+
     auto set_volume(const float volume) -> void;
 
     auto set_scanlines(const bool scanlines) -> void;
@@ -99,6 +135,8 @@ public: // public interface
 
     auto get_statistics() const -> std::string;
 
+    auto get_audio_statistics() const -> AudioStats;
+
     auto get_backend() const -> const Backend*;
 
     auto get_audio_device() -> AudioDevice&
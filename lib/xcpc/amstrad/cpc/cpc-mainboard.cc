@@ -30,9 +30,11 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <iostream>
 #include <stdexcept>
 #include <xcpc/libxcpc-priv.h>
+#include <xcpc/formats/wav/wav-format.h>
 #include "cpc-machine.h"
 #include "cpc-mainboard.h"
 
@@ -53,6 +55,13 @@ struct Traits
     using State     = cpc::Mainboard::State;
     using Audio     = cpc::Mainboard::Audio;
     using Video     = cpc::Mainboard::Video;
+    using Rewind    = cpc::Mainboard::Rewind;
+    using RunAhead  = cpc::Mainboard::RunAhead;
+    using Movie     = cpc::Mainboard::Movie;
+    using Bridge    = cpc::Mainboard::Bridge;
+
+    static constexpr char     STATE_MAGIC[8] = { 'X', 'C', 'P', 'C', '-', 'S', 'T', 'A' };
+    static constexpr uint32_t STATE_VERSION  = 2;
 
     static auto gettimeofday(TimeVal& tv) -> void
     {
@@ -63,15 +72,20 @@ struct Traits
 
     static auto construct(Setup& setup) -> void
     {
-        setup.company_name  = XCPC_COMPANY_NAME_UNKNOWN;
-        setup.machine_type  = XCPC_MACHINE_TYPE_UNKNOWN;
-        setup.monitor_type  = XCPC_MONITOR_TYPE_UNKNOWN;
-        setup.refresh_rate  = XCPC_REFRESH_RATE_UNKNOWN;
-        setup.keyboard_type = XCPC_KEYBOARD_TYPE_UNKNOWN;
-        setup.memory_size   = XCPC_MEMORY_SIZE_UNKNOWN;
-        setup.speedup       = 1;
-        setup.xshm          = true;
-        setup.scanlines     = true;
+        setup.company_name    = XCPC_COMPANY_NAME_UNKNOWN;
+        setup.machine_type    = XCPC_MACHINE_TYPE_UNKNOWN;
+        setup.monitor_type    = XCPC_MONITOR_TYPE_UNKNOWN;
+        setup.refresh_rate    = XCPC_REFRESH_RATE_UNKNOWN;
+        setup.keyboard_type   = XCPC_KEYBOARD_TYPE_UNKNOWN;
+        setup.memory_size     = XCPC_MEMORY_SIZE_UNKNOWN;
+        setup.speedup         = 1;
+        setup.xshm            = true;
+        setup.scanlines       = true;
+        setup.fastload        = false;
+        setup.fdctiming       = fdc::Timing::TIMING_INSTANT;
+        setup.rewind_interval = 5;
+        setup.rewind_length   = 600;
+        setup.runahead        = 0;
     }
 
     static auto construct(Stats& stats) -> void
@@ -106,6 +120,10 @@ struct Traits
         state.psg_ticks   = 0;
         state.snd_clock   = 44100;
         state.snd_ticks   = 0;
+        state.fdc_clock   = 1000000;
+        state.fdc_ticks   = 0;
+        state.fdc_delay   = 0;
+        state.fdc_event   = 0;
         state.vdc_hsync   = 0; /* no hsync      */
         state.vdc_vsync   = 0; /* no vsync      */
         state.lnk_lk1     = 1; /* amstrad       */
@@ -130,22 +148,33 @@ struct Traits
         for(uint8_t*& pal_wr : state.pal_wr) {
             pal_wr = nullptr;
         }
+        for(uint8_t*& pal_pg : state.pal_pg) {
+            pal_pg = nullptr;
+        }
     }
 
     static auto construct(Audio& audio) -> void
     {
         for(auto& sample : audio.channel0) {
-            sample = 0.0f;
+            sample = 0;
         }
         for(auto& sample : audio.channel1) {
-            sample = 0.0f;
+            sample = 0;
         }
         for(auto& sample : audio.channel2) {
-            sample = 0.0f;
+            sample = 0;
         }
         audio.volume = 0.5f;
         audio.rd_index = 0;
         audio.wr_index = 0;
+        for(auto& bucket : audio.histogram) {
+            bucket = 0;
+        }
+        audio.underruns     = 0;
+        audio.dropped       = 0;
+        audio.callbacks     = 0;
+        audio.callback_time = 0;
+        audio.callback_peak = 0;
     }
 
     static auto construct(Video& video) -> void
@@ -154,6 +183,35 @@ struct Traits
         video.frame_duration = 20000;
     }
 
+    static auto construct(Rewind& rewind) -> void
+    {
+        rewind.frames       = 0;
+        rewind.captures     = 0;
+        rewind.capture_time = 0;
+        rewind.capture_peak = 0;
+    }
+
+    static auto construct(RunAhead& ahead) -> void
+    {
+        ahead.active    = 0;
+        ahead.aborted   = 0;
+        ahead.passes    = 0;
+        ahead.pass_time = 0;
+        ahead.pass_peak = 0;
+    }
+
+    static auto construct(Movie& movie) -> void
+    {
+        movie.cycles = 0;
+    }
+
+    static auto construct(Bridge& bridge) -> void
+    {
+        bridge.reader = nullptr;
+        bridge.writer = nullptr;
+        bridge.header = 0;
+    }
+
     static auto destruct(Setup& setup) -> void
     {
         setup = Setup();
@@ -189,6 +247,26 @@ struct Traits
         video = Video();
     }
 
+    static auto destruct(Rewind& rewind) -> void
+    {
+        rewind = Rewind();
+    }
+
+    static auto destruct(RunAhead& ahead) -> void
+    {
+        ahead = RunAhead();
+    }
+
+    static auto destruct(Movie& movie) -> void
+    {
+        movie = Movie();
+    }
+
+    static auto destruct(Bridge& bridge) -> void
+    {
+        reset(bridge);
+    }
+
     static auto reset(Setup& setup) -> void
     {
     }
@@ -224,6 +302,10 @@ struct Traits
         state.psg_ticks   &= 0;
         state.snd_clock   |= 0;
         state.snd_ticks   &= 0;
+        state.fdc_clock   |= 0;
+        state.fdc_ticks   &= 0;
+        state.fdc_delay   &= 0;
+        state.fdc_event   &= 0;
         state.vdc_hsync   &= 0;
         state.vdc_vsync   &= 0;
         state.lnk_lk1     |= 0;
@@ -248,21 +330,32 @@ struct Traits
         for(uint8_t*& pal_wr : state.pal_wr) {
             pal_wr = nullptr;
         }
+        for(uint8_t*& pal_pg : state.pal_pg) {
+            pal_pg = nullptr;
+        }
     }
 
     static auto reset(Audio& audio) -> void
     {
         for(auto& sample : audio.channel0) {
-            sample = 0.0f;
+            sample &= 0;
         }
         for(auto& sample : audio.channel1) {
-            sample = 0.0f;
+            sample &= 0;
         }
         for(auto& sample : audio.channel2) {
-            sample = 0.0f;
+            sample &= 0;
         }
         audio.rd_index &= 0;
         audio.wr_index &= 0;
+        for(auto& bucket : audio.histogram) {
+            bucket &= 0;
+        }
+        audio.underruns     &= 0;
+        audio.dropped       &= 0;
+        audio.callbacks     &= 0;
+        audio.callback_time &= 0;
+        audio.callback_peak &= 0;
     }
 
     static auto reset(Video& video) -> void
@@ -270,8 +363,67 @@ struct Traits
         video.frame_rate     |= 0;
         video.frame_duration |= 0;
     }
+
+    static auto reset(Rewind& rewind) -> void
+    {
+        rewind.frames       &= 0;
+        rewind.captures     &= 0;
+        rewind.capture_time &= 0;
+        rewind.capture_peak &= 0;
+    }
+
+    static auto reset(RunAhead& ahead) -> void
+    {
+        ahead.active    &= 0;
+        ahead.aborted   &= 0;
+        ahead.passes    &= 0;
+        ahead.pass_time &= 0;
+        ahead.pass_peak &= 0;
+    }
+
+    static auto reset(Movie& movie) -> void
+    {
+        /* the cycle counter is the time base of the movie, it is kept across a reset */
+        static_cast<void>(movie);
+    }
+
+    static auto reset(Bridge& bridge) -> void
+    {
+        if(bridge.reader != nullptr) {
+            bridge.reader = (delete bridge.reader, nullptr);
+        }
+        if(bridge.writer != nullptr) {
+            bridge.writer = (delete bridge.writer, nullptr);
+        }
+        bridge.header = 0;
+    }
+
+    static auto move_banks(mem::Pages (&dst)[8], mem::Pages (&src)[8]) -> void
+    {
+        for(int bank = 0; bank < 8; ++bank) {
+            dst[bank] = std::move(src[bank]);
+        }
+    }
+
+    static auto count_pages(const mem::Pages (&ram)[8], const mem::Pages* prev) -> size_t
+    {
+        size_t count = 0;
+
+        for(int bank = 0; bank < 8; ++bank) {
+            for(int index = 0; index < mem::PAGE_COUNT; ++index) {
+                const auto& page(ram[bank].page[index]);
+                if((page != nullptr) && ((prev == nullptr) || (page != prev[bank].page[index]))) {
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
 };
 
+constexpr char     Traits::STATE_MAGIC[8];
+constexpr uint32_t Traits::STATE_VERSION;
+
 }
 
 // ---------------------------------------------------------------------------
@@ -351,14 +503,20 @@ Mainboard::Mainboard(Machine& machine)
     , psg::Interface()
     , fdc::Interface()
     , mem::Interface()
+    , mov::Interface()
     , _machine(machine)
     , _setup()
     , _stats()
+    , _audio_stats()
     , _clock()
     , _funcs()
     , _state()
     , _audio()
     , _video()
+    , _rewind()
+    , _ahead()
+    , _movie()
+    , _bridge()
     , _dpy()
     , _kbd()
     , _cpu()
@@ -370,6 +528,16 @@ Mainboard::Mainboard(Machine& machine)
     , _ram()
     , _rom()
     , _exp()
+    , _psglog()
+    , _capture()
+    , _record()
+    , _replay()
+    , _rewind_ring()
+    , _rewind_banks()
+    , _rewind_state()
+    , _ahead_state()
+    , _save_slots()
+    , _slot_state()
 {
     Traits::construct(_setup);
     Traits::construct(_stats);
@@ -378,6 +546,10 @@ Mainboard::Mainboard(Machine& machine)
     Traits::construct(_state);
     Traits::construct(_audio);
     Traits::construct(_video);
+    Traits::construct(_rewind);
+    Traits::construct(_ahead);
+    Traits::construct(_movie);
+    Traits::construct(_bridge);
     construct_dpy();
     construct_kbd();
     construct_cpu();
@@ -404,6 +576,10 @@ Mainboard::Mainboard(Machine& machine, const Settings& settings)
 
 Mainboard::~Mainboard()
 {
+    stop_movie_replay();
+    stop_movie_record();
+    stop_audio_capture();
+    stop_psg_log();
     destruct_exp();
     destruct_rom();
     destruct_ram();
@@ -415,6 +591,10 @@ Mainboard::~Mainboard()
     destruct_cpu();
     destruct_kbd();
     destruct_dpy();
+    Traits::destruct(_bridge);
+    Traits::destruct(_movie);
+    Traits::destruct(_ahead);
+    Traits::destruct(_rewind);
     Traits::destruct(_video);
     Traits::destruct(_audio);
     Traits::destruct(_state);
@@ -443,6 +623,10 @@ auto Mainboard::reset() -> void
     Traits::reset(_state);
     Traits::reset(_audio);
     Traits::reset(_video);
+    Traits::reset(_rewind);
+    Traits::reset(_ahead);
+    Traits::reset(_movie);
+    Traits::reset(_bridge);
     reset_dpy();
     reset_kbd();
     reset_cpu();
@@ -455,6 +639,9 @@ auto Mainboard::reset() -> void
     reset_rom();
     reset_exp();
     update_pal();
+    if(_record != nullptr) {
+        _record->reset(_movie.cycles);
+    }
 }
 
 auto Mainboard::clock() -> void
@@ -481,7 +668,20 @@ auto Mainboard::clock() -> void
     {
         if((_state.psg_ticks += _state.psg_clock) >= _state.cpc_clock) {
             _state.psg_ticks -= _state.cpc_clock;
-            _psg->clock();
+            _psg->defer(1);
+        }
+    };
+
+    auto clock_fdc = [&]() -> void
+    {
+        if(_state.fdc_event == 0) {
+            return;
+        }
+        if((_state.fdc_ticks += _state.fdc_clock) >= _state.cpc_clock) {
+            _state.fdc_ticks -= _state.cpc_clock;
+            if(--_state.fdc_event == 0) {
+                _state.fdc_delay = _state.fdc_event = _fdc->advance(_state.fdc_delay);
+            }
         }
     };
 
@@ -489,6 +689,10 @@ auto Mainboard::clock() -> void
     {
         if((_state.snd_ticks += _state.snd_clock) >= _state.cpc_clock) {
             _state.snd_ticks -= _state.cpc_clock;
+            _psg->flush();
+            if(_ahead.active != 0) {
+                return;
+            }
             const auto rd_index = ((_audio.rd_index + 0) % SND_BUFSIZE);
             const auto wr_index = ((_audio.wr_index + 1) % SND_BUFSIZE);
             if(wr_index != rd_index) {
@@ -498,11 +702,33 @@ auto Mainboard::clock() -> void
                 _audio.channel2[_audio.wr_index] = output.channel2;
                 _audio.wr_index = wr_index;
             }
+            else {
+                ++_audio.dropped;
+            }
+        }
+    };
+
+    auto replay = [&]() -> void
+    {
+        if((_replay == nullptr) || (_ahead.active != 0)) {
+            return;
+        }
+        try {
+            _replay->replay(*this, _movie.cycles);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while replaying movie: %s", e.what());
+        }
+        if(_replay->finished()) {
+            ::xcpc_log_alert("movie replay is finished");
+            stop_movie_replay();
         }
     };
 
     auto emulate = [&]() -> void
     {
+        const uint32_t cpc_ticks = _state.cpc_ticks;
+
         if((_state.cpc_flags & FLAG_PAUSE) != 0) {
             return;
         }
@@ -511,11 +737,17 @@ auto Mainboard::clock() -> void
             clock_vdc();
             clock_cpu();
             clock_psg();
+            clock_fdc();
             clock_snd();
         }
+        _movie.cycles += ((_state.cpc_ticks - cpc_ticks) / _video.frame_rate);
         _state.cpc_ticks -= _state.cpc_clock;
+        capture_rewind();
+        pump_audio();
     };
 
+    replay();
+
     return emulate();
 }
 
@@ -523,6 +755,9 @@ auto Mainboard::load_snapshot(const std::string& filename) -> void
 {
     sna::Snapshot snapshot;
 
+    if((_record != nullptr) || (_replay != nullptr)) {
+        throw std::runtime_error("unable to load a snapshot while a movie is recorded or replayed");
+    }
     try {
         snapshot.load(filename);
         load_cpc(snapshot);
@@ -547,6 +782,665 @@ auto Mainboard::save_snapshot(const std::string& filename) -> void
     }
 }
 
+auto Mainboard::serialize(Buffer& buffer) -> void
+{
+    const MutexLock lock(_mutex);
+
+    return serialize_state(buffer, nullptr);
+}
+
+auto Mainboard::deserialize(const Buffer& buffer) -> void
+{
+    const MutexLock lock(_mutex);
+
+    return deserialize_state(buffer, nullptr);
+}
+
+auto Mainboard::save_checkpoint(Checkpoint& checkpoint) -> void
+{
+    const MutexLock lock(_mutex);
+
+    return serialize_state(checkpoint.state, checkpoint.ram);
+}
+
+auto Mainboard::load_checkpoint(const Checkpoint& checkpoint) -> void
+{
+    const MutexLock lock(_mutex);
+
+    return deserialize_state(checkpoint.state, checkpoint.ram);
+}
+
+auto Mainboard::rewind() -> bool
+{
+    const MutexLock lock(_mutex);
+
+    if((_record != nullptr) || (_replay != nullptr)) {
+        return false;
+    }
+    if(_rewind_ring.pop(_rewind_state.state) == false) {
+        return false;
+    }
+    Traits::move_banks(_rewind_state.ram, _rewind_banks[_rewind_ring.head()].ram);
+    deserialize_state(_rewind_state.state, _rewind_state.ram);
+    _rewind.frames &= 0;
+
+    return true;
+}
+
+/* only the in-memory copy is taken under the lock, compression and i/o run on the slot writer */
+auto Mainboard::quick_save(const unsigned slot) -> void
+{
+    SlotIdentity identity;
+
+    /* capture */ {
+        const MutexLock lock(_mutex);
+        get_slot_identity(identity);
+        serialize_state(_slot_state, nullptr);
+    }
+    return _save_slots.store(slot, identity, _slot_state);
+}
+
+auto Mainboard::quick_load(const unsigned slot) -> bool
+{
+    SlotIdentity identity;
+
+    /* identify */ {
+        const MutexLock lock(_mutex);
+        get_slot_identity(identity);
+    }
+    if(_save_slots.fetch(slot, identity, _slot_state) == false) {
+        return false;
+    }
+    /* restore */ {
+        const MutexLock lock(_mutex);
+        if((_record != nullptr) || (_replay != nullptr)) {
+            return false;
+        }
+        deserialize_state(_slot_state, nullptr);
+        _rewind.frames &= 0;
+    }
+    return true;
+}
+
+auto Mainboard::digest_frame(FrameDigest& digest) -> void
+{
+    const MutexLock lock(_mutex);
+    auto& vdc(*_vdc);
+    auto& vga(*_vga);
+    const vga::Scanline* scanline = &vga->scanline[0];
+    const vga::Scanline* last_one = &vga->scanline[0] + countof(vga->scanline);
+    const uint8_t* const ram[4] = {
+        (*_ram[0])->data,
+        (*_ram[1])->data,
+        (*_ram[2])->data,
+        (*_ram[3])->data,
+    };
+    const HorzProps h = {
+        /* cw  : pixels */ (16),
+        /* ht  : chars  */ (1 + (vdc->regs.named.horizontal_total     < 63 ? vdc->regs.named.horizontal_total     : 63)),
+        /* hd  : chars  */ (0 + (vdc->regs.named.horizontal_displayed < 52 ? vdc->regs.named.horizontal_displayed : 52)),
+        /* hsp : chars  */ (0 + (vdc->regs.named.horizontal_sync_position)),
+        /* hsw : pixels */ (0 + ((vdc->regs.named.sync_width >> 0) & 0x0f)),
+    };
+    const VertProps v = {
+        /* ch  : pixels */ (1 + (vdc->regs.named.maximum_scanline_address)),
+        /* vt  : chars  */ (1 + (vdc->regs.named.vertical_total     < 40 ? vdc->regs.named.vertical_total     : 40)),
+        /* vd  : chars  */ (0 + (vdc->regs.named.vertical_displayed < 40 ? vdc->regs.named.vertical_displayed : 40)),
+        /* vsp : chars  */ (0 + (vdc->regs.named.vertical_sync_position)),
+        /* vsw : pixels */ (0 + ((vdc->regs.named.sync_width >> 4) & 0x0f)),
+    };
+    const Borders b = {
+        /* top : pixels */ ((v.vt - v.vsp) * v.ch) + vdc->regs.named.vertical_total_adjust,
+        /* bot : pixels */ ((v.vsp - v.vd) * v.ch),
+        /* lft : pixels */ ((h.ht - h.hsp) * h.cw),
+        /* rgt : pixels */ ((h.hsp - h.hd) * h.cw),
+    };
+    unsigned int address = ((vdc->regs.named.start_address_high << 8) | (vdc->regs.named.start_address_low  << 0));
+    Hash64 hash;
+
+    /* hash the gate-array attributes of a scanline, inks are hardware colors */
+    auto digest_attributes = [&]() -> bool
+    {
+        uint8_t bytes[18];
+        if(scanline == last_one) {
+            return false;
+        }
+        bytes[0] = scanline->mode;
+        for(int index = 0; index < 17; ++index) {
+            bytes[index + 1] = scanline->color[index].ink;
+        }
+        hash.update(bytes, sizeof(bytes));
+        return true;
+    };
+
+    auto digest_borders = [&](const int rows) -> void
+    {
+        for(int row = 0; row < rows; ++row) {
+            if(digest_attributes() == false) {
+                break;
+            }
+            ++scanline;
+        }
+    };
+
+    auto digest_display = [&]() -> void
+    {
+        const int cols = (h.hd < h.hsp ? h.hd : h.hsp);
+        for(int row = 0; row < v.vd; ++row) {
+            for(int ras = 0; ras < v.ch; ++ras) {
+                if(digest_attributes() == false) {
+                    break;
+                }
+                for(int col = 0; col < cols; ++col) {
+                    const uint16_t addr = ((address & 0x3000) << 2) | ((ras & 0x0007) << 11) | (((address + col) & 0x03ff) << 1);
+                    const uint16_t bank = ((addr >> 14) & 0x0003);
+                    const uint16_t disp = ((addr >>  0) & 0x3fff);
+                    hash.update(&ram[bank][disp], 2);
+                }
+                ++scanline;
+            }
+            address += h.hd;
+        }
+    };
+
+    /* the digest drains the audio ring, no audio device may be playing */
+    auto digest_audio = [&]() -> void
+    {
+        Hash64  chain(digest.audio);
+        uint8_t bytes[6];
+        while(_audio.rd_index != _audio.wr_index) {
+            const auto index = _audio.rd_index;
+            const int16_t samples[3] = {
+                _audio.channel0[index],
+                _audio.channel1[index],
+                _audio.channel2[index],
+            };
+            for(int channel = 0; channel < 3; ++channel) {
+                bytes[(channel * 2) + 0] = static_cast<uint8_t>(static_cast<uint16_t>(samples[channel]) >> 0);
+                bytes[(channel * 2) + 1] = static_cast<uint8_t>(static_cast<uint16_t>(samples[channel]) >> 8);
+            }
+            chain.update(bytes, sizeof(bytes));
+            _audio.rd_index = ((index + 1) % SND_BUFSIZE);
+        }
+        digest.audio = chain.digest();
+    };
+
+    digest_borders(b.top);
+    digest_display();
+    digest_borders(b.bot);
+    digest.video = hash.digest();
+
+    return digest_audio();
+}
+
+auto Mainboard::serialize_state(Buffer& buffer, mem::Pages* banks) -> void
+{
+    const uint32_t version = Traits::STATE_VERSION;
+    const uint32_t length  = get_serialized_size() - (banks != nullptr ? sizeof(mem::State::data) * 8 : 0);
+
+    auto write_header = [&]() -> void
+    {
+        buffer.write(Traits::STATE_MAGIC, sizeof(Traits::STATE_MAGIC));
+        buffer.write(&version, sizeof(version));
+        buffer.write(&length, sizeof(length));
+    };
+
+    /* the audio ring is drained by the audio thread, it is not saved */
+    auto write_board = [&]() -> void
+    {
+        buffer.write(&_state, sizeof(_state));
+    };
+
+    auto write_chips = [&]() -> void
+    {
+        buffer.write(_cpu->operator->(), sizeof(cpu::State));
+        buffer.write(_vga->operator->(), sizeof(vga::State));
+        buffer.write(_vdc->operator->(), sizeof(vdc::State));
+        buffer.write(_ppi->operator->(), sizeof(ppi::State));
+        buffer.write(_kbd->operator->(), sizeof(kbd::State));
+        _psg->save_state(buffer.append(_psg->get_state_size()));
+        _fdc->save_state(buffer.append(_fdc->get_state_size()));
+    };
+
+    /* shared banks only copy the pages written since they were last shared */
+    auto write_banks = [&]() -> void
+    {
+        if(banks != nullptr) {
+            for(auto& ram : _ram) {
+                ram->share(*banks++);
+            }
+        }
+        else {
+            for(auto& ram : _ram) {
+                buffer.write((*ram)->data, sizeof((*ram)->data));
+            }
+        }
+    };
+
+    auto write_state = [&]() -> void
+    {
+        buffer.clear();
+        buffer.reserve(length);
+        write_header();
+        write_board();
+        write_chips();
+        write_banks();
+    };
+
+    return write_state();
+}
+
+auto Mainboard::deserialize_state(const Buffer& buffer, const mem::Pages* banks) -> void
+{
+    const uint32_t expected = get_serialized_size() - (banks != nullptr ? sizeof(mem::State::data) * 8 : 0);
+
+    size_t offset = 0;
+
+    auto read_header = [&]() -> void
+    {
+        char     magic[sizeof(Traits::STATE_MAGIC)];
+        uint32_t version = 0;
+        uint32_t length  = 0;
+
+        buffer.read(offset, magic, sizeof(magic));
+        buffer.read(offset, &version, sizeof(version));
+        buffer.read(offset, &length, sizeof(length));
+        if(::memcmp(magic, Traits::STATE_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error("bad machine state signature");
+        }
+        if(version != Traits::STATE_VERSION) {
+            throw std::runtime_error("unsupported machine state version");
+        }
+        if((length != expected) || (length != buffer.size())) {
+            throw std::runtime_error("machine state size mismatch");
+        }
+    };
+
+    /* the flags and the sampling clock belong to the host, not to the saved machine */
+    auto read_board = [&]() -> void
+    {
+        const uint32_t cpc_flags = _state.cpc_flags;
+        const uint32_t snd_clock = _state.snd_clock;
+
+        buffer.read(offset, &_state, sizeof(_state));
+        _state.cpc_flags = cpc_flags;
+        _state.snd_clock = snd_clock;
+    };
+
+    auto read_chips = [&]() -> void
+    {
+        buffer.read(offset, _cpu->operator->(), sizeof(cpu::State));
+        buffer.read(offset, _vga->operator->(), sizeof(vga::State));
+        buffer.read(offset, _vdc->operator->(), sizeof(vdc::State));
+        buffer.read(offset, _ppi->operator->(), sizeof(ppi::State));
+        buffer.read(offset, _kbd->operator->(), sizeof(kbd::State));
+        _psg->load_state(buffer.peek(offset, _psg->get_state_size()));
+        _fdc->load_state(buffer.peek(offset, _fdc->get_state_size()));
+    };
+
+    /* shared banks only copy the pages written since the checkpoint */
+    auto read_banks = [&]() -> void
+    {
+        if(banks != nullptr) {
+            for(auto& ram : _ram) {
+                ram->restore(*banks++);
+            }
+        }
+        else {
+            for(auto& ram : _ram) {
+                buffer.read(offset, (*ram)->data, sizeof((*ram)->data));
+                ram->touch();
+            }
+        }
+    };
+
+    auto read_state = [&]() -> void
+    {
+        read_header();
+        read_board();
+        read_chips();
+        read_banks();
+        update_pal();
+    };
+
+    return read_state();
+}
+
+auto Mainboard::capture_rewind() -> void
+{
+    auto update_timings = [&](const std::chrono::steady_clock::time_point& started) -> void
+    {
+        const auto     elapsed = (std::chrono::steady_clock::now() - started);
+        const uint32_t time_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        ++_rewind.captures;
+        _rewind.capture_time += time_us;
+        if(_rewind.capture_peak < time_us) {
+            _rewind.capture_peak = time_us;
+        }
+    };
+
+    auto capture = [&]() -> void
+    {
+        if((_setup.rewind_interval == 0) || (_ahead.active != 0)) {
+            return;
+        }
+        if(++_rewind.frames < _setup.rewind_interval) {
+            return;
+        }
+        const auto started = std::chrono::steady_clock::now();
+
+        RewindBanks previous;
+
+        _rewind.frames &= 0;
+        Traits::move_banks(previous.ram, _rewind_state.ram);
+        serialize_state(_rewind_state.state, _rewind_state.ram);
+        _rewind_ring.push(_rewind_state.state);
+        /* the ring keeps the banks of the state the new delta leads back to */
+        if(_rewind_ring.count() != 0) {
+            const size_t length = _rewind_ring.length();
+            Traits::move_banks(_rewind_banks[(_rewind_ring.head() + length - 1) % length].ram, previous.ram);
+        }
+        update_timings(started);
+    };
+
+    return capture();
+}
+
+auto Mainboard::paint_frame() -> void
+{
+    auto update_timings = [&](const std::chrono::steady_clock::time_point& started) -> void
+    {
+        const auto     elapsed = (std::chrono::steady_clock::now() - started);
+        const uint32_t time_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        ++_ahead.passes;
+        _ahead.pass_time += time_us;
+        if(_ahead.pass_peak < time_us) {
+            _ahead.pass_peak = time_us;
+        }
+    };
+
+    auto can_run_ahead = [&]() -> bool
+    {
+        if(_setup.runahead == 0) {
+            return false;
+        }
+        if((_state.cpc_flags & FLAG_PAUSE) != 0) {
+            return false;
+        }
+        if((_bridge.reader != nullptr) || (_bridge.writer != nullptr)) {
+            return false; /* host files can't be restored */
+        }
+        return true;
+    };
+
+    auto paint = [&]() -> void
+    {
+        (*_funcs.paint_func)(this);
+    };
+
+    auto paint_ahead = [&]() -> void
+    {
+        auto&          fdc(*_fdc);
+        const auto     started = std::chrono::steady_clock::now();
+        const uint64_t cycles  = _movie.cycles;
+
+        save_checkpoint(_ahead_state);
+        _ahead.active  = 1;
+        _ahead.aborted = 0;
+        for(uint32_t frame = 0; (frame < _setup.runahead) && (_ahead.aborted == 0); ++frame) {
+            clock();
+            if(fdc.is_diverted() != false) {
+                _ahead.aborted = 1;
+            }
+        }
+        if(_ahead.aborted == 0) {
+            paint();
+        }
+        _ahead.active = 0;
+        static_cast<void>(fdc.end_speculation());
+        load_checkpoint(_ahead_state);
+        _movie.cycles = cycles;
+        /* the ahead frames touched the host: the real frame is painted instead */
+        if(_ahead.aborted != 0) {
+            paint();
+        }
+        update_timings(started);
+    };
+
+    if(can_run_ahead() == false) {
+        return paint();
+    }
+    if(_fdc->begin_speculation() == false) {
+        return paint(); /* libdsk images can't be restored */
+    }
+    return paint_ahead();
+}
+
+auto Mainboard::record_keys(const uint8_t (&keys)[16]) -> void
+{
+    auto& kbd(*_kbd);
+
+    if(_record != nullptr) {
+        for(uint8_t row = 0; row < 16; ++row) {
+            if(kbd->keys[row] != keys[row]) {
+                _record->keyboard(_movie.cycles, row, kbd->keys[row]);
+            }
+        }
+    }
+}
+
+auto Mainboard::get_serialized_size() const -> size_t
+{
+    return sizeof(Traits::STATE_MAGIC)
+         + sizeof(uint32_t)
+         + sizeof(uint32_t)
+         + sizeof(_state)
+         + sizeof(cpu::State)
+         + sizeof(vga::State)
+         + sizeof(vdc::State)
+         + sizeof(ppi::State)
+         + sizeof(kbd::State)
+         + _psg->get_state_size()
+         + _fdc->get_state_size()
+         + sizeof(mem::State::data) * 8;
+}
+
+auto Mainboard::start_psg_log(const std::string& filename) -> void
+{
+    auto& psg(*_psg);
+
+    auto get_chip = [&]() -> uint8_t
+    {
+        switch(psg->type) {
+            case psg::Type::TYPE_AY8910:
+                return vgm::Chip::CHIP_AY8910;
+            case psg::Type::TYPE_AY8912:
+                return vgm::Chip::CHIP_AY8912;
+            case psg::Type::TYPE_AY8913:
+                return vgm::Chip::CHIP_AY8913;
+            case psg::Type::TYPE_YM2149:
+                return vgm::Chip::CHIP_YM2149;
+            default:
+                break;
+        }
+        return vgm::Chip::CHIP_AY8910;
+    };
+
+    auto start = [&]() -> void
+    {
+        const uint32_t timestamp = (psg->ticks + psg->pending);
+
+        stop_psg_log();
+        _psglog = new vgm::Recorder(filename, _state.psg_clock, get_chip(), timestamp);
+        for(uint8_t index = 0; index < 14; ++index) {
+            _psglog->write(timestamp, index, psg->array[index]);
+        }
+    };
+
+    return start();
+}
+
+auto Mainboard::stop_psg_log() -> void
+{
+    if(_psglog != nullptr) {
+        auto& psg(*_psg);
+        try {
+            _psglog->close(psg->ticks + psg->pending);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while closing psg log: %s", e.what());
+        }
+        _psglog = (delete _psglog, nullptr);
+    }
+}
+
+auto Mainboard::start_audio_capture(const std::string& filename, const std::string& format) -> void
+{
+    auto get_format = [&]() -> wav::Format
+    {
+        if(format.empty() || (format == "pcm16")) {
+            return wav::Format::FORMAT_PCM16;
+        }
+        if(format == "float") {
+            return wav::Format::FORMAT_FLT32;
+        }
+        throw std::runtime_error("invalid audio capture format");
+    };
+
+    auto get_channels = [&]() -> uint16_t
+    {
+        const uint32_t channels = _device->playback.channels;
+        if((channels == 1) || (channels == 2)) {
+            return static_cast<uint16_t>(channels);
+        }
+        throw std::runtime_error("unsupported audio channel count");
+    };
+
+    auto start = [&]() -> void
+    {
+        /* the previous capture is closed first, it may be writing to the same file */
+        stop_audio_capture();
+
+        wav::WaveCapture* capture = new wav::WaveCapture(filename, get_format(), get_channels(), _device->sampleRate);
+
+        /* attach the capture */ {
+            const MutexLock lock(_mutex);
+            _capture = capture;
+        }
+    };
+
+    return start();
+}
+
+auto Mainboard::stop_audio_capture() -> void
+{
+    wav::WaveCapture* capture = nullptr;
+
+    /* detach the capture */ {
+        const MutexLock lock(_mutex);
+        capture  = _capture;
+        _capture = nullptr;
+    }
+    if(capture != nullptr) {
+        try {
+            capture->close();
+            if(capture->get_dropped() != 0) {
+                ::xcpc_log_alert("audio capture has dropped %llu frames", static_cast<unsigned long long>(capture->get_dropped()));
+            }
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while closing audio capture: %s", e.what());
+        }
+        capture = (delete capture, nullptr);
+    }
+}
+
+auto Mainboard::start_movie_record(const std::string& filename) -> void
+{
+    Buffer machine;
+
+    auto start = [&]() -> void
+    {
+        stop_movie_replay();
+        stop_movie_record();
+        /* capture the machine */ {
+            const MutexLock lock(_mutex);
+            serialize_state(machine, nullptr);
+        }
+        _record = new mov::Recorder(filename, get_drive0_filename(), get_drive1_filename(), machine.data(), machine.size(), _movie.cycles);
+    };
+
+    return start();
+}
+
+auto Mainboard::stop_movie_record() -> void
+{
+    if(_record != nullptr) {
+        try {
+            _record->close(_movie.cycles);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while closing movie: %s", e.what());
+        }
+        _record = (delete _record, nullptr);
+    }
+}
+
+auto Mainboard::start_movie_replay(const std::string& filename) -> void
+{
+    std::unique_ptr<mov::Recording> recording(new mov::Recording());
+    Buffer                          machine;
+
+    auto load = [&]() -> void
+    {
+        auto& movie(*recording);
+
+        recording->load(filename);
+        machine.write(movie->machine.data(), movie->machine.size());
+    };
+
+    auto insert_disk = [&](const fdc::Drive drive, const std::string& path) -> void
+    {
+        if(_fdc == nullptr) {
+            return;
+        }
+        if(path.empty() == false) {
+            _fdc->insert_disk(drive, path);
+        }
+        else {
+            _fdc->remove_disk(drive);
+        }
+    };
+
+    auto start = [&]() -> void
+    {
+        auto& movie(*recording);
+
+        stop_movie_replay();
+        stop_movie_record();
+        /* restore the machine */ {
+            const MutexLock lock(_mutex);
+            insert_disk(fdc::Drive::FDC_DRIVE0, movie->drive0);
+            insert_disk(fdc::Drive::FDC_DRIVE1, movie->drive1);
+            deserialize_state(machine, nullptr);
+            _replay = recording.release();
+            _movie.cycles &= 0;
+        }
+    };
+
+    load();
+    start();
+}
+
+auto Mainboard::stop_movie_replay() -> void
+{
+    if(_replay != nullptr) {
+        _replay = (delete _replay, nullptr);
+    }
+}
+
 auto Mainboard::create_disk_into_drive0(const std::string& filename) -> void
 {
     if(filename.empty() == false) {
@@ -556,6 +1450,9 @@ auto Mainboard::create_disk_into_drive0(const std::string& filename) -> void
     if(_fdc != nullptr) {
         _fdc->insert_disk(fdc::Drive::FDC_DRIVE0, filename);
     }
+    if(_record != nullptr) {
+        _record->insert_disk(_movie.cycles, 0, filename);
+    }
 }
 
 auto Mainboard::insert_disk_into_drive0(const std::string& filename) -> void
@@ -563,6 +1460,9 @@ auto Mainboard::insert_disk_into_drive0(const std::string& filename) -> void
     if(_fdc != nullptr) {
         _fdc->insert_disk(fdc::Drive::FDC_DRIVE0, filename);
     }
+    if(_record != nullptr) {
+        _record->insert_disk(_movie.cycles, 0, filename);
+    }
 }
 
 auto Mainboard::remove_disk_from_drive0() -> void
@@ -570,6 +1470,16 @@ auto Mainboard::remove_disk_from_drive0() -> void
     if(_fdc != nullptr) {
         _fdc->remove_disk(fdc::Drive::FDC_DRIVE0);
     }
+    if(_record != nullptr) {
+        _record->remove_disk(_movie.cycles, 0);
+    }
+}
+
+auto Mainboard::flush_disk_in_drive0() -> void
+{
+    if(_fdc != nullptr) {
+        _fdc->flush_disk(fdc::Drive::FDC_DRIVE0);
+    }
 }
 
 auto Mainboard::create_disk_into_drive1(const std::string& filename) -> void
@@ -581,6 +1491,9 @@ auto Mainboard::create_disk_into_drive1(const std::string& filename) -> void
     if(_fdc != nullptr) {
         _fdc->insert_disk(fdc::Drive::FDC_DRIVE1, filename);
     }
+    if(_record != nullptr) {
+        _record->insert_disk(_movie.cycles, 1, filename);
+    }
 }
 
 auto Mainboard::insert_disk_into_drive1(const std::string& filename) -> void
@@ -588,6 +1501,9 @@ auto Mainboard::insert_disk_into_drive1(const std::string& filename) -> void
     if(_fdc != nullptr) {
         _fdc->insert_disk(fdc::Drive::FDC_DRIVE1, filename);
     }
+    if(_record != nullptr) {
+        _record->insert_disk(_movie.cycles, 1, filename);
+    }
 }
 
 auto Mainboard::remove_disk_from_drive1() -> void
@@ -595,6 +1511,16 @@ auto Mainboard::remove_disk_from_drive1() -> void
     if(_fdc != nullptr) {
         _fdc->remove_disk(fdc::Drive::FDC_DRIVE1);
     }
+    if(_record != nullptr) {
+        _record->remove_disk(_movie.cycles, 1);
+    }
+}
+
+auto Mainboard::flush_disk_in_drive1() -> void
+{
+    if(_fdc != nullptr) {
+        _fdc->flush_disk(fdc::Drive::FDC_DRIVE1);
+    }
 }
 
 auto Mainboard::set_volume(const float volume) -> void
@@ -942,6 +1868,11 @@ auto Mainboard::get_statistics() const -> std::string
     return _stats.buffer;
 }
 
+auto Mainboard::get_audio_statistics() const -> AudioStats
+{
+    return _audio_stats;
+}
+
 auto Mainboard::on_reset(Event& event) -> unsigned long
 {
     /* reset the mainboard */ {
@@ -991,7 +1922,7 @@ auto Mainboard::on_clock(Event& event) -> unsigned long
     }
     /* draw the frame if needed */ {
         if(skip_frame == 0) {
-            (*_funcs.paint_func)(this);
+            paint_frame();
             ++_stats.frame_drawn;
         }
     }
@@ -1094,8 +2025,12 @@ auto Mainboard::on_key_press(Event& event) -> unsigned long
 {
     XEvent* x11_event = event.u.key_press.x11_event;
 
-    if((_kbd != nullptr) && (x11_event != nullptr)) {
-        _kbd->key_press(x11_event->xkey);
+    if((_kbd != nullptr) && (x11_event != nullptr) && (_replay == nullptr)) {
+        auto&   kbd(*_kbd);
+        uint8_t keys[16];
+        static_cast<void>(::memcpy(keys, kbd->keys, sizeof(keys)));
+        kbd.key_press(x11_event->xkey);
+        record_keys(keys);
     }
     return 0UL;
 }
@@ -1104,8 +2039,12 @@ auto Mainboard::on_key_release(Event& event) -> unsigned long
 {
     XEvent* x11_event = event.u.key_release.x11_event;
 
-    if((_kbd != nullptr) && (x11_event != nullptr)) {
-        _kbd->key_release(x11_event->xkey);
+    if((_kbd != nullptr) && (x11_event != nullptr) && (_replay == nullptr)) {
+        auto&   kbd(*_kbd);
+        uint8_t keys[16];
+        static_cast<void>(::memcpy(keys, kbd->keys, sizeof(keys)));
+        kbd.key_release(x11_event->xkey);
+        record_keys(keys);
     }
     return 0UL;
 }
@@ -1114,8 +2053,12 @@ auto Mainboard::on_button_press(Event& event) -> unsigned long
 {
     XEvent* x11_event = event.u.button_press.x11_event;
 
-    if((_kbd != nullptr) && (x11_event != nullptr)) {
-        _kbd->button_press(x11_event->xbutton);
+    if((_kbd != nullptr) && (x11_event != nullptr) && (_replay == nullptr)) {
+        auto&   kbd(*_kbd);
+        uint8_t keys[16];
+        static_cast<void>(::memcpy(keys, kbd->keys, sizeof(keys)));
+        kbd.button_press(x11_event->xbutton);
+        record_keys(keys);
     }
     return 0UL;
 }
@@ -1124,8 +2067,12 @@ auto Mainboard::on_button_release(Event& event) -> unsigned long
 {
     XEvent* x11_event = event.u.button_release.x11_event;
 
-    if((_kbd != nullptr) && (x11_event != nullptr)) {
-        _kbd->button_release(x11_event->xbutton);
+    if((_kbd != nullptr) && (x11_event != nullptr) && (_replay == nullptr)) {
+        auto&   kbd(*_kbd);
+        uint8_t keys[16];
+        static_cast<void>(::memcpy(keys, kbd->keys, sizeof(keys)));
+        kbd.button_release(x11_event->xbutton);
+        record_keys(keys);
     }
     return 0UL;
 }
@@ -1134,8 +2081,12 @@ auto Mainboard::on_motion_notify(Event& event) -> unsigned long
 {
     XEvent* x11_event = event.u.motion_notify.x11_event;
 
-    if((_kbd != nullptr) && (x11_event != nullptr)) {
-        _kbd->motion_notify(x11_event->xmotion);
+    if((_kbd != nullptr) && (x11_event != nullptr) && (_replay == nullptr)) {
+        auto&   kbd(*_kbd);
+        uint8_t keys[16];
+        static_cast<void>(::memcpy(keys, kbd->keys, sizeof(keys)));
+        kbd.motion_notify(x11_event->xmotion);
+        record_keys(keys);
     }
     return 0UL;
 }
@@ -1353,7 +2304,21 @@ auto Mainboard::reset_ppi() -> void
 auto Mainboard::reset_psg() -> void
 {
     if(_psg != nullptr) {
+        auto& psg(*_psg);
+        const uint32_t timestamp = (psg->ticks + psg->pending);
         _psg->reset();
+        if(_psglog != nullptr) {
+            try {
+                _psglog->rebase(timestamp, psg->ticks);
+                for(uint8_t index = 0; index < 14; ++index) {
+                    _psglog->write(psg->ticks, index, psg->array[index]);
+                }
+            }
+            catch(const std::exception& e) {
+                ::xcpc_log_error("error while writing psg log: %s", e.what());
+                stop_psg_log();
+            }
+        }
     }
 };
 
@@ -1415,6 +2380,20 @@ auto Mainboard::configure(const Settings& settings) -> void
         return true;
     };
 
+    auto get_fdc_timing = [&](const std::string& timing) -> fdc::Timing
+    {
+        if(timing == "default") {
+            return fdc::Timing::TIMING_DEFAULT;
+        }
+        if(timing == "exact") {
+            return fdc::Timing::TIMING_EXACT;
+        }
+        if(is_set(timing) && (timing != "instant")) {
+            ::xcpc_log_error("invalid fdc timing <%s>", timing.c_str());
+        }
+        return fdc::Timing::TIMING_INSTANT;
+    };
+
     auto init_machine = [&]() -> void
     {
         set_company_name(settings.opt_company);
@@ -1427,7 +2406,30 @@ auto Mainboard::configure(const Settings& settings) -> void
         _setup.speedup   = clamp_int(::atoi(settings.opt_speedup.c_str()), 1, 100);
         _setup.xshm      = settings.opt_xshm;
         _setup.scanlines = settings.opt_scanlines;
+        _setup.fastload  = settings.opt_fastload;
+        _setup.fdctiming = get_fdc_timing(settings.opt_fdctiming);
         _state.snd_clock = _device->sampleRate;
+        _fdc->set_timing(_setup.fdctiming, _state.fdc_clock);
+    };
+
+    auto init_rewind = [&]() -> void
+    {
+        if(is_set(settings.opt_rewind)) {
+            _setup.rewind_interval = clamp_int(::atoi(settings.opt_rewind.c_str()), 0, 500);
+        }
+        if(is_set(settings.opt_rewindlen)) {
+            _setup.rewind_length = clamp_int(::atoi(settings.opt_rewindlen.c_str()), 1, 100000);
+        }
+        _rewind_ring.resize(_setup.rewind_interval != 0 ? _setup.rewind_length : 0);
+        _rewind_banks.clear();
+        _rewind_banks.resize(_rewind_ring.length());
+    };
+
+    auto init_runahead = [&]() -> void
+    {
+        if(is_set(settings.opt_runahead)) {
+            _setup.runahead = clamp_int(::atoi(settings.opt_runahead.c_str()), 0, 8);
+        }
     };
 
     auto load_roms = [&]() -> void
@@ -1524,15 +2526,63 @@ auto Mainboard::configure(const Settings& settings) -> void
         }
     };
 
-    auto load_initial_drive1 = [&]() -> void
+    auto load_initial_drive1 = [&]() -> void
+    {
+        try {
+            if(is_set(settings.opt_drive1)) {
+                _machine.insert_disk_into_drive1(settings.opt_drive1);
+            }
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while loading initial drive1: %s", e.what());
+        }
+    };
+
+    auto start_initial_wavlog = [&]() -> void
+    {
+        try {
+            if(is_set(settings.opt_wavlog)) {
+                start_audio_capture(settings.opt_wavlog, (is_set(settings.opt_wavfmt) ? settings.opt_wavfmt : std::string()));
+            }
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while starting audio capture: %s", e.what());
+        }
+    };
+
+    auto start_initial_psglog = [&]() -> void
+    {
+        try {
+            if(is_set(settings.opt_psglog)) {
+                start_psg_log(settings.opt_psglog);
+            }
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while starting psg log: %s", e.what());
+        }
+    };
+
+    auto start_initial_record = [&]() -> void
+    {
+        try {
+            if(is_set(settings.opt_record)) {
+                start_movie_record(settings.opt_record);
+            }
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while starting movie record: %s", e.what());
+        }
+    };
+
+    auto start_initial_replay = [&]() -> void
     {
         try {
-            if(is_set(settings.opt_drive1)) {
-                _machine.insert_disk_into_drive1(settings.opt_drive1);
+            if(is_set(settings.opt_replay)) {
+                start_movie_replay(settings.opt_replay);
             }
         }
         catch(const std::exception& e) {
-            ::xcpc_log_error("error while loading initial drive1: %s", e.what());
+            ::xcpc_log_error("error while starting movie replay: %s", e.what());
         }
     };
 
@@ -1540,11 +2590,17 @@ auto Mainboard::configure(const Settings& settings) -> void
     {
         try {
             init_machine();
+            init_rewind();
+            init_runahead();
             load_roms();
             reset();
             load_initial_snapshot();
             load_initial_drive0();
             load_initial_drive1();
+            start_initial_psglog();
+            start_initial_wavlog();
+            start_initial_record();
+            start_initial_replay();
         }
         catch(const std::exception& e) {
             reset();
@@ -1555,6 +2611,29 @@ auto Mainboard::configure(const Settings& settings) -> void
     return initialize();
 }
 
+/* a slot is only restored into the same model, with the same memory and the same roms */
+auto Mainboard::get_slot_identity(SlotIdentity& identity) -> void
+{
+    Hash64 hash;
+
+    auto hash_rom = [&](const uint32_t index, mem::Instance* rom) -> void
+    {
+        if(rom != nullptr) {
+            hash.update(&index, sizeof(index));
+            hash.update((*rom)->data, sizeof((*rom)->data));
+        }
+    };
+
+    hash_rom(0x100, _rom[0]);
+    hash_rom(0x101, _rom[1]);
+    for(uint32_t index = 0; index < countof(_exp); ++index) {
+        hash_rom(index, _exp[index]);
+    }
+    identity.machine_type = static_cast<uint32_t>(_setup.machine_type);
+    identity.memory_size  = static_cast<uint32_t>(_setup.memory_size);
+    identity.rom_digest   = hash.digest();
+}
+
 auto Mainboard::load_lower_rom(const std::string& filename) -> void
 {
     constexpr int index = 0;
@@ -1629,7 +2708,7 @@ auto Mainboard::load_cpc(sna::Snapshot& snapshot) -> void
         }
         else {
             psg.set_index(index);
-            psg.set_value(value);
+            write_psg(value);
         }
     };
 
@@ -1929,6 +3008,25 @@ auto Mainboard::save_cpc(sna::Snapshot& snapshot) -> void
         snapshot->header.rom_select = _state.rom_conf;
     };
 
+    auto save_ver = [&]() -> void
+    {
+        snapshot->header.version = 3;
+        switch(_setup.machine_type) {
+            case XCPC_MACHINE_TYPE_CPC464:
+                snapshot->header.cpc_type = 0;
+                break;
+            case XCPC_MACHINE_TYPE_CPC664:
+                snapshot->header.cpc_type = 1;
+                break;
+            case XCPC_MACHINE_TYPE_CPC6128:
+                snapshot->header.cpc_type = 2;
+                break;
+            default:
+                snapshot->header.cpc_type = 0;
+                break;
+        }
+    };
+
     auto save_mem = [&]() -> void
     {
         size_t ram_size = static_cast<uint32_t>(_setup.memory_size);
@@ -1960,12 +3058,419 @@ auto Mainboard::save_cpc(sna::Snapshot& snapshot) -> void
         save_psg();
         save_ram();
         save_rom();
+        save_ver();
         save_mem();
     };
 
     return save_all();
 }
 
+auto Mainboard::write_psg(const uint8_t value) -> uint8_t
+{
+    auto& psg(*_psg);
+    const uint8_t index = psg->index;
+    const uint8_t data  = psg.set_value(value);
+
+    /* a failing log must not abort the i/o cycle of the cpu: it is stopped instead */
+    if((_psglog != nullptr) && (index < 14) && (_ahead.active == 0)) {
+        try {
+            _psglog->write(psg->ticks, index, data);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while writing psg log: %s", e.what());
+            stop_psg_log();
+        }
+    }
+    return data;
+}
+
+auto Mainboard::fast_transfer(cpu::Instance& instance, uint8_t status) -> uint8_t
+{
+    /*
+     * AMSDOS transfers the sectors with the following polling loops:
+     *
+     *   read:  inc c / in a,(c) / ld (hl),a / dec c / inc hl
+     *   write: inc c / ld a,(hl) / out (c),a / dec c / inc hl
+     *   poll:  in a,(c) / jp p,poll / and 0x20 / jr nz,read-or-write
+     *
+     * When the status is polled from such a loop during the execution
+     * phase, the whole transfer is done at once. The value returned is the
+     * status of the result phase, so the loop exits as it would have done,
+     * with the same registers and the same memory contents.
+     */
+    static const uint8_t poll_code[] = {
+        0xed, 0x78, 0xf2, 0x00, 0x00, 0xe6, 0x20, 0x20, 0xf1
+    };
+    static const uint8_t read_code[] = {
+        0x0c, 0xed, 0x78, 0x77, 0x0d, 0x23
+    };
+    static const uint8_t write_code[] = {
+        0x0c, 0x7e, 0xed, 0x79, 0x0d, 0x23
+    };
+    auto&          cpu(instance);
+    auto&          fdc(*_fdc);
+    const uint16_t poll = (cpu->r_pc.w.l - 2);
+    const uint16_t body = (poll - sizeof(read_code));
+    uint16_t       addr = cpu->r_hl.w.l;
+    uint32_t       size = 0;
+
+    auto matches = [&](const uint16_t where, const uint8_t* code, const size_t length) -> bool
+    {
+        for(size_t index = 0; index < length; ++index) {
+            const uint16_t at = (where + index);
+            if(((index == 3) || (index == 4)) && (code == poll_code)) {
+                if(cpu_mreq_rd(cpu, at, 0x00) != static_cast<uint8_t>(poll >> ((index - 3) * 8))) {
+                    return false;
+                }
+            }
+            else if(cpu_mreq_rd(cpu, at, 0x00) != code[index]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto transfer_rd = [&]() -> void
+    {
+        while(((status & 0xa0) == 0xa0) && (size++ < 0x10000)) {
+            static_cast<void>(cpu_mreq_wr(cpu, addr++, fdc.rd_data(0xff)));
+            status = fdc.rd_stat(0xff);
+        }
+    };
+
+    auto transfer_wr = [&]() -> void
+    {
+        while(((status & 0xa0) == 0xa0) && (size++ < 0x10000)) {
+            static_cast<void>(fdc.wr_data(cpu_mreq_rd(cpu, addr++, 0xff)));
+            status = fdc.rd_stat(0xff);
+        }
+    };
+
+    auto transfer = [&]() -> uint8_t
+    {
+        if(matches(poll, poll_code, sizeof(poll_code)) == false) {
+            return status;
+        }
+        if(matches(body, read_code, sizeof(read_code)) != false) {
+            transfer_rd();
+        }
+        else if(matches(body, write_code, sizeof(write_code)) != false) {
+            transfer_wr();
+        }
+        cpu->r_hl.w.l = addr;
+        return status;
+    };
+
+    return transfer();
+}
+
+auto Mainboard::amsdos_trap(cpu::Instance& instance, uint16_t addr) -> bool
+{
+    /*
+     * Once AMSDOS is initialized, the cassette entries of the firmware
+     * jumpblock (0xbc77-0xbc98) are far calls into the AMSDOS rom. When the
+     * drive targeted by such a call maps a host directory, the call is
+     * serviced here from the host files and the fetched opcode is replaced
+     * by a RET, so the caller gets the registers and the flags that AMSDOS
+     * would have returned. The FDC is not involved at all.
+     */
+    constexpr uint8_t CF = 0x01;
+    constexpr uint8_t ZF = 0x40;
+    auto&             cpu(instance);
+    auto&             fdc(*_fdc);
+    auto&             bridge(_bridge);
+
+    auto rd_byte = [&](const uint16_t at) -> uint8_t
+    {
+        return cpu_mreq_rd(cpu, at, 0x00);
+    };
+
+    auto wr_byte = [&](const uint16_t at, const uint8_t data) -> void
+    {
+        static_cast<void>(cpu_mreq_wr(cpu, at, data));
+    };
+
+    auto succeed = [&]() -> bool
+    {
+        cpu->r_af.b.l = ((cpu->r_af.b.l & ~ZF) | CF);
+        return true;
+    };
+
+    auto fail = [&](const uint8_t error) -> bool
+    {
+        cpu->r_af.b.h = error;
+        cpu->r_af.b.l = (cpu->r_af.b.l & ~(CF | ZF));
+        return true;
+    };
+
+    auto get_filename = [&]() -> amsdos::Filename
+    {
+        std::string    string;
+        const uint16_t start = cpu->r_hl.w.l;
+        const uint8_t  count = cpu->r_bc.b.h;
+        for(uint8_t index = 0; index < count; ++index) {
+            string += static_cast<char>(rd_byte(start + index));
+        }
+        return amsdos::Folder::parse(string);
+    };
+
+    auto get_folder = [&](const amsdos::Filename& filename) -> std::string
+    {
+        int drive = filename.drive;
+        if(drive < 0) {
+            const uint16_t workspace = (rd_byte(0xbe7d) << 0)
+                                     | (rd_byte(0xbe7e) << 8);
+            drive = (rd_byte(workspace) & 1);
+        }
+        return fdc.get_folder(drive);
+    };
+
+    auto put_header = [&](amsdos::Header& header, const uint16_t at) -> void
+    {
+        for(uint16_t index = 0; index < 64; ++index) {
+            wr_byte(at + index, header.info.raw[index]);
+        }
+    };
+
+    auto get_header = [&](amsdos::Header& header, const uint16_t at) -> void
+    {
+        for(uint16_t index = 0; index < 64; ++index) {
+            header.info.raw[index] = rd_byte(at + index);
+        }
+    };
+
+    auto in_open = [&]() -> bool
+    {
+        const amsdos::Filename filename(get_filename());
+        const std::string      folder(get_folder(filename));
+        if(folder.empty()) {
+            return false;
+        }
+        if(bridge.reader != nullptr) {
+            return fail(amsdos::ERROR_NOT_OPEN);
+        }
+        const std::string pathname(amsdos::Folder(folder).find_file(filename));
+        if(pathname.empty()) {
+            ::xcpc_log_error("amsdos: %s.%s: file not found", filename.name.c_str(), filename.extension.c_str());
+            return fail(amsdos::ERROR_NOT_FOUND);
+        }
+        try {
+            bridge.reader = new amsdos::FileReader(pathname);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("amsdos: %s: %s", pathname.c_str(), e.what());
+            return fail(amsdos::ERROR_NOT_FOUND);
+        }
+        amsdos::Header& header(bridge.reader->get_header());
+        const uint16_t  buffer = cpu->r_de.w.l;
+        if((header.info.s.file_type & 0x0e) == 0x06) {
+            header.info.s.data_location_lsb = static_cast<uint8_t>(buffer >> 0);
+            header.info.s.data_location_msb = static_cast<uint8_t>(buffer >> 8);
+        }
+        put_header(header, buffer);
+        cpu->r_hl.w.l = buffer;
+        cpu->r_de.b.l = header.info.s.data_location_lsb;
+        cpu->r_de.b.h = header.info.s.data_location_msb;
+        cpu->r_bc.b.l = header.info.s.logical_length_lsb;
+        cpu->r_bc.b.h = header.info.s.logical_length_msb;
+        cpu->r_af.b.h = header.info.s.file_type;
+        return succeed();
+    };
+
+    auto in_close = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        bridge.reader = (delete bridge.reader, nullptr);
+        return succeed();
+    };
+
+    auto in_abandon = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        bridge.reader = (delete bridge.reader, nullptr);
+        return true;
+    };
+
+    auto in_char = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        uint8_t       data  = 0x00;
+        const uint8_t error = bridge.reader->get_char(data);
+        if(error != amsdos::ERROR_NONE) {
+            return fail(error);
+        }
+        cpu->r_af.b.h = data;
+        return succeed();
+    };
+
+    auto in_direct = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        amsdos::Header& header(bridge.reader->get_header());
+        uint16_t        at = cpu->r_hl.w.l;
+        for(const auto data : bridge.reader->get_data()) {
+            wr_byte(at++, data);
+        }
+        cpu->r_hl.b.l = header.info.s.entry_address_lsb;
+        cpu->r_hl.b.h = header.info.s.entry_address_msb;
+        return succeed();
+    };
+
+    auto in_return = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        bridge.reader->unget_char();
+        return true;
+    };
+
+    auto in_test_eof = [&]() -> bool
+    {
+        if(bridge.reader == nullptr) {
+            return false;
+        }
+        const uint8_t error = bridge.reader->test_eof();
+        if(error != amsdos::ERROR_NONE) {
+            return fail(error);
+        }
+        return succeed();
+    };
+
+    auto out_open = [&]() -> bool
+    {
+        const amsdos::Filename filename(get_filename());
+        const std::string      folder(get_folder(filename));
+        if(folder.empty()) {
+            return false;
+        }
+        if(bridge.writer != nullptr) {
+            return fail(amsdos::ERROR_NOT_OPEN);
+        }
+        bridge.writer = new amsdos::FileWriter(folder, filename);
+        bridge.header = cpu->r_de.w.l;
+        put_header(bridge.writer->get_header(), bridge.header);
+        cpu->r_hl.w.l = bridge.header;
+        return succeed();
+    };
+
+    auto out_close = [&]() -> bool
+    {
+        if(bridge.writer == nullptr) {
+            return false;
+        }
+        get_header(bridge.writer->get_header(), bridge.header);
+        try {
+            bridge.writer->close();
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("amsdos: %s", e.what());
+            bridge.writer = (delete bridge.writer, nullptr);
+            return fail(amsdos::ERROR_DISC_FULL);
+        }
+        bridge.writer = (delete bridge.writer, nullptr);
+        return succeed();
+    };
+
+    auto out_abandon = [&]() -> bool
+    {
+        if(bridge.writer == nullptr) {
+            return false;
+        }
+        bridge.writer = (delete bridge.writer, nullptr);
+        return true;
+    };
+
+    auto out_char = [&]() -> bool
+    {
+        if(bridge.writer == nullptr) {
+            return false;
+        }
+        bridge.writer->put_char(cpu->r_af.b.h);
+        return succeed();
+    };
+
+    auto out_direct = [&]() -> bool
+    {
+        if(bridge.writer == nullptr) {
+            return false;
+        }
+        amsdos::Header& header(bridge.writer->get_header());
+        get_header(header, bridge.header);
+        header.info.s.file_type          = cpu->r_af.b.h;
+        header.info.s.data_location_lsb  = cpu->r_hl.b.l;
+        header.info.s.data_location_msb  = cpu->r_hl.b.h;
+        header.info.s.logical_length_lsb = cpu->r_de.b.l;
+        header.info.s.logical_length_msb = cpu->r_de.b.h;
+        header.info.s.entry_address_lsb  = cpu->r_bc.b.l;
+        header.info.s.entry_address_msb  = cpu->r_bc.b.h;
+        put_header(header, bridge.header);
+        const uint16_t start = cpu->r_hl.w.l;
+        const uint16_t count = cpu->r_de.w.l;
+        for(uint16_t index = 0; index < count; ++index) {
+            bridge.writer->put_char(rd_byte(start + index));
+        }
+        return succeed();
+    };
+
+    auto abandon = [&]() -> bool
+    {
+        /* host files can't be restored: the ahead pass is abandoned and the call is left to the real frame */
+        if((fdc.get_folder(0).empty() == false) || (fdc.get_folder(1).empty() == false)) {
+            _ahead.aborted = 1;
+        }
+        return false;
+    };
+
+    auto trap = [&]() -> bool
+    {
+        if(_ahead.active != 0) {
+            return abandon();
+        }
+        switch(addr) {
+            case 0xbc77: return in_open();
+            case 0xbc7a: return in_close();
+            case 0xbc7d: return in_abandon();
+            case 0xbc80: return in_char();
+            case 0xbc83: return in_direct();
+            case 0xbc86: return in_return();
+            case 0xbc89: return in_test_eof();
+            case 0xbc8c: return out_open();
+            case 0xbc8f: return out_close();
+            case 0xbc92: return out_abandon();
+            case 0xbc95: return out_char();
+            case 0xbc98: return out_direct();
+            default:
+                break;
+        }
+        return false;
+    };
+
+    return trap();
+}
+
+auto Mainboard::sync_fdc() -> void
+{
+    /*
+     * The fdc is an event source: the mainboard only counts the ticks down
+     * to its next event. Before and after each access to its ports, the fdc
+     * catches up with the ticks elapsed so far and tells when it has to be
+     * woken up next, so an idle fdc costs nothing.
+     */
+    auto&          fdc(*_fdc);
+    const uint32_t elapsed = (_state.fdc_delay - _state.fdc_event);
+
+    _state.fdc_delay = _state.fdc_event = fdc.advance(elapsed);
+}
+
 auto Mainboard::update_vga() -> void
 {
     auto& dpy(*_dpy);
@@ -2089,11 +3594,90 @@ auto Mainboard::update_pal() -> void
             _state.pal_rd[3] = (*_exp[_state.rom_conf])->data;
         }
     }
+    for(int bank = 0; bank < 4; ++bank) {
+        for(auto& ram : _ram) {
+            if(_state.pal_wr[bank] == (*ram)->data) {
+                _state.pal_pg[bank] = (*ram)->dirty;
+                break;
+            }
+        }
+    }
 }
 
 auto Mainboard::update_stats() -> void
 {
     unsigned long elapsed_us = 0;
+    struct {
+        uint32_t histogram[SND_HISTOGRAM];
+        uint32_t underruns;
+        uint32_t dropped;
+        uint32_t callbacks;
+        uint32_t callback_time;
+        uint32_t callback_peak;
+    } audio;
+    struct {
+        size_t   states;
+        size_t   memory;
+        uint32_t captures;
+        uint32_t capture_time;
+        uint32_t capture_peak;
+    } rewind;
+    struct {
+        uint32_t passes;
+        uint32_t pass_time;
+        uint32_t pass_peak;
+    } ahead;
+
+    /* a page is shared by consecutive states only, so each change along the ring is a distinct page */
+    auto count_pages = [&]() -> size_t
+    {
+        const size_t      length = _rewind_ring.length();
+        const size_t      count  = _rewind_ring.count();
+        const mem::Pages* prev   = nullptr;
+        size_t            pages  = 0;
+
+        for(size_t index = 0; index < count; ++index) {
+            const auto& banks(_rewind_banks[(_rewind_ring.head() + length - count + index) % length]);
+            pages += Traits::count_pages(banks.ram, prev);
+            prev = banks.ram;
+        }
+        return pages + Traits::count_pages(_rewind_state.ram, prev);
+    };
+
+    /* snapshot the rewind counters and restart the capture timings */ {
+        const MutexLock lock(_mutex);
+        rewind.states        = _rewind_ring.count();
+        rewind.memory        = _rewind_ring.memory() + (count_pages() * sizeof(mem::Page));
+        rewind.captures      = _rewind.captures;
+        rewind.capture_time  = _rewind.capture_time;
+        rewind.capture_peak  = _rewind.capture_peak;
+        _rewind.captures     &= 0;
+        _rewind.capture_time &= 0;
+        _rewind.capture_peak &= 0;
+    }
+    /* snapshot the run-ahead counters and restart the pass timings */ {
+        const MutexLock lock(_mutex);
+        ahead.passes     = _ahead.passes;
+        ahead.pass_time  = _ahead.pass_time;
+        ahead.pass_peak  = _ahead.pass_peak;
+        _ahead.passes    &= 0;
+        _ahead.pass_time &= 0;
+        _ahead.pass_peak &= 0;
+    }
+    /* snapshot the audio counters and restart the callback timings */ {
+        const MutexLock lock(_mutex);
+        for(uint32_t index = 0; index < SND_HISTOGRAM; ++index) {
+            audio.histogram[index] = _audio.histogram[index];
+        }
+        audio.underruns       = _audio.underruns;
+        audio.dropped         = _audio.dropped;
+        audio.callbacks       = _audio.callbacks;
+        audio.callback_time   = _audio.callback_time;
+        audio.callback_peak   = _audio.callback_peak;
+        _audio.callbacks     &= 0;
+        _audio.callback_time &= 0;
+        _audio.callback_peak &= 0;
+    }
 
     /* get the current time */ {
         Traits::gettimeofday(_clock.currtime);
@@ -2112,8 +3696,76 @@ auto Mainboard::update_stats() -> void
         const float stats_frames  = static_cast<float>(_stats.frame_drawn * 1000000UL);
         const float stats_elapsed = static_cast<float>(elapsed_us);
         const float stats_fps     = ::rintf(stats_frames / stats_elapsed);
-        const int rc = ::snprintf ( _stats.buffer, sizeof(_stats.buffer), "%d fps", static_cast<int>(stats_fps));
-        static_cast<void>(rc);
+        int rc = ::snprintf ( _stats.buffer, sizeof(_stats.buffer)
+                            , "%d fps, %u underruns, %u dropped"
+                            , static_cast<int>(stats_fps)
+                            , audio.underruns
+                            , audio.dropped );
+        if((_setup.rewind_interval != 0) && (rc > 0) && (static_cast<size_t>(rc) < sizeof(_stats.buffer))) {
+            const uint32_t capture_mean = (rewind.captures != 0 ? rewind.capture_time / rewind.captures : 0);
+            const int rs = ::snprintf ( _stats.buffer + rc, sizeof(_stats.buffer) - rc
+                                      , ", rewind %u KB, %u us"
+                                      , static_cast<unsigned int>(rewind.memory / 1024)
+                                      , capture_mean );
+            if(rs > 0) {
+                rc += rs;
+            }
+        }
+        if((_setup.runahead != 0) && (rc > 0) && (static_cast<size_t>(rc) < sizeof(_stats.buffer))) {
+            const uint32_t pass_mean = (ahead.passes != 0 ? ahead.pass_time / ahead.passes : 0);
+            const int rs = ::snprintf ( _stats.buffer + rc, sizeof(_stats.buffer) - rc
+                                      , ", runahead %u, %u us"
+                                      , _setup.runahead
+                                      , pass_mean );
+            static_cast<void>(rs);
+        }
+    }
+    /* log the rewind usage */ {
+        const uint32_t capture_mean = (rewind.captures != 0 ? rewind.capture_time / rewind.captures : 0);
+        ::xcpc_log_debug ( "rewind: %u states, %u KB, %u captures, mean %u us, peak %u us"
+                         , static_cast<unsigned int>(rewind.states)
+                         , static_cast<unsigned int>(rewind.memory / 1024)
+                         , rewind.captures
+                         , capture_mean
+                         , rewind.capture_peak );
+    }
+    /* log the run-ahead usage */ {
+        const uint32_t pass_mean = (ahead.passes != 0 ? ahead.pass_time / ahead.passes : 0);
+        ::xcpc_log_debug ( "runahead: %u frames, %u passes, mean %u us, peak %u us"
+                         , _setup.runahead
+                         , ahead.passes
+                         , pass_mean
+                         , ahead.pass_peak );
+    }
+    /* publish the audio health */ {
+        static_assert(countof(_audio_stats.histogram) == SND_HISTOGRAM, "the audio histograms differ in size");
+        for(uint32_t index = 0; index < SND_HISTOGRAM; ++index) {
+            _audio_stats.histogram[index] = audio.histogram[index];
+        }
+        _audio_stats.sample_rate   = _device->sampleRate;
+        _audio_stats.channels      = _device->playback.channels;
+        _audio_stats.period_frames = _device->playback.internalPeriodSizeInFrames;
+        _audio_stats.periods       = _device->playback.internalPeriods;
+        _audio_stats.underruns     = audio.underruns;
+        _audio_stats.dropped       = audio.dropped;
+        _audio_stats.callbacks     = audio.callbacks;
+        _audio_stats.callback_mean = (audio.callbacks != 0 ? audio.callback_time / audio.callbacks : 0);
+        _audio_stats.callback_peak = audio.callback_peak;
+    }
+    /* log the audio health */ {
+        const uint32_t callback_mean = (audio.callbacks != 0 ? audio.callback_time / audio.callbacks : 0);
+        ::xcpc_log_debug ( "audio: %u callbacks, mean %u us, peak %u us, fill [%u|%u|%u|%u|%u|%u], %u underruns, %u dropped"
+                         , audio.callbacks
+                         , callback_mean
+                         , audio.callback_peak
+                         , audio.histogram[0]
+                         , audio.histogram[1]
+                         , audio.histogram[2]
+                         , audio.histogram[3]
+                         , audio.histogram[4]
+                         , audio.histogram[5]
+                         , audio.underruns
+                         , audio.dropped );
     }
     /* set the new reference */ {
         _clock.proftime = _clock.currtime;
@@ -3311,34 +4963,53 @@ auto Mainboard::process(const void* input, void* output, const uint32_t count) -
 {
     const MutexLock lock(_mutex);
 
+    return render_audio(output, count);
+}
+
+auto Mainboard::pump_audio() -> void
+{
+    /* without an audio device, the samples of the frame are rendered here for the capture */
+    if((_device.is_enabled() != false) || (_capture == nullptr) || (_ahead.active != 0)) {
+        return;
+    }
+    const uint32_t     count = ((_audio.wr_index + SND_BUFSIZE - _audio.rd_index) % SND_BUFSIZE);
+    std::vector<float> output(count * _device->playback.channels);
+
+    return render_audio(output.data(), count);
+}
+
+auto Mainboard::render_audio(void* output, const uint32_t count) -> void
+{
     auto mix_mono = [&](MonoFrameFlt32& audio_frame) -> void
     {
-        const auto index = _audio.rd_index;
+        const auto  index = _audio.rd_index;
+        const float scale = (_audio.volume / (3.0f * 32768.0f));
 
-        const float mono = (_audio.channel0[index] * 1.00f)
-                         + (_audio.channel1[index] * 1.00f)
-                         + (_audio.channel2[index] * 1.00f)
-                         ;
+        const int32_t mono = (_audio.channel0[index] * 1)
+                           + (_audio.channel1[index] * 1)
+                           + (_audio.channel2[index] * 1)
+                           ;
 
-        audio_frame.mono = ((mono / 3.0f) * _audio.volume);
+        audio_frame.mono = (static_cast<float>(mono) * scale);
     };
 
     auto mix_stereo = [&](StereoFrameFlt32& audio_frame) -> void
     {
-        const auto index = _audio.rd_index;
+        const auto  index = _audio.rd_index;
+        const float scale = (_audio.volume / (6.0f * 32768.0f));
 
-        const float left  = (_audio.channel0[index] * 0.75f)
-                          + (_audio.channel1[index] * 0.50f)
-                          + (_audio.channel2[index] * 0.25f)
-                          ;
+        const int32_t left  = (_audio.channel0[index] * 3)
+                            + (_audio.channel1[index] * 2)
+                            + (_audio.channel2[index] * 1)
+                            ;
 
-        const float right = (_audio.channel0[index] * 0.25f)
-                          + (_audio.channel1[index] * 0.50f)
-                          + (_audio.channel2[index] * 0.75f)
-                          ;
+        const int32_t right = (_audio.channel0[index] * 1)
+                            + (_audio.channel1[index] * 2)
+                            + (_audio.channel2[index] * 3)
+                            ;
 
-        audio_frame.left  = ((left  / 1.5f) * _audio.volume);
-        audio_frame.right = ((right / 1.5f) * _audio.volume);
+        audio_frame.left  = (static_cast<float>(left ) * scale);
+        audio_frame.right = (static_cast<float>(right) * scale);
     };
 
     auto render_mono = [&]() -> void
@@ -3349,6 +5020,7 @@ auto Mainboard::process(const void* input, void* output, const uint32_t count) -
                 _audio.rd_index = ((_audio.rd_index + 1) % SND_BUFSIZE);
             }
             else {
+                ++_audio.underruns;
                 break;
             }
         }
@@ -3362,13 +5034,43 @@ auto Mainboard::process(const void* input, void* output, const uint32_t count) -
                 _audio.rd_index = ((_audio.rd_index + 1) % SND_BUFSIZE);
             }
             else {
+                ++_audio.underruns;
                 break;
             }
         }
     };
 
+    auto update_histogram = [&]() -> void
+    {
+        const uint32_t fill   = ((_audio.wr_index + SND_BUFSIZE - _audio.rd_index) % SND_BUFSIZE);
+        uint32_t       period = (count != 0 ? count : 1);
+        uint32_t       bucket = 0;
+
+        if(fill != 0) {
+            for(++bucket; (bucket < (SND_HISTOGRAM - 1)) && (fill >= period); ++bucket) {
+                period <<= 1;
+            }
+        }
+        ++_audio.histogram[bucket];
+    };
+
+    auto update_timings = [&](const std::chrono::steady_clock::time_point& started) -> void
+    {
+        const auto     elapsed = (std::chrono::steady_clock::now() - started);
+        const uint32_t time_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        ++_audio.callbacks;
+        _audio.callback_time += time_us;
+        if(_audio.callback_peak < time_us) {
+            _audio.callback_peak = time_us;
+        }
+    };
+
     auto render = [&]() -> void
     {
+        const auto started = std::chrono::steady_clock::now();
+
+        update_histogram();
         switch(_device->playback.channels) {
             case 1:
                 render_mono();
@@ -3379,9 +5081,23 @@ auto Mainboard::process(const void* input, void* output, const uint32_t count) -
             default:
                 break;
         }
+        update_timings(started);
+    };
+
+    auto capture = [&]() -> void
+    {
+        if(_capture != nullptr) {
+            _capture->push(reinterpret_cast<const float*>(output), count);
+        }
+    };
+
+    auto process = [&]() -> void
+    {
+        render();
+        capture();
     };
 
-    return render();
+    return process();
 }
 
 auto Mainboard::cpu_mreq_m1(cpu::Instance& instance, uint16_t addr, uint8_t data) -> uint8_t
@@ -3391,6 +5107,13 @@ auto Mainboard::cpu_mreq_m1(cpu::Instance& instance, uint16_t addr, uint8_t data
         const uint16_t offset = ((addr >>  0) & 0x3fff);
         data = _state.pal_rd[bank][offset];
     }
+    /* amsdos bridge */ {
+        if((static_cast<uint16_t>(addr - 0xbc77) <= 0x21) && (data == 0xdf)) {
+            if(amsdos_trap(instance, addr) != false) {
+                data = 0xc9;
+            }
+        }
+    }
     /* adjust t-states */ {
         auto& cpu(*_cpu);
         const uint32_t old_t_states = cpu->t_states;
@@ -3418,6 +5141,7 @@ auto Mainboard::cpu_mreq_wr(cpu::Instance& instance, uint16_t addr, uint8_t data
         const uint16_t bank   = ((addr >> 14) & 0x0003);
         const uint16_t offset = ((addr >>  0) & 0x3fff);
         _state.pal_wr[bank][offset] = data;
+        _state.pal_pg[bank][offset >> mem::PAGE_SHIFT] = 1;
     }
     return data;
 }
@@ -3517,6 +5241,7 @@ auto Mainboard::cpu_iorq_rd(cpu::Instance& instance, uint16_t port, uint8_t data
         if((port & 0x0480) == 0) {
             auto& fdc(*(_fdc));
             const uint8_t function = (((port >> 7) & 2) | (port & 1));
+            sync_fdc();
             switch(function) {
                 case 0: /* [-----0-00xxxxxx0] [0xfa7e] */
                     {
@@ -3531,6 +5256,9 @@ auto Mainboard::cpu_iorq_rd(cpu::Instance& instance, uint16_t port, uint8_t data
                 case 2: /* [-----0-10xxxxxx0] [0xfb7e] */
                     {
                         data = fdc.rd_stat(data);
+                        if((_setup.fastload != false) && ((data & 0xa0) == 0xa0)) {
+                            data = fast_transfer(instance, data);
+                        }
                     }
                     break;
                 case 3: /* [-----0-10xxxxxx1] [0xfb7f] */
@@ -3539,6 +5267,7 @@ auto Mainboard::cpu_iorq_rd(cpu::Instance& instance, uint16_t port, uint8_t data
                     }
                     break;
             }
+            sync_fdc();
         }
     }
     return data;
@@ -3623,6 +5352,7 @@ auto Mainboard::cpu_iorq_wr(cpu::Instance& instance, uint16_t port, uint8_t data
         if((port & 0x0480) == 0) {
             auto& fdc(*(_fdc));
             const uint8_t function = (((port >> 7) & 2) | ((port >> 0) & 1));
+            sync_fdc();
             switch(function) {
                 case 0: /* [-----0-00xxxxxx0] [0xfa7e] */
                     {
@@ -3645,6 +5375,7 @@ auto Mainboard::cpu_iorq_wr(cpu::Instance& instance, uint16_t port, uint8_t data
                     }
                     break;
             }
+            sync_fdc();
         }
     }
     return data;
@@ -3796,7 +5527,7 @@ auto Mainboard::ppi_port_a_wr(ppi::Instance& instance, uint8_t data) -> uint8_t
 
     auto psg_set_value = [&]() -> uint8_t
     {
-        return _psg->set_value(data);
+        return write_psg(data);
     };
 
     auto psg_set_index = [&]() -> uint8_t
@@ -3889,7 +5620,7 @@ auto Mainboard::ppi_port_c_wr(ppi::Instance& instance, uint8_t data) -> uint8_t
 
     auto psg_set_value = [&]() -> uint8_t
     {
-        return _psg->set_value(_state.psg_data);
+        return write_psg(_state.psg_data);
     };
 
     auto psg_set_index = [&]() -> uint8_t
@@ -3981,6 +5712,46 @@ auto Mainboard::psg_port_b_wr(psg::Instance& instance, uint8_t data) -> uint8_t
     return process();
 }
 
+auto Mainboard::mov_keyboard(mov::Recording& recording, uint8_t row, uint8_t value) -> void
+{
+    auto& kbd(*_kbd);
+
+    kbd->keys[row & 0x0f] = value;
+}
+
+auto Mainboard::mov_reset(mov::Recording& recording) -> void
+{
+    return reset();
+}
+
+auto Mainboard::mov_insert_disk(mov::Recording& recording, uint8_t drive, const std::string& filename) -> void
+{
+    switch(drive) {
+        case 0:
+            insert_disk_into_drive0(filename);
+            break;
+        case 1:
+            insert_disk_into_drive1(filename);
+            break;
+        default:
+            break;
+    }
+}
+
+auto Mainboard::mov_remove_disk(mov::Recording& recording, uint8_t drive) -> void
+{
+    switch(drive) {
+        case 0:
+            remove_disk_from_drive0();
+            break;
+        case 1:
+            remove_disk_from_drive1();
+            break;
+        default:
+            break;
+    }
+}
+
 }
 
 // ---------------------------------------------------------------------------
@@ -27,14 +27,23 @@
 #include <xcpc/amstrad/psg/psg-core.h>
 #include <xcpc/amstrad/fdc/fdc-core.h>
 #include <xcpc/amstrad/mem/mem-core.h>
+#include <xcpc/formats/amsdos/amsdos-format.h>
 #include <xcpc/formats/cdt/cdt-format.h>
 #include <xcpc/formats/dsk/dsk-format.h>
+#include <xcpc/formats/mov/mov-format.h>
 #include <xcpc/formats/sna/sna-format.h>
+#include <xcpc/formats/vgm/vgm-format.h>
 
 // ---------------------------------------------------------------------------
 // forward declarations
 // ---------------------------------------------------------------------------
 
+namespace wav {
+
+class WaveCapture;
+
+}
+
 namespace cpc {
 
 using TimeVal   = struct timeval;
@@ -42,6 +51,69 @@ using PaintFunc = void (*)(Mainboard*);
 
 }
 
+// ---------------------------------------------------------------------------
+// cpc::Checkpoint
+// ---------------------------------------------------------------------------
+
+namespace cpc {
+
+struct Checkpoint
+{
+    Buffer     state;  /* serialized state without the ram banks */
+    mem::Pages ram[8]; /* ram banks, pages shared between saves   */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// cpc::RewindBanks
+// ---------------------------------------------------------------------------
+
+namespace cpc {
+
+struct RewindBanks
+{
+    mem::Pages ram[8]; /* ram banks of a rewind state, pages shared between states */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// cpc::FrameDigest
+// ---------------------------------------------------------------------------
+
+namespace cpc {
+
+struct FrameDigest
+{
+    uint64_t video; /* hash of the last displayed frame     */
+    uint64_t audio; /* running hash of the produced samples */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// cpc::AudioStats
+// ---------------------------------------------------------------------------
+
+namespace cpc {
+
+struct AudioStats
+{
+    uint32_t sample_rate;   /* negotiated sample rate                 */
+    uint32_t channels;      /* negotiated number of channels          */
+    uint32_t period_frames; /* negotiated period size in frames       */
+    uint32_t periods;       /* negotiated number of periods           */
+    uint32_t histogram[6];  /* ring fill level in periods             */
+    uint32_t underruns;     /* callbacks out of samples               */
+    uint32_t dropped;       /* samples dropped (ring full)            */
+    uint32_t callbacks;     /* callbacks during the last interval     */
+    uint32_t callback_mean; /* mean callback time in us               */
+    uint32_t callback_peak; /* longest callback in us                 */
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // cpc::Mainboard
 // ---------------------------------------------------------------------------
@@ -60,6 +132,7 @@ class Mainboard final
     , private psg::Interface
     , private fdc::Interface
     , private mem::Interface
+    , private mov::Interface
 {
 public: // public interface
     Mainboard(Machine& machine);
@@ -85,18 +158,56 @@ public: // public interface
 
     auto save_snapshot(const std::string& filename) -> void;
 
+    auto serialize(Buffer& buffer) -> void;
+
+    auto deserialize(const Buffer& buffer) -> void;
+
+    auto get_serialized_size() const -> size_t;
+
+    auto save_checkpoint(Checkpoint& checkpoint) -> void;
+
+    auto load_checkpoint(const Checkpoint& checkpoint) -> void;
+
+    auto rewind() -> bool;
+
+    auto quick_save(const unsigned slot) -> void;
+
+    auto quick_load(const unsigned slot) -> bool;
+
+    auto digest_frame(FrameDigest& digest) -> void;
+
+    auto start_psg_log(const std::string& filename) -> void;
+
+    auto stop_psg_log() -> void;
+
+    auto start_audio_capture(const std::string& filename, const std::string& format) -> void;
+
+    auto stop_audio_capture() -> void;
+
+    auto start_movie_record(const std::string& filename) -> void;
+
+    auto stop_movie_record() -> void;
+
+    auto start_movie_replay(const std::string& filename) -> void;
+
+    auto stop_movie_replay() -> void;
+
     auto create_disk_into_drive0(const std::string& filename) -> void;
 
     auto insert_disk_into_drive0(const std::string& filename) -> void;
 
     auto remove_disk_from_drive0() -> void;
 
+    auto flush_disk_in_drive0() -> void;
+
     auto create_disk_into_drive1(const std::string& filename) -> void;
 
     auto insert_disk_into_drive1(const std::string& filename) -> void;
 
     auto remove_disk_from_drive1() -> void;
 
+    auto flush_disk_in_drive1() -> void;
+
     auto set_volume(const float volume) -> void;
 
     auto set_scanlines(const bool scanlines) -> void;
@@ -133,6 +244,8 @@ public: // public interface
 
     auto get_statistics() const -> std::string;
 
+    auto get_audio_statistics() const -> AudioStats;
+
 public: // backend interface
     auto on_reset(Event& event) -> unsigned long;
 
@@ -160,6 +273,7 @@ public: // public types
     static constexpr uint32_t FLAG_RESET  = 0x01;
     static constexpr uint32_t FLAG_PAUSE  = 0x02;
     static constexpr uint32_t SND_BUFSIZE = 16384;
+    static constexpr uint32_t SND_HISTOGRAM = 6;
 
     struct Setup
     {
@@ -172,6 +286,11 @@ public: // public types
         uint32_t     speedup;
         bool         xshm;
         bool         scanlines;
+        bool         fastload;
+        fdc::Timing  fdctiming;
+        uint32_t     rewind_interval;
+        uint32_t     rewind_length;
+        uint32_t     runahead;
     };
 
     struct Stats
@@ -206,6 +325,10 @@ public: // public types
         uint32_t psg_ticks;   /* psg ticks                 */
         uint32_t snd_clock;   /* snd clock                 */
         uint32_t snd_ticks;   /* snd ticks                 */
+        uint32_t fdc_clock;   /* fdc clock                 */
+        uint32_t fdc_ticks;   /* fdc ticks                 */
+        uint32_t fdc_delay;   /* fdc ticks of last event   */
+        uint32_t fdc_event;   /* fdc ticks to next event   */
         uint8_t  vdc_hsync;   /* display hsync signal      */
         uint8_t  vdc_vsync;   /* display vsync signal      */
         uint8_t  lnk_lk1;     /* manufacturer id bit1      */
@@ -226,16 +349,23 @@ public: // public types
         uint8_t  rom_conf;    /* rom configuration         */
         uint8_t* pal_rd[4];   /* pal ram/rom read banking  */
         uint8_t* pal_wr[4];   /* pal ram/rom write banking */
+        uint8_t* pal_pg[4];   /* pal ram written pages     */
     };
 
     struct Audio
     {
-        float    channel0[SND_BUFSIZE];
-        float    channel1[SND_BUFSIZE];
-        float    channel2[SND_BUFSIZE];
+        int16_t  channel0[SND_BUFSIZE];
+        int16_t  channel1[SND_BUFSIZE];
+        int16_t  channel2[SND_BUFSIZE];
         float    volume;
         uint32_t rd_index;
         uint32_t wr_index;
+        uint32_t histogram[SND_HISTOGRAM]; /* ring fill level in periods  */
+        uint32_t underruns;                /* callbacks out of samples    */
+        uint32_t dropped;                  /* samples dropped (ring full) */
+        uint32_t callbacks;                /* callbacks since last stats  */
+        uint32_t callback_time;            /* callback time in us         */
+        uint32_t callback_peak;            /* longest callback in us      */
     };
 
     struct Video
@@ -244,6 +374,35 @@ public: // public types
         uint32_t frame_duration;
     };
 
+    struct Rewind
+    {
+        uint32_t frames;       /* frames since last capture  */
+        uint32_t captures;     /* captures since last stats  */
+        uint32_t capture_time; /* capture time in us         */
+        uint32_t capture_peak; /* longest capture in us      */
+    };
+
+    struct RunAhead
+    {
+        uint32_t active;    /* emulating frames ahead    */
+        uint32_t aborted;   /* ahead pass was abandoned  */
+        uint32_t passes;    /* passes since last stats   */
+        uint32_t pass_time; /* pass time in us           */
+        uint32_t pass_peak; /* longest pass in us        */
+    };
+
+    struct Movie
+    {
+        uint64_t cycles; /* cpc clock cycles since power-on */
+    };
+
+    struct Bridge
+    {
+        amsdos::FileReader* reader; /* host file open for input  */
+        amsdos::FileWriter* writer; /* host file open for output */
+        uint16_t            header; /* output header address     */
+    };
+
 private: // private interface
     auto construct_dpy() -> void;
     auto construct_kbd() -> void;
@@ -282,12 +441,24 @@ private: // private interface
     auto reset_exp() -> void;
 
     auto configure(const Settings& settings) -> void;
+    auto get_slot_identity(SlotIdentity& identity) -> void;
     auto load_lower_rom(const std::string& filename) -> void;
     auto load_upper_rom(const std::string& filename) -> void;
     auto load_expansion(const std::string& filename, const int index) -> void;
     auto load_cpc(sna::Snapshot& snapshot) -> void;
     auto save_cpc(sna::Snapshot& snapshot) -> void;
-
+    auto serialize_state(Buffer& buffer, mem::Pages* banks) -> void;
+    auto deserialize_state(const Buffer& buffer, const mem::Pages* banks) -> void;
+    auto capture_rewind() -> void;
+    auto render_audio(void* output, const uint32_t count) -> void;
+    auto pump_audio() -> void;
+    auto paint_frame() -> void;
+    auto record_keys(const uint8_t (&keys)[16]) -> void;
+
+    auto write_psg(const uint8_t value) -> uint8_t;
+    auto fast_transfer(cpu::Instance& instance, uint8_t status) -> uint8_t;
+    auto sync_fdc() -> void;
+    auto amsdos_trap(cpu::Instance& instance, uint16_t addr) -> bool;
     auto update_vga() -> void;
     auto update_pal() -> void;
     auto update_stats() -> void;
@@ -331,26 +502,47 @@ private: // psg interface
     virtual auto psg_port_b_rd(psg::Instance& instance, uint8_t data) -> uint8_t override final;
     virtual auto psg_port_b_wr(psg::Instance& instance, uint8_t data) -> uint8_t override final;
 
+private: // mov interface
+    virtual auto mov_keyboard(mov::Recording& recording, uint8_t row, uint8_t value) -> void override final;
+    virtual auto mov_reset(mov::Recording& recording) -> void override final;
+    virtual auto mov_insert_disk(mov::Recording& recording, uint8_t drive, const std::string& filename) -> void override final;
+    virtual auto mov_remove_disk(mov::Recording& recording, uint8_t drive) -> void override final;
+
 private: // private data
-    Machine&       _machine;
-    Setup          _setup;
-    Stats          _stats;
-    Clock          _clock;
-    Funcs          _funcs;
-    State          _state;
-    Audio          _audio;
-    Video          _video;
-    dpy::Instance* _dpy;
-    kbd::Instance* _kbd;
-    cpu::Instance* _cpu;
-    vga::Instance* _vga;
-    vdc::Instance* _vdc;
-    ppi::Instance* _ppi;
-    psg::Instance* _psg;
-    fdc::Instance* _fdc;
-    mem::Instance* _ram[8];
-    mem::Instance* _rom[2];
-    mem::Instance* _exp[256];
+    Machine&          _machine;
+    Setup             _setup;
+    Stats             _stats;
+    AudioStats        _audio_stats;
+    Clock             _clock;
+    Funcs             _funcs;
+    State             _state;
+    Audio             _audio;
+    Video             _video;
+    Rewind            _rewind;
+    RunAhead          _ahead;
+    Movie             _movie;
+    Bridge            _bridge;
+    dpy::Instance*    _dpy;
+    kbd::Instance*    _kbd;
+    cpu::Instance*    _cpu;
+    vga::Instance*    _vga;
+    vdc::Instance*    _vdc;
+    ppi::Instance*    _ppi;
+    psg::Instance*    _psg;
+    fdc::Instance*    _fdc;
+    mem::Instance*    _ram[8];
+    mem::Instance*    _rom[2];
+    mem::Instance*    _exp[256];
+    vgm::Recorder*    _psglog;
+    wav::WaveCapture* _capture;
+    mov::Recorder*    _record;
+    mov::Recording*   _replay;
+    RewindRing               _rewind_ring;
+    std::vector<RewindBanks> _rewind_banks;
+    Checkpoint               _rewind_state;
+    Checkpoint               _ahead_state;
+    SaveSlots                _save_slots;
+    Buffer                   _slot_state;
 };
 
 }
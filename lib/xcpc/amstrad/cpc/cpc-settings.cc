@@ -69,15 +69,28 @@ enum OptionEnum
     OPT_DRIVE1       = 24,
     OPT_SNAPSHOT     = 25,
     OPT_SPEEDUP      = 26,
-    OPT_XSHM         = 27,
-    OPT_NO_XSHM      = 28,
-    OPT_SCANLINES    = 29,
-    OPT_NO_SCANLINES = 30,
-    OPT_HELP         = 31,
-    OPT_VERSION      = 32,
-    OPT_QUIET        = 33,
-    OPT_TRACE        = 34,
-    OPT_DEBUG        = 35,
+    OPT_PSGLOG       = 27,
+    OPT_WAVLOG       = 28,
+    OPT_WAVFMT       = 29,
+    OPT_XSHM         = 30,
+    OPT_NO_XSHM      = 31,
+    OPT_SCANLINES    = 32,
+    OPT_NO_SCANLINES = 33,
+    OPT_FASTLOAD     = 34,
+    OPT_NO_FASTLOAD  = 35,
+    OPT_FDCTIMING    = 36,
+    OPT_REWIND       = 37,
+    OPT_REWINDLEN    = 38,
+    OPT_RUNAHEAD     = 39,
+    OPT_RECORD       = 40,
+    OPT_REPLAY       = 41,
+    OPT_AUDIO        = 42,
+    OPT_NO_AUDIO     = 43,
+    OPT_HELP         = 44,
+    OPT_VERSION      = 45,
+    OPT_QUIET        = 46,
+    OPT_TRACE        = 47,
+    OPT_DEBUG        = 48,
 };
 
 }
@@ -136,14 +149,27 @@ const OptionType options[] = {
     { "--rom013={filename}"  , "16Kb expansion rom #14"                                        },
     { "--rom014={filename}"  , "16Kb expansion rom #15"                                        },
     { "--rom015={filename}"  , "16Kb expansion rom #16"                                        },
-    { "--drive0={filename}"  , "drive0 disk image"                                             },
-    { "--drive1={filename}"  , "drive1 disk image"                                             },
+    { "--drive0={filename}"  , "drive0 disk image or host directory"                           },
+    { "--drive1={filename}"  , "drive1 disk image or host directory"                           },
     { "--snapshot={filename}", "initial snapshot"                                              },
     { "--speedup={factor}"   , "speeds up emulation by an integer factor"                      },
+    { "--psglog={filename}"  , "record the psg registers to a vgm file"                        },
+    { "--wavlog={filename}"  , "record the audio output to a wav file"                         },
+    { "--wavfmt={format}"    , "wav sample format (pcm16, float)"                              },
     { "--xshm"               , "use the XShm extension"                                        },
     { "--no-xshm"            , "don't use the XShm extension"                                  },
     { "--scanlines"          , "simulate crt scanlines"                                        },
     { "--no-scanlines"       , "don't simulate crt scanlines"                                  },
+    { "--fastload"           , "transfer the disk sectors at once"                             },
+    { "--no-fastload"        , "transfer the disk sectors byte per byte"                       },
+    { "--fdctiming={value}"  , "disk controller timing (instant, default, exact)"              },
+    { "--rewind={frames}"    , "keep a rewind state every n frames (0 disables)"               },
+    { "--rewindlen={count}"  , "number of rewind states kept"                                  },
+    { "--runahead={frames}"  , "number of frames emulated ahead of the display (0 disables)"   },
+    { "--record={filename}"  , "record the input events to a movie file"                       },
+    { "--replay={filename}"  , "replay the input events from a movie file"                     },
+    { "--audio"              , "play the audio output"                                         },
+    { "--no-audio"           , "discard the audio output (null audio device)"                  },
     { "--help"               , "display this help and exit"                                    },
     { "--version"            , "display the version and exit"                                  },
     { "--quiet"              , "set the loglevel to quiet mode"                                },
@@ -188,8 +214,19 @@ Settings::Settings()
     , opt_drive0(not_set)
     , opt_drive1(not_set)
     , opt_snapshot(not_set)
+    , opt_psglog(not_set)
+    , opt_wavlog(not_set)
+    , opt_wavfmt(not_set)
     , opt_xshm(true)
     , opt_scanlines(true)
+    , opt_fastload(false)
+    , opt_fdctiming(not_set)
+    , opt_rewind(not_set)
+    , opt_rewindlen(not_set)
+    , opt_runahead(not_set)
+    , opt_record(not_set)
+    , opt_replay(not_set)
+    , opt_audio(true)
     , opt_help(false)
     , opt_version(false)
     , opt_loglevel(Utils::get_loglevel())
@@ -275,8 +312,19 @@ void Settings::parse(int& argc, char**& argv)
         ::xcpc_log_debug("xcpc.settings.drive1    = %s", opt_drive1.c_str()  );
         ::xcpc_log_debug("xcpc.settings.snapshot  = %s", opt_snapshot.c_str());
         ::xcpc_log_debug("xcpc.settings.speedup   = %s", opt_speedup.c_str() );
+        ::xcpc_log_debug("xcpc.settings.psglog    = %s", opt_psglog.c_str()  );
+        ::xcpc_log_debug("xcpc.settings.wavlog    = %s", opt_wavlog.c_str()  );
+        ::xcpc_log_debug("xcpc.settings.wavfmt    = %s", opt_wavfmt.c_str()  );
         ::xcpc_log_debug("xcpc.settings.xshm      = %d", opt_xshm            );
         ::xcpc_log_debug("xcpc.settings.scanlines = %d", opt_scanlines       );
+        ::xcpc_log_debug("xcpc.settings.fastload  = %d", opt_fastload        );
+        ::xcpc_log_debug("xcpc.settings.fdctiming = %s", opt_fdctiming.c_str());
+        ::xcpc_log_debug("xcpc.settings.rewind    = %s", opt_rewind.c_str()  );
+        ::xcpc_log_debug("xcpc.settings.rewindlen = %s", opt_rewindlen.c_str());
+        ::xcpc_log_debug("xcpc.settings.runahead  = %s", opt_runahead.c_str());
+        ::xcpc_log_debug("xcpc.settings.record    = %s", opt_record.c_str()  );
+        ::xcpc_log_debug("xcpc.settings.replay    = %s", opt_replay.c_str()  );
+        ::xcpc_log_debug("xcpc.settings.audio     = %d", opt_audio           );
         ::xcpc_log_debug("xcpc.settings.help      = %d", opt_help            );
         ::xcpc_log_debug("xcpc.settings.version   = %d", opt_version         );
         ::xcpc_log_debug("xcpc.settings.loglevel  = %d", opt_loglevel        );
@@ -321,10 +369,23 @@ void Settings::parse(int& argc, char**& argv)
             else if(is_option(OPT_DRIVE1      , argument)) { opt_drive1    = value_of(argument);  }
             else if(is_option(OPT_SNAPSHOT    , argument)) { opt_snapshot  = value_of(argument);  }
             else if(is_option(OPT_SPEEDUP     , argument)) { opt_speedup   = value_of(argument);  }
+            else if(is_option(OPT_PSGLOG      , argument)) { opt_psglog    = value_of(argument);  }
+            else if(is_option(OPT_WAVLOG      , argument)) { opt_wavlog    = value_of(argument);  }
+            else if(is_option(OPT_WAVFMT      , argument)) { opt_wavfmt    = value_of(argument);  }
             else if(is_option(OPT_XSHM        , argument)) { opt_xshm      = true;                }
             else if(is_option(OPT_NO_XSHM     , argument)) { opt_xshm      = false;               }
             else if(is_option(OPT_SCANLINES   , argument)) { opt_scanlines = true;                }
             else if(is_option(OPT_NO_SCANLINES, argument)) { opt_scanlines = false;               }
+            else if(is_option(OPT_FASTLOAD    , argument)) { opt_fastload  = true;                }
+            else if(is_option(OPT_NO_FASTLOAD , argument)) { opt_fastload  = false;               }
+            else if(is_option(OPT_FDCTIMING   , argument)) { opt_fdctiming = value_of(argument);  }
+            else if(is_option(OPT_REWIND      , argument)) { opt_rewind    = value_of(argument);  }
+            else if(is_option(OPT_REWINDLEN   , argument)) { opt_rewindlen = value_of(argument);  }
+            else if(is_option(OPT_RUNAHEAD    , argument)) { opt_runahead  = value_of(argument);  }
+            else if(is_option(OPT_RECORD      , argument)) { opt_record    = value_of(argument);  }
+            else if(is_option(OPT_REPLAY      , argument)) { opt_replay    = value_of(argument);  }
+            else if(is_option(OPT_AUDIO       , argument)) { opt_audio     = true;                }
+            else if(is_option(OPT_NO_AUDIO    , argument)) { opt_audio     = false;               }
             else if(is_option(OPT_HELP        , argument)) { opt_help      = true;                }
             else if(is_option(OPT_VERSION     , argument)) { opt_version   = true;                }
             else if(is_option(OPT_QUIET       , argument)) { opt_loglevel  = XCPC_LOGLEVEL_QUIET; }
@@ -413,10 +474,23 @@ void Settings::usage()
     print_str(""                  );
     print_str("Misc. options:"    );
     print_opt(OPT_SPEEDUP         );
+    print_opt(OPT_PSGLOG          );
+    print_opt(OPT_WAVLOG          );
+    print_opt(OPT_WAVFMT          );
     print_opt(OPT_XSHM            );
     print_opt(OPT_NO_XSHM         );
     print_opt(OPT_SCANLINES       );
     print_opt(OPT_NO_SCANLINES    );
+    print_opt(OPT_FASTLOAD        );
+    print_opt(OPT_NO_FASTLOAD     );
+    print_opt(OPT_FDCTIMING       );
+    print_opt(OPT_REWIND          );
+    print_opt(OPT_REWINDLEN       );
+    print_opt(OPT_RUNAHEAD        );
+    print_opt(OPT_RECORD          );
+    print_opt(OPT_REPLAY          );
+    print_opt(OPT_AUDIO           );
+    print_opt(OPT_NO_AUDIO        );
     print_str(""                  );
     print_str("Debug options:"    );
     print_opt(OPT_QUIET           );
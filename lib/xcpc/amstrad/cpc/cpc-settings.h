@@ -43,6 +43,11 @@ using MutexLock        = xcpc::MutexLock;
 using AudioConfig      = xcpc::AudioConfig;
 using AudioDevice      = xcpc::AudioDevice;
 using AudioProcessor   = xcpc::AudioProcessor;
+using Buffer           = xcpc::Buffer;
+using RewindRing       = xcpc::RewindRing;
+using SaveSlots        = xcpc::SaveSlots;
+using SlotIdentity     = xcpc::SlotIdentity;
+using Hash64           = xcpc::Hash64;
 using MonoFrameInt16   = xcpc::MonoFrameInt16;
 using MonoFrameInt32   = xcpc::MonoFrameInt32;
 using MonoFrameFlt32   = xcpc::MonoFrameFlt32;
@@ -109,8 +114,19 @@ public: // public data
     std::string opt_drive1;
     std::string opt_snapshot;
     std::string opt_speedup;
+    std::string opt_psglog;
+    std::string opt_wavlog;
+    std::string opt_wavfmt;
     bool        opt_xshm;
     bool        opt_scanlines;
+    bool        opt_fastload;
+    std::string opt_fdctiming;
+    std::string opt_rewind;
+    std::string opt_rewindlen;
+    std::string opt_runahead;
+    std::string opt_record;
+    std::string opt_replay;
+    bool        opt_audio;
     bool        opt_help;
     bool        opt_version;
     int         opt_loglevel;
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <xcpc/libxcpc-priv.h>
+#include <xcpc/amstrad/vga/vga-core.h>
 #include "dpy-core.h"
 
 #define MONITOR_50HZ_TOTAL_WIDTH    1024
@@ -59,50 +60,6 @@ struct MonitorArea
     int y2;
 };
 
-struct ColorEntry
-{
-    const char* label;
-    uint16_t    red;
-    uint16_t    green;
-    uint16_t    blue;
-    uint16_t    luminance;
-};
-
-const ColorEntry color_table[] = {
-    { "white"                       , 0x8000, 0x8000, 0x8000, 0x8000 },
-    { "white (not official)"        , 0x8000, 0x8000, 0x8000, 0x8000 },
-    { "sea green"                   , 0x0000, 0xffff, 0x8000, 0xa4dd },
-    { "pastel yellow"               , 0xffff, 0xffff, 0x8000, 0xf168 },
-    { "blue"                        , 0x0000, 0x0000, 0x8000, 0x0e97 },
-    { "purple"                      , 0xffff, 0x0000, 0x8000, 0x5b22 },
-    { "cyan"                        , 0x0000, 0x8000, 0x8000, 0x59ba },
-    { "pink"                        , 0xffff, 0x8000, 0x8000, 0xa645 },
-    { "purple (not official)"       , 0xffff, 0x0000, 0x8000, 0x5b22 },
-    { "pastel yellow (not official)", 0xffff, 0xffff, 0x8000, 0xf168 },
-    { "bright yellow"               , 0xffff, 0xffff, 0x0000, 0xe2d0 },
-    { "bright white"                , 0xffff, 0xffff, 0xffff, 0xffff },
-    { "bright red"                  , 0xffff, 0x0000, 0x0000, 0x4c8b },
-    { "bright magenta"              , 0xffff, 0x0000, 0xffff, 0x69ba },
-    { "orange"                      , 0xffff, 0x8000, 0x0000, 0x97ad },
-    { "pastel magenta"              , 0xffff, 0x8000, 0xffff, 0xb4dc },
-    { "blue (not official)"         , 0x0000, 0x0000, 0x8000, 0x0e97 },
-    { "sea green (not official)"    , 0x0000, 0xffff, 0x8000, 0xa4dd },
-    { "bright green"                , 0x0000, 0xffff, 0x0000, 0x9645 },
-    { "bright cyan"                 , 0x0000, 0xffff, 0xffff, 0xb374 },
-    { "black"                       , 0x0000, 0x0000, 0x0000, 0x0000 },
-    { "bright blue"                 , 0x0000, 0x0000, 0xffff, 0x1d2f },
-    { "green"                       , 0x0000, 0x8000, 0x0000, 0x4b23 },
-    { "sky blue"                    , 0x0000, 0x8000, 0xffff, 0x6852 },
-    { "magenta"                     , 0x8000, 0x0000, 0x8000, 0x34dd },
-    { "pastel green"                , 0x8000, 0xffff, 0x8000, 0xcb22 },
-    { "lime"                        , 0x8000, 0xffff, 0x0000, 0xbc8b },
-    { "pastel cyan"                 , 0x8000, 0xffff, 0xffff, 0xd9ba },
-    { "red"                         , 0x8000, 0x0000, 0x0000, 0x2645 },
-    { "mauve"                       , 0x8000, 0x0000, 0xffff, 0x4374 },
-    { "yellow"                      , 0x8000, 0x8000, 0x0000, 0x7168 },
-    { "pastel blue"                 , 0x8000, 0x8000, 0xffff, 0x8e97 }
-};
-
 }
 
 // ---------------------------------------------------------------------------
@@ -532,7 +489,7 @@ struct StateTraits final
         constexpr int max_index = 31;
 
         if((index >= min_index) && (index <= max_index)) {
-            const auto& entry = color_table[index];
+            const auto& entry = vga::Instance::get_color(index);
             color.pixel = 0UL;
             color.flags = (DoRed | DoGreen | DoBlue);
             color.pad   = 0;
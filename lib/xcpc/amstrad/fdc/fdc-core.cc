@@ -31,6 +31,7 @@
 #include <libdsk/libdsk.h>
 #include <lib765/765.h>
 #include <xcpc/libxcpc-priv.h>
+#include <xcpc/formats/dsk/dsk-format.h>
 #include "fdc-core.h"
 
 // ---------------------------------------------------------------------------
@@ -43,6 +44,7 @@ struct BasicTraits
 {
     using Type      = fdc::Type;
     using Drive     = fdc::Drive;
+    using Timing    = fdc::Timing;
     using State     = fdc::State;
     using Instance  = fdc::Instance;
     using Interface = fdc::Interface;
@@ -52,6 +54,313 @@ struct BasicTraits
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::HostDisk
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct HostDisk
+{
+    fdc::State* state;
+    int         drive;
+    dsk::Disk*  disk;
+    uint8_t     st1;
+    uint8_t     st2;
+    std::string folder;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::HostTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct HostTraits final
+    : public BasicTraits
+{
+    using Disk        = dsk::Disk;
+    using TrackIndex  = dsk::TrackIndex;
+    using SectorIndex = dsk::SectorIndex;
+
+    static inline auto get_host(void* context) -> HostDisk&
+    {
+        return *reinterpret_cast<HostDisk*>(context);
+    }
+
+    static inline auto get_disk(void* context) -> Disk*
+    {
+        Disk* disk = get_host(context).disk;
+
+        if((disk != nullptr) && (disk->is_loaded() != false)) {
+            return disk;
+        }
+        return nullptr;
+    }
+
+    static inline auto is_diverted(void* context) -> bool
+    {
+        State& state(*get_host(context).state);
+
+        if(state.speculative != 0) {
+            state.diverted = 1;
+            return true;
+        }
+        return false;
+    }
+
+    static inline auto get_length(const uint8_t fdc_n) -> int
+    {
+        return 0x80 << (fdc_n & 7);
+    }
+
+    static inline auto get_copy(void* context, const SectorIndex& sector) -> unsigned
+    {
+        HostDisk& host(get_host(context));
+        uint32_t& weak(host.state->weak[host.drive & 3]);
+
+        /* xorshift32: the weak sector copy only depends on the machine state */
+        if(sector.copies > 1) {
+            weak ^= (weak << 13);
+            weak ^= (weak >> 17);
+            weak ^= (weak <<  5);
+            return weak % sector.copies;
+        }
+        return 0;
+    }
+
+    static auto seek_sector(Disk& disk, const int cylinder, const int xcylinder, const int xhead, const int head, const int sector, SectorIndex*& index, int& len) -> fd_err_t
+    {
+        TrackIndex* track = disk.get_track(cylinder, head);
+        if(track == nullptr) {
+            return FD_E_NOADDR;
+        }
+        index = disk.get_sector(*track, static_cast<uint8_t>(sector));
+        if(index == nullptr) {
+            return FD_E_NOADDR;
+        }
+        if((xcylinder != index->info[0]) || (xhead != index->info[1])) {
+            return FD_E_NOADDR;
+        }
+        const int length = get_length(index->info[3]);
+        if(length < len) {
+            len = length;
+            return FD_E_DATAERR;
+        }
+        if(length > len) {
+            return FD_E_DATAERR;
+        }
+        return FD_E_OK;
+    }
+
+    static auto cylinders(void* context) -> int
+    {
+        Disk* disk = get_disk(context);
+
+        if(disk != nullptr) {
+            return static_cast<int>(disk->get_number_of_tracks());
+        }
+        return -1;
+    }
+
+    static auto read_id(void* context, int cylinder, int head, int sector, fdc_byte* buf) -> fd_err_t
+    {
+        Disk*       disk  = get_disk(context);
+        TrackIndex* track = (disk != nullptr ? disk->get_track(cylinder, head) : nullptr);
+
+        if((track == nullptr) || (track->count == 0)) {
+            return FD_E_NOADDR;
+        }
+        const uint8_t* info = track->sector[static_cast<unsigned>(sector) % track->count].info;
+        buf[0] = info[0];
+        buf[1] = info[1];
+        buf[2] = info[2];
+        buf[3] = info[3];
+        return FD_E_OK;
+    }
+
+    static auto read_sector(void* context, int cylinder, int xcylinder, int xhead, int head, int sector, fdc_byte* buf, int len, int* deleted, int skip_deleted, int mfm, int multi) -> fd_err_t
+    {
+        HostDisk&    host(get_host(context));
+        Disk*        disk      = get_disk(context);
+        SectorIndex* index     = nullptr;
+        const int    rdeleted  = ((deleted != nullptr) && (*deleted != 0) ? 0x40 : 0x00);
+        bool         try_again = false;
+        fd_err_t     err       = FD_E_OK;
+
+        host.st1 = host.st2 = 0;
+        if(disk == nullptr) {
+            return FD_E_NOTRDY;
+        }
+        do {
+            err = seek_sector(*disk, cylinder, xcylinder, xhead, head, sector, index, len);
+            /* retrying because of a deleted data mismatch */
+            if((try_again != false) && (err == FD_E_NOADDR)) {
+                err = FD_E_NODATA;
+            }
+            try_again = false;
+            if((err != FD_E_DATAERR) && (err != FD_E_OK)) {
+                return err;
+            }
+            if(deleted != nullptr) {
+                *deleted = 0;
+            }
+            if(rdeleted != (index->info[5] & 0x40)) {
+                if(skip_deleted != 0) {
+                    try_again = true;
+                    ++sector;
+                    continue;
+                }
+                else if(deleted != nullptr) {
+                    *deleted = 1;
+                }
+            }
+            const dsk::Span data(disk->get_sector_data(*index, get_copy(context, *index)));
+            if(data.size < static_cast<size_t>(len)) {
+                static_cast<void>(::memcpy(buf, data.data, data.size));
+                err = FD_E_DATAERR;
+            }
+            else {
+                static_cast<void>(::memcpy(buf, data.data, len));
+            }
+            /* ST2 bit 5 means a data error in the data field */
+            if((index->info[5] & 0x20) != 0) {
+                err = FD_E_DATAERR;
+            }
+            host.st1 = index->info[4];
+            host.st2 = index->info[5];
+        } while(try_again != false);
+
+        return err;
+    }
+
+    static auto read_track(void* context, int cylinder, int xcylinder, int xhead, int head, fdc_byte* buf, int* len) -> fd_err_t
+    {
+        Disk*       disk  = get_disk(context);
+        TrackIndex* track = (disk != nullptr ? disk->get_track(cylinder, head) : nullptr);
+        int         total = 0;
+        fd_err_t    err   = FD_E_OK;
+
+        if((track == nullptr) || (track->count == 0)) {
+            return FD_E_NOADDR;
+        }
+        if((xcylinder != track->sector[0].info[0]) || (xhead != track->sector[0].info[1])) {
+            return FD_E_NOADDR;
+        }
+        for(unsigned index = 0; (index < track->count) && (err == FD_E_OK); ++index) {
+            const SectorIndex& sector(track->sector[index]);
+            int length = get_length(sector.info[3]);
+            if(static_cast<size_t>(length) > sector.data.size) {
+                length = static_cast<int>(sector.data.size);
+            }
+            if((total + length) > *len) {
+                length = *len - total;
+                err = FD_E_DATAERR;
+            }
+            static_cast<void>(::memcpy(buf + total, sector.data.data, length));
+            total += length;
+        }
+        *len = total;
+        return err;
+    }
+
+    static auto write_sector(void* context, int cylinder, int xcylinder, int xhead, int head, int sector, fdc_byte* buf, int len, int deleted, int skip_deleted, int mfm, int multi) -> fd_err_t
+    {
+        Disk*        disk  = get_disk(context);
+        SectorIndex* index = nullptr;
+
+        if(disk == nullptr) {
+            return FD_E_NOTRDY;
+        }
+        const fd_err_t err = seek_sector(*disk, cylinder, xcylinder, xhead, head, sector, index, len);
+        if((err != FD_E_DATAERR) && (err != FD_E_OK)) {
+            return err;
+        }
+        /* a speculative write can't be rolled back: the disk is left untouched */
+        if(is_diverted(context) != false) {
+            return FD_E_OK;
+        }
+        if(deleted != 0) {
+            index->info[5] |= 0x40;
+        }
+        else {
+            index->info[5] &= ~0x40;
+        }
+        /* the sector is bigger than expected: ignore the data error */
+        disk->set_sector_data(*disk->get_track(cylinder, head), *index, buf, len);
+        return FD_E_OK;
+    }
+
+    static auto format_track(void* context, int cylinder, int head, int sectors, fdc_byte* track, fdc_byte filler) -> fd_err_t
+    {
+        Disk* disk = get_disk(context);
+
+        if((disk == nullptr) || (cylinder < 0) || (head < 0) || (sectors < 0)) {
+            return FD_E_READONLY;
+        }
+        /* a speculative format can't be rolled back: the disk is left untouched */
+        if(is_diverted(context) != false) {
+            return FD_E_OK;
+        }
+        if(disk->format_track(cylinder, head, track, sectors, filler) == false) {
+            return FD_E_READONLY;
+        }
+        return FD_E_OK;
+    }
+
+    static auto sector_status(void* context, fdc_byte* st1, fdc_byte* st2) -> void
+    {
+        HostDisk& host(get_host(context));
+
+        *st1 = host.st1;
+        *st2 = host.st2;
+    }
+
+    static auto dirty(void* context) -> int
+    {
+        Disk* disk = get_disk(context);
+
+        return (disk != nullptr) && (disk->is_dirty() != false);
+    }
+
+    static auto eject(void* context) -> void
+    {
+        HostDisk& host(get_host(context));
+
+        if(host.disk != nullptr) {
+            try {
+                host.disk->close();
+            }
+            catch(const std::exception& e) {
+                ::xcpc_log_error("error while ejecting disk: %s", e.what());
+            }
+            host.disk = (delete host.disk, nullptr);
+        }
+        host.st1 = host.st2 = 0;
+        host.folder.clear();
+    }
+
+    static auto get_ops() -> const FDH_OPS*
+    {
+        static const FDH_OPS ops = {
+            &cylinders,
+            &read_id,
+            &read_sector,
+            &read_track,
+            &write_sector,
+            &format_track,
+            &sector_status,
+            &dirty,
+            &eject,
+        };
+        return &ops;
+    }
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // <anonymous>::FdcTraits
 // ---------------------------------------------------------------------------
@@ -101,6 +410,47 @@ struct FdcTraits final
         }
     }
 
+    static inline auto advance(FdcImpl* fdc, uint32_t ticks) -> uint32_t
+    {
+        if(fdc != nullptr) {
+            ::fdc_advance(fdc, ticks);
+            ticks = ::fdc_next_event(fdc);
+        }
+        else {
+            ticks = 0;
+        }
+        return ticks;
+    }
+
+    static inline auto set_timing(FdcImpl* fdc, uint8_t timing, uint32_t rate) -> void
+    {
+        if(fdc != nullptr) {
+            ::fdc_set_timing(fdc, timing, rate);
+        }
+    }
+
+    static inline auto get_state_size(FdcImpl* fdc) -> size_t
+    {
+        return ::fdc_state_size();
+    }
+
+    static inline auto save_state(FdcImpl* fdc, uint8_t* data) -> void
+    {
+        if(fdc != nullptr) {
+            ::fdc_save_state(fdc, data);
+        }
+        else {
+            static_cast<void>(::memset(data, 0, ::fdc_state_size()));
+        }
+    }
+
+    static inline auto load_state(FdcImpl* fdc, const uint8_t* data) -> void
+    {
+        if(fdc != nullptr) {
+            ::fdc_load_state(fdc, data);
+        }
+    }
+
     static inline auto set_motor(FdcImpl* fdc, uint8_t motor) -> uint8_t
     {
         if(fdc != nullptr) {
@@ -170,18 +520,52 @@ struct FddTraits final
         return fdd;
     }
 
+    static inline auto create_host(State& state, const int drive) -> FddImpl*
+    {
+        HostDisk* host = new HostDisk { &state, drive, nullptr, 0, 0, std::string() };
+        FddImpl*  fdd  = ::fd_newhost(HostTraits::get_ops(), host);
+
+        if(fdd == nullptr) {
+            host = (delete host, nullptr);
+            throw std::runtime_error("fd_newhost() has failed");
+        }
+        return fdd;
+    }
+
     static inline auto destroy(FddImpl* fdd) -> FddImpl*
     {
         if(fdd != nullptr) {
+            HostDisk* host = reinterpret_cast<HostDisk*>(::fdh_gethost(fdd));
             fdd = (::fd_destroy(&fdd), nullptr);
+            if(host != nullptr) {
+                host = (delete host, nullptr);
+            }
         }
         return fdd;
     }
 
     static inline auto reset(FddImpl* fdd) -> void
     {
+        auto reset_host = [&](HostDisk& host) -> void
+        {
+            if(host.disk != nullptr) {
+                try {
+                    host.disk->flush();
+                }
+                catch(const std::exception& e) {
+                    ::xcpc_log_error("error while flushing disk: %s", e.what());
+                }
+            }
+        };
+
         if(fdd != nullptr) {
-            ::fd_eject(fdd);
+            HostDisk* host = get_host(fdd);
+            if(host != nullptr) {
+                reset_host(*host);
+            }
+            else {
+                ::fd_eject(fdd);
+            }
             ::fd_reset(fdd);
         }
     }
@@ -190,10 +574,41 @@ struct FddTraits final
     {
     }
 
-    static inline auto create_disk(FddImpl* fdd, const std::string& filename) -> void
+    static inline auto get_host(FddImpl* fdd) -> HostDisk*
+    {
+        return reinterpret_cast<HostDisk*>(::fdh_gethost(fdd));
+    }
+
+    static inline auto is_folder(const std::string& filename) -> bool
+    {
+        struct stat statbuf;
+
+        if(::stat(filename.c_str(), &statbuf) == 0) {
+            return S_ISDIR(statbuf.st_mode);
+        }
+        return false;
+    }
+
+    static inline auto select(State& state, FddImpl*& fdd, const int drive, const bool host) -> void
+    {
+        if((fdd == nullptr) || ((get_host(fdd) != nullptr) == host)) {
+            return;
+        }
+        FddImpl* old_fdd = fdd;
+        FddImpl* new_fdd = (host != false ? create_host(state, drive) : create());
+        if(::fdc_getdrive(state.fdc, drive) == old_fdd) {
+            FdcTraits::set_drive(state.fdc, new_fdd, drive);
+            FdcTraits::set_motor(state.fdc, state.motor);
+        }
+        fdd = new_fdd;
+        old_fdd = destroy(old_fdd);
+    }
+
+    static inline auto create_disk(State& state, FddImpl*& fdd, const int drive, const std::string& filename) -> void
     {
         if(fdd != nullptr) {
             if(filename.size() != 0) {
+                select(state, fdd, drive, false);
                 ::fdl_create_dsk(fdd, filename.c_str());
             }
             else {
@@ -202,11 +617,42 @@ struct FddTraits final
         }
     }
 
-    static inline auto insert_disk(FddImpl* fdd, const std::string& filename) -> void
+    static inline auto insert_disk(State& state, FddImpl*& fdd, const int drive, const std::string& filename) -> void
     {
+        auto insert_folder = [&]() -> void
+        {
+            HostDisk* host = get_host(fdd);
+            ::fd_eject(fdd);
+            host->folder = filename;
+        };
+
+        auto insert_host = [&]() -> void
+        {
+            HostDisk* host = get_host(fdd);
+            ::fd_eject(fdd);
+            host->disk = new dsk::Disk(filename);
+            try {
+                host->disk->load(false);
+            }
+            catch(const std::exception& e) {
+                ::xcpc_log_error("error while loading disk: %s", e.what());
+            }
+            ::fd_setreadonly(fdd, host->disk->is_readonly() ? 1 : 0);
+        };
+
         if(fdd != nullptr) {
             if(filename.size() != 0) {
-                ::fdl_setfilename(fdd, filename.c_str());
+                const bool folder = is_folder(filename);
+                select(state, fdd, drive, folder || dsk::Disk::probe(filename));
+                if(folder != false) {
+                    insert_folder();
+                }
+                else if(get_host(fdd) != nullptr) {
+                    insert_host();
+                }
+                else {
+                    ::fdl_setfilename(fdd, filename.c_str());
+                }
             }
             else {
                 ::fd_eject(fdd);
@@ -221,15 +667,58 @@ struct FddTraits final
         }
     }
 
+    static inline auto flush_disk(FddImpl* fdd) -> void
+    {
+        if(fdd != nullptr) {
+            HostDisk* host = get_host(fdd);
+            if((host != nullptr) && (host->disk != nullptr)) {
+                host->disk->flush();
+            }
+        }
+    }
+
     static inline auto get_filename(FddImpl* fdd) -> std::string
     {
         std::string filename;
 
         if(fdd != nullptr) {
-            filename = ::fdl_getfilename(fdd);
+            HostDisk* host = get_host(fdd);
+            if(host != nullptr) {
+                if(host->disk != nullptr) {
+                    filename = host->disk->get_filename();
+                }
+                else {
+                    filename = host->folder;
+                }
+            }
+            else {
+                filename = ::fdl_getfilename(fdd);
+            }
         }
         return filename;
     }
+
+    static inline auto get_folder(FddImpl* fdd) -> std::string
+    {
+        if(fdd != nullptr) {
+            HostDisk* host = get_host(fdd);
+            if(host != nullptr) {
+                return host->folder;
+            }
+        }
+        return std::string();
+    }
+
+    static inline auto can_speculate(FddImpl* fdd) -> bool
+    {
+        if((fdd != nullptr) && (get_host(fdd) == nullptr)) {
+            const char* filename = ::fdl_getfilename(fdd);
+            if((filename != nullptr) && (*filename != '\0')) {
+                return false; /* libdsk writes straight to the image */
+            }
+        }
+        return true;
+    }
 };
 
 }
@@ -243,29 +732,48 @@ namespace {
 struct StateTraits final
     : public BasicTraits
 {
+    static constexpr uint32_t WEAK_SEED = 0x2545f491;
+
     static inline auto construct(State& state, const Type type) -> void
     {
-        state.type = type;
-        state.fdc  = FdcTraits::create();
-        state.fd0  = FddTraits::create();
-        state.fd1  = FddTraits::create();
-        state.fd2  = FddTraits::create();
-        state.fd3  = FddTraits::create();
+        state.type        = type;
+        state.motor       = 0;
+        state.timing      = Timing::TIMING_INSTANT;
+        state.speculative = 0;
+        state.diverted    = 0;
+        state.rate        = 0;
+        state.weak[0]     = WEAK_SEED;
+        state.weak[1]     = WEAK_SEED;
+        state.weak[2]     = WEAK_SEED;
+        state.weak[3]     = WEAK_SEED;
+        state.fdc         = FdcTraits::create();
+        state.fd0         = FddTraits::create();
+        state.fd1         = FddTraits::create();
+        state.fd2         = FddTraits::create();
+        state.fd3         = FddTraits::create();
     }
 
     static inline auto destruct(State& state) -> void
     {
-        state.fd3  = FddTraits::destroy(state.fd3);
-        state.fd2  = FddTraits::destroy(state.fd2);
-        state.fd1  = FddTraits::destroy(state.fd1);
-        state.fd0  = FddTraits::destroy(state.fd0);
-        state.fdc  = FdcTraits::destroy(state.fdc);
-        state.type = Type::TYPE_INVALID;
+        state.fd3    = FddTraits::destroy(state.fd3);
+        state.fd2    = FddTraits::destroy(state.fd2);
+        state.fd1    = FddTraits::destroy(state.fd1);
+        state.fd0    = FddTraits::destroy(state.fd0);
+        state.fdc    = FdcTraits::destroy(state.fdc);
+        state.rate   = 0;
+        state.timing = Timing::TIMING_INSTANT;
+        state.motor  = 0;
+        state.type   = Type::TYPE_INVALID;
     }
 
     static inline auto reset(State& state) -> void
     {
+        state.weak[0] = WEAK_SEED;
+        state.weak[1] = WEAK_SEED;
+        state.weak[2] = WEAK_SEED;
+        state.weak[3] = WEAK_SEED;
         FdcTraits::reset(state.fdc);
+        FdcTraits::set_timing(state.fdc, state.timing, state.rate);
         FddTraits::reset(state.fd0);
         FddTraits::reset(state.fd1);
         FddTraits::reset(state.fd2);
@@ -314,6 +822,42 @@ auto Instance::clock() -> void
     StateTraits::clock(_state);
 }
 
+auto Instance::advance(const uint32_t ticks) -> uint32_t
+{
+    return FdcTraits::advance(_state.fdc, ticks);
+}
+
+auto Instance::set_timing(const Timing timing, const uint32_t rate) -> void
+{
+    _state.timing = timing;
+    _state.rate   = rate;
+
+    FdcTraits::set_timing(_state.fdc, _state.timing, _state.rate);
+}
+
+auto Instance::get_state_size() const -> size_t
+{
+    return sizeof(_state.motor) + sizeof(_state.weak) + FdcTraits::get_state_size(_state.fdc);
+}
+
+auto Instance::save_state(uint8_t* data) const -> void
+{
+    *data++ = _state.motor;
+    static_cast<void>(::memcpy(data, _state.weak, sizeof(_state.weak)));
+    data += sizeof(_state.weak);
+
+    FdcTraits::save_state(_state.fdc, data);
+}
+
+auto Instance::load_state(const uint8_t* data) -> void
+{
+    _state.motor = *data++;
+    static_cast<void>(::memcpy(_state.weak, data, sizeof(_state.weak)));
+    data += sizeof(_state.weak);
+
+    FdcTraits::load_state(_state.fdc, data);
+}
+
 auto Instance::attach_drive(const int drive) -> void
 {
     switch(drive) {
@@ -358,16 +902,16 @@ auto Instance::create_disk(const int drive, const std::string& filename) -> void
 {
     switch(drive) {
         case Drive::FDC_DRIVE0:
-            FddTraits::create_disk(_state.fd0, filename);
+            FddTraits::create_disk(_state, _state.fd0, drive, filename);
             break;
         case Drive::FDC_DRIVE1:
-            FddTraits::create_disk(_state.fd1, filename);
+            FddTraits::create_disk(_state, _state.fd1, drive, filename);
             break;
         case Drive::FDC_DRIVE2:
-            FddTraits::create_disk(_state.fd2, filename);
+            FddTraits::create_disk(_state, _state.fd2, drive, filename);
             break;
         case Drive::FDC_DRIVE3:
-            FddTraits::create_disk(_state.fd3, filename);
+            FddTraits::create_disk(_state, _state.fd3, drive, filename);
             break;
         default:
             break;
@@ -378,16 +922,16 @@ auto Instance::insert_disk(const int drive, const std::string& filename) -> void
 {
     switch(drive) {
         case Drive::FDC_DRIVE0:
-            FddTraits::insert_disk(_state.fd0, filename);
+            FddTraits::insert_disk(_state, _state.fd0, drive, filename);
             break;
         case Drive::FDC_DRIVE1:
-            FddTraits::insert_disk(_state.fd1, filename);
+            FddTraits::insert_disk(_state, _state.fd1, drive, filename);
             break;
         case Drive::FDC_DRIVE2:
-            FddTraits::insert_disk(_state.fd2, filename);
+            FddTraits::insert_disk(_state, _state.fd2, drive, filename);
             break;
         case Drive::FDC_DRIVE3:
-            FddTraits::insert_disk(_state.fd3, filename);
+            FddTraits::insert_disk(_state, _state.fd3, drive, filename);
             break;
         default:
             break;
@@ -414,6 +958,26 @@ auto Instance::remove_disk(const int drive) -> void
     }
 }
 
+auto Instance::flush_disk(const int drive) -> void
+{
+    switch(drive) {
+        case Drive::FDC_DRIVE0:
+            FddTraits::flush_disk(_state.fd0);
+            break;
+        case Drive::FDC_DRIVE1:
+            FddTraits::flush_disk(_state.fd1);
+            break;
+        case Drive::FDC_DRIVE2:
+            FddTraits::flush_disk(_state.fd2);
+            break;
+        case Drive::FDC_DRIVE3:
+            FddTraits::flush_disk(_state.fd3);
+            break;
+        default:
+            break;
+    }
+}
+
 auto Instance::get_filename(const int drive) -> std::string
 {
     std::string filename;
@@ -437,8 +1001,79 @@ auto Instance::get_filename(const int drive) -> std::string
     return filename;
 }
 
+auto Instance::get_folder(const int drive) -> std::string
+{
+    std::string folder;
+
+    switch(drive) {
+        case Drive::FDC_DRIVE0:
+            folder = FddTraits::get_folder(_state.fd0);
+            break;
+        case Drive::FDC_DRIVE1:
+            folder = FddTraits::get_folder(_state.fd1);
+            break;
+        case Drive::FDC_DRIVE2:
+            folder = FddTraits::get_folder(_state.fd2);
+            break;
+        case Drive::FDC_DRIVE3:
+            folder = FddTraits::get_folder(_state.fd3);
+            break;
+        default:
+            break;
+    }
+    return folder;
+}
+
+auto Instance::begin_speculation() -> bool
+{
+    if((FddTraits::can_speculate(_state.fd0) == false)
+    || (FddTraits::can_speculate(_state.fd1) == false)
+    || (FddTraits::can_speculate(_state.fd2) == false)
+    || (FddTraits::can_speculate(_state.fd3) == false)) {
+        return false;
+    }
+    _state.speculative = 1;
+    _state.diverted    = 0;
+
+    return true;
+}
+
+auto Instance::end_speculation() -> bool
+{
+    const bool diverted = (_state.diverted != 0);
+
+    _state.speculative = 0;
+    _state.diverted    = 0;
+
+    return diverted;
+}
+
+auto Instance::is_diverted() const -> bool
+{
+    return _state.diverted != 0;
+}
+
 auto Instance::set_motor(uint8_t data) -> uint8_t
 {
+    auto write_back = [&](FddImpl* fdd) -> void
+    {
+        try {
+            FddTraits::flush_disk(fdd);
+        }
+        catch(const std::exception& e) {
+            ::xcpc_log_error("error while flushing disk: %s", e.what());
+        }
+    };
+
+    /* the disks are written back in the background once the motor stops */
+    if((_state.motor != 0) && (data == 0) && (_state.speculative == 0)) {
+        write_back(_state.fd0);
+        write_back(_state.fd1);
+        write_back(_state.fd2);
+        write_back(_state.fd3);
+    }
+    _state.motor = data;
+
     return FdcTraits::set_motor(_state.fdc, data);
 }
 
@@ -69,6 +69,21 @@ enum Drive
 
 }
 
+// ---------------------------------------------------------------------------
+// fdc::Timing
+// ---------------------------------------------------------------------------
+
+namespace fdc {
+
+enum Timing
+{
+    TIMING_INSTANT = 0,
+    TIMING_DEFAULT = 1,
+    TIMING_EXACT   = 2,
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // fdc::State
 // ---------------------------------------------------------------------------
@@ -78,6 +93,12 @@ namespace fdc {
 struct State
 {
     uint8_t  type;
+    uint8_t  motor;
+    uint8_t  timing;
+    uint8_t  speculative;
+    uint8_t  diverted;
+    uint32_t rate;
+    uint32_t weak[4];
     FdcImpl* fdc;
     FddImpl* fd0;
     FddImpl* fd1;
@@ -108,6 +129,16 @@ public: // public interface
 
     auto clock() -> void;
 
+    auto advance(const uint32_t ticks) -> uint32_t;
+
+    auto set_timing(const Timing timing, const uint32_t rate) -> void;
+
+    auto get_state_size() const -> size_t;
+
+    auto save_state(uint8_t* data) const -> void;
+
+    auto load_state(const uint8_t* data) -> void;
+
     auto attach_drive(const int drive) -> void;
 
     auto detach_drive(const int drive) -> void;
@@ -118,8 +149,18 @@ public: // public interface
 
     auto remove_disk(const int drive) -> void;
 
+    auto flush_disk(const int drive) -> void;
+
     auto get_filename(const int drive) -> std::string;
 
+    auto get_folder(const int drive) -> std::string;
+
+    auto begin_speculation() -> bool;
+
+    auto end_speculation() -> bool;
+
+    auto is_diverted() const -> bool;
+
     auto set_motor(uint8_t data) -> uint8_t;
 
     auto rd_stat(uint8_t data) -> uint8_t;
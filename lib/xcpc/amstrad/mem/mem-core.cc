@@ -41,6 +41,8 @@ struct BasicTraits
 {
     using Type      = mem::Type;
     using State     = mem::State;
+    using Page      = mem::Page;
+    using Pages     = mem::Pages;
     using Instance  = mem::Instance;
     using Interface = mem::Interface;
 };
@@ -103,6 +105,55 @@ struct StateTraits final
     static inline auto clock(State& state) -> void
     {
     }
+
+    static inline auto touch(State& state) -> void
+    {
+        for(auto& dirty : state.dirty) {
+            dirty = 1;
+        }
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::PageTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct PageTraits final
+    : public BasicTraits
+{
+    static inline auto share(State& state, Pages& shared) -> void
+    {
+        for(int index = 0; index < mem::PAGE_COUNT; ++index) {
+            auto& page(shared.page[index]);
+            if((state.dirty[index] != 0) || (page == nullptr)) {
+                auto copy = std::make_shared<Page>();
+                static_cast<void>(::memcpy(copy->data, &state.data[index << mem::PAGE_SHIFT], mem::PAGE_SIZE));
+                page = std::move(copy);
+            }
+            state.dirty[index] = 0;
+        }
+    }
+
+    static inline auto restore(State& state, Pages& shared, const Pages& pages) -> void
+    {
+        for(int index = 0; index < mem::PAGE_COUNT; ++index) {
+            const auto& page(pages.page[index]);
+            if(page == nullptr) {
+                throw std::runtime_error("restore() has failed");
+            }
+            if((state.dirty[index] != 0) || (page != shared.page[index])) {
+                static_cast<void>(::memcpy(&state.data[index << mem::PAGE_SHIFT], page->data, mem::PAGE_SIZE));
+            }
+        }
+        for(int index = 0; index < mem::PAGE_COUNT; ++index) {
+            state.dirty[index] = 0;
+            shared.page[index] = pages.page[index];
+        }
+    }
 };
 
 }
@@ -116,6 +167,7 @@ namespace mem {
 Instance::Instance(const Type type, Interface& interface)
     : _interface(interface)
     , _state()
+    , _shared()
 {
     StateTraits::construct(_state, type);
 
@@ -130,6 +182,7 @@ Instance::~Instance()
 auto Instance::reset() -> void
 {
     StateTraits::reset(_state);
+    StateTraits::touch(_state);
 }
 
 auto Instance::clock() -> void
@@ -163,6 +216,7 @@ auto Instance::load(const std::string& filename, size_t offset) -> void
         if(::fread(data, 1, size, file) != size) {
             throw std::runtime_error("fread() has failed");
         }
+        StateTraits::touch(_state);
     };
 
     auto file_close = [&]() -> void
@@ -198,12 +252,30 @@ auto Instance::store(uint8_t* data, const size_t size) -> void
 {
     if((data != nullptr) && (size == sizeof(_state.data))) {
         static_cast<void>(::memcpy(_state.data, data, size));
+        StateTraits::touch(_state);
     }
     else {
         throw std::runtime_error("store() has failed");
     }
 }
 
+auto Instance::share(Pages& pages) -> void
+{
+    PageTraits::share(_state, _shared);
+
+    pages = _shared;
+}
+
+auto Instance::restore(const Pages& pages) -> void
+{
+    PageTraits::restore(_state, _shared, pages);
+}
+
+auto Instance::touch() -> void
+{
+    StateTraits::touch(_state);
+}
+
 }
 
 // ---------------------------------------------------------------------------
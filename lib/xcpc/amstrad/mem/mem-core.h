@@ -24,6 +24,8 @@
 namespace mem {
 
 class State;
+class Page;
+class Pages;
 class Instance;
 class Interface;
 
@@ -44,6 +46,21 @@ enum Type
 
 }
 
+// ---------------------------------------------------------------------------
+// mem::Geometry
+// ---------------------------------------------------------------------------
+
+namespace mem {
+
+enum Geometry
+{
+    PAGE_SHIFT = 10,
+    PAGE_SIZE  = (1 << PAGE_SHIFT),
+    PAGE_COUNT = (16384 >> PAGE_SHIFT),
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // mem::State
 // ---------------------------------------------------------------------------
@@ -54,6 +71,33 @@ struct State
 {
     uint8_t type;
     uint8_t data[16384];
+    uint8_t dirty[PAGE_COUNT]; /* pages written since they were shared */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mem::Page
+// ---------------------------------------------------------------------------
+
+namespace mem {
+
+struct Page
+{
+    uint8_t data[PAGE_SIZE];
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mem::Pages
+// ---------------------------------------------------------------------------
+
+namespace mem {
+
+struct Pages
+{
+    std::shared_ptr<const Page> page[PAGE_COUNT];
 };
 
 }
@@ -85,6 +129,12 @@ public: // public interface
 
     auto store(uint8_t* data, const size_t size) -> void;
 
+    auto share(Pages& pages) -> void;
+
+    auto restore(const Pages& pages) -> void;
+
+    auto touch() -> void;
+
     auto operator->() -> State*
     {
         return &_state;
@@ -93,6 +143,7 @@ public: // public interface
 protected: // protected data
     Interface& _interface;
     State      _state;
+    Pages      _shared;
 };
 
 }
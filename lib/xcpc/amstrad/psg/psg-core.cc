@@ -47,6 +47,7 @@ struct BasicTraits
     using Output    = psg::Output;
     using Instance  = psg::Instance;
     using Interface = psg::Interface;
+    using Sink      = psg::Sink;
 
     static constexpr uint8_t ADDRESS_REGISTER      = -1;
     static constexpr uint8_t CHANNEL_A_FINE_TUNE   =  0;
@@ -76,31 +77,27 @@ struct BasicTraits
     static constexpr uint8_t PORT0                 = 0;
     static constexpr uint8_t PORT1                 = 1;
 
-    static const float   ay_dac[32];
-    static const float   ym_dac[32];
+    static const int16_t ay_dac[16];
+    static const int16_t ym_dac[32];
     static const uint8_t cycles[16][2];
 };
 
-const float BasicTraits::ay_dac[32] = {
-    0.0000000f, 0.0000000f, 0.0099947f, 0.0099947f,
-    0.0144503f, 0.0144503f, 0.0210575f, 0.0210575f,
-    0.0307012f, 0.0307012f, 0.0455482f, 0.0455482f,
-    0.0644999f, 0.0644999f, 0.1073625f, 0.1073625f,
-    0.1265888f, 0.1265888f, 0.2049897f, 0.2049897f,
-    0.2922103f, 0.2922103f, 0.3728389f, 0.3728389f,
-    0.4925307f, 0.4925307f, 0.6353246f, 0.6353246f,
-    0.8055848f, 0.8055848f, 1.0000000f, 1.0000000f
+const int16_t BasicTraits::ay_dac[16] = {
+        0,   327,   473,   690,
+     1006,  1492,  2113,  3518,
+     4148,  6717,  9575, 12217,
+    16139, 20818, 26397, 32767
 };
 
-const float BasicTraits::ym_dac[32] = {
-    0.0000000f, 0.0000000f, 0.0046540f, 0.0077211f,
-    0.0109560f, 0.0139620f, 0.0169986f, 0.0200198f,
-    0.0243687f, 0.0296941f, 0.0350652f, 0.0403906f,
-    0.0485389f, 0.0583352f, 0.0680552f, 0.0777752f,
-    0.0925154f, 0.1110857f, 0.1297475f, 0.1484855f,
-    0.1766690f, 0.2115511f, 0.2463874f, 0.2811017f,
-    0.3337301f, 0.4004273f, 0.4673838f, 0.5344320f,
-    0.6351720f, 0.7580072f, 0.8799268f, 1.0000000f
+const int16_t BasicTraits::ym_dac[32] = {
+        0,     0,   152,   253,
+      359,   457,   557,   656,
+      798,   973,  1149,  1323,
+     1590,  1911,  2230,  2548,
+     3031,  3640,  4251,  4865,
+     5789,  6932,  8073,  9211,
+    10935, 13121, 15315, 17512,
+    20813, 24838, 28833, 32767
 };
 
 const uint8_t BasicTraits::cycles[16][2] = {
@@ -124,6 +121,40 @@ const uint8_t BasicTraits::cycles[16][2] = {
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::ChipTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+template <psg::Type type>
+struct ChipTraits final
+    : public BasicTraits
+{
+    /* the AY-3-891x dac has 16 steps, each envelope level is held twice */
+    static inline auto level(const int amplitude) -> int16_t
+    {
+        return ay_dac[amplitude >> 1];
+    }
+
+    static inline auto construct(State& state) -> void
+    {
+        for(int amplitude = 0; amplitude < 32; ++amplitude) {
+            state.dac[amplitude][0] = -level(amplitude);
+            state.dac[amplitude][1] = +level(amplitude);
+        }
+    }
+};
+
+template <>
+inline auto ChipTraits<psg::Type::TYPE_YM2149>::level(const int amplitude) -> int16_t
+{
+    /* the YM2149 dac has 32 steps, one per envelope level */
+    return ym_dac[amplitude];
+}
+
+}
+
 // ---------------------------------------------------------------------------
 // <anonymous>::StateTraits
 // ---------------------------------------------------------------------------
@@ -137,15 +168,19 @@ struct StateTraits final
     {
         switch(state.type = type) {
             case Type::TYPE_AY8910:
+                ChipTraits<Type::TYPE_AY8910>::construct(state);
+                break;
             case Type::TYPE_AY8912:
+                ChipTraits<Type::TYPE_AY8912>::construct(state);
+                break;
             case Type::TYPE_AY8913:
-                static_cast<void>(::memcpy(state.dac, ay_dac, sizeof(state.dac)));
+                ChipTraits<Type::TYPE_AY8913>::construct(state);
                 break;
             case Type::TYPE_YM2149:
-                static_cast<void>(::memcpy(state.dac, ym_dac, sizeof(state.dac)));
+                ChipTraits<Type::TYPE_YM2149>::construct(state);
                 break;
             default:
-                static_cast<void>(::memcpy(state.dac, ay_dac, sizeof(state.dac)));
+                ChipTraits<Type::TYPE_AY8910>::construct(state);
                 break;
         }
     }
@@ -157,8 +192,9 @@ struct StateTraits final
 
     static inline auto reset(State& state) -> void
     {
-        state.ticks &= 0;
-        state.index &= 0;
+        state.ticks   &= 0;
+        state.pending &= 0;
+        state.index   &= 0;
         for(auto& value : state.array) {
             value &= 0;
         }
@@ -255,6 +291,38 @@ struct SoundTraits final
         }
     }
 
+    static inline auto fixup(Sound& lhs, Sound& rhs) -> void
+    {
+        if((lhs.period == rhs.period) && (lhs.counter != rhs.counter)) {
+            rhs.counter = lhs.counter;
+            rhs.phase   = lhs.phase;
+        }
+    }
+
+    static inline auto next(const Sound& sound) -> uint32_t
+    {
+        if(sound.counter < sound.period) {
+            return sound.period - sound.counter;
+        }
+        return 1;
+    }
+
+    static inline auto skip(Sound& sound, uint32_t steps) -> void
+    {
+        if(sound.period == 0) {
+            return;
+        }
+        const uint32_t first = next(sound);
+        if(steps < first) {
+            sound.counter += steps;
+        }
+        else {
+            steps -= first;
+            sound.counter = (steps % sound.period);
+            sound.phase  ^= ((1 + (steps / sound.period)) & 1);
+        }
+    }
+
     static inline auto get_fine_tune(Sound& sound, const uint8_t value) -> uint8_t
     {
         return value;
@@ -327,13 +395,44 @@ struct NoiseTraits final
         }
         if(++noise.counter >= noise.period) {
             noise.counter &= 0;
-            const uint32_t lfsr = noise.shift;
-            const uint32_t bit0 = (lfsr << 16);
-            const uint32_t bit3 = (lfsr << 13);
-            const uint32_t msw  = (~(bit0 ^ bit3) & 0x10000);
-            const uint32_t lsw  = ((lfsr >> 1) & 0x0ffff);
-            noise.shift = (msw | lsw);
-            noise.phase = (lfsr & 1);
+            shift(noise);
+        }
+    }
+
+    static inline auto shift(Noise& noise) -> void
+    {
+        const uint32_t lfsr = noise.shift;
+        const uint32_t bit0 = (lfsr << 16);
+        const uint32_t bit3 = (lfsr << 13);
+        const uint32_t msw  = (~(bit0 ^ bit3) & 0x10000);
+        const uint32_t lsw  = ((lfsr >> 1) & 0x0ffff);
+        noise.shift = (msw | lsw);
+        noise.phase = (lfsr & 1);
+    }
+
+    static inline auto next(const Noise& noise) -> uint32_t
+    {
+        if(noise.counter < noise.period) {
+            return noise.period - noise.counter;
+        }
+        return 1;
+    }
+
+    static inline auto skip(Noise& noise, uint32_t steps) -> void
+    {
+        if(noise.period == 0) {
+            return;
+        }
+        const uint32_t first = next(noise);
+        if(steps < first) {
+            noise.counter += steps;
+        }
+        else {
+            steps -= first;
+            noise.counter = (steps % noise.period);
+            for(uint32_t wraps = (1 + (steps / noise.period)); wraps != 0; --wraps) {
+                shift(noise);
+            }
         }
     }
 
@@ -392,27 +491,72 @@ struct EnvelopeTraits final
     {
         if(++envelope.counter >= envelope.period) {
             envelope.counter &= 0;
-            switch(cycles[envelope.shape][envelope.phase]) {
-                case RAMP_UP:
-                    envelope.amplitude = ((envelope.amplitude + 1) & 0x1f);
-                    if(envelope.amplitude == 0x1f) {
-                        envelope.phase ^= 1;
-                    }
-                    break;
-                case RAMP_DOWN:
-                    envelope.amplitude = ((envelope.amplitude - 1) & 0x1f);
-                    if(envelope.amplitude == 0x00) {
-                        envelope.phase ^= 1;
-                    }
-                    break;
-                case HOLD_UP:
-                    envelope.amplitude = 0x1f;
-                    break;
-                case HOLD_DOWN:
-                    envelope.amplitude = 0x00;
-                    break;
-                default:
+            step(envelope);
+        }
+    }
+
+    static inline auto step(Envelope& envelope) -> void
+    {
+        switch(cycles[envelope.shape][envelope.phase]) {
+            case RAMP_UP:
+                envelope.amplitude = ((envelope.amplitude + 1) & 0x1f);
+                if(envelope.amplitude == 0x1f) {
+                    envelope.phase ^= 1;
+                }
+                break;
+            case RAMP_DOWN:
+                envelope.amplitude = ((envelope.amplitude - 1) & 0x1f);
+                if(envelope.amplitude == 0x00) {
+                    envelope.phase ^= 1;
+                }
+                break;
+            case HOLD_UP:
+                envelope.amplitude = 0x1f;
+                break;
+            case HOLD_DOWN:
+                envelope.amplitude = 0x00;
+                break;
+            default:
+                break;
+        }
+    }
+
+    static inline auto idle(const Envelope& envelope) -> bool
+    {
+        switch(cycles[envelope.shape][envelope.phase]) {
+            case HOLD_UP:
+                return envelope.amplitude == 0x1f;
+            case HOLD_DOWN:
+                return envelope.amplitude == 0x00;
+            default:
+                break;
+        }
+        return false;
+    }
+
+    static inline auto next(const Envelope& envelope) -> uint32_t
+    {
+        if(envelope.counter < envelope.period) {
+            return envelope.period - envelope.counter;
+        }
+        return 1;
+    }
+
+    static inline auto skip(Envelope& envelope, uint32_t steps) -> void
+    {
+        const uint32_t period = (envelope.period != 0 ? envelope.period : 1);
+        const uint32_t first  = next(envelope);
+        if(steps < first) {
+            envelope.counter += steps;
+        }
+        else {
+            steps -= first;
+            envelope.counter = (steps % period);
+            for(uint32_t wraps = (1 + (steps / period)); wraps != 0; --wraps) {
+                if(idle(envelope)) {
                     break;
+                }
+                step(envelope);
             }
         }
     }
@@ -475,14 +619,54 @@ struct OutputTraits final
 {
     static inline auto reset(Output& output) -> void
     {
-        output.channel0 = 0.0f;
-        output.channel1 = 0.0f;
-        output.channel2 = 0.0f;
+        output.channel0 &= 0;
+        output.channel1 &= 0;
+        output.channel2 &= 0;
+    }
+
+    /*
+     * as on the chip, a channel outputs (tone | tone_off) & (noise | noise_off)
+     * through its dac. the dac table is bipolar, -level for a low output and
+     * +level for a high one, so a tone is centred. a channel with both tone and
+     * noise disabled is held high: it sits at a constant +level, and samples
+     * played by writing its volume swing between 0 and +level. the real chip
+     * is unipolar and its output is ac-coupled, this offset is not removed.
+     */
+    static inline auto compute(const State& state, const Sound& sound, const Noise& noise, const Envelope& envelope, const int index) -> int16_t
+    {
+        const uint8_t sig_sound = (sound.phase | (state.has_sound[index] ^ 1));
+        const uint8_t sig_noise = (noise.phase | (state.has_noise[index] ^ 1));
+        const uint8_t amplitude = (sound.amplitude & 0x20 ? (envelope.amplitude & 0x1f) : (sound.amplitude & 0x1f));
+
+        return state.dac[amplitude][sig_sound & sig_noise];
     }
 };
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::NullSink
+// ---------------------------------------------------------------------------
+
+namespace {
+
+class NullSink final
+    : public psg::Sink
+{
+public: // public interface
+    NullSink() = default;
+
+    virtual ~NullSink() = default;
+
+    virtual auto psg_output(psg::Instance& instance, uint32_t timestamp, const psg::Output& output) -> void override final
+    {
+    }
+};
+
+NullSink null_sink;
+
+}
+
 // ---------------------------------------------------------------------------
 // psg::Instance
 // ---------------------------------------------------------------------------
@@ -491,6 +675,7 @@ namespace psg {
 
 Instance::Instance(const Type type, Interface& interface)
     : _interface(interface)
+    , _sink(&null_sink)
     , _state()
     , _sound()
     , _noise()
@@ -520,53 +705,17 @@ auto Instance::reset() -> void
 
 auto Instance::clock() -> void
 {
-    auto fixup = [&](Sound& lhs, Sound& rhs) -> void
-    {
-        if((lhs.period == rhs.period) && (lhs.counter != rhs.counter)) {
-            rhs.counter = lhs.counter;
-            rhs.phase   = lhs.phase;
-        }
-    };
-
     auto prepare = [&]() -> void
     {
-        fixup(_sound[0], _sound[1]);
-        fixup(_sound[0], _sound[2]);
-        fixup(_sound[1], _sound[2]);
+        SoundTraits::fixup(_sound[BasicTraits::SOUND0], _sound[BasicTraits::SOUND1]);
+        SoundTraits::fixup(_sound[BasicTraits::SOUND0], _sound[BasicTraits::SOUND2]);
+        SoundTraits::fixup(_sound[BasicTraits::SOUND1], _sound[BasicTraits::SOUND2]);
     };
 
-#if 0 /* original psg output not really adapted to float [-1.0:+1.0] output */
-    auto get_output = [&](const int sound_index, const int noise_index) -> float
+    auto get_output = [&](const int sound_index, const int noise_index) -> int16_t
     {
-        const uint8_t has_sound = _state.has_sound[sound_index];
-        const uint8_t has_noise = _state.has_noise[sound_index];
-        const uint8_t sig_sound = _sound[sound_index].phase;
-        const uint8_t sig_noise = _noise[noise_index].phase;
-        const uint8_t amplitude = (_sound[sound_index].amplitude & 0x20 ? (_envelope.amplitude & 0x1f) : (_sound[sound_index].amplitude & 0x1f));
-        const uint8_t output    = ((sig_sound & has_sound) | (sig_noise & has_noise));
-
-        return static_cast<float>(output) * _state.dac[amplitude] * 2.0f - 1.0f;
-    };
-#else /* modified psg output adapted to float [-1.0:+1.0] output */
-    auto get_output = [&](const int sound_index, const int noise_index) -> float
-    {
-        const uint8_t has_sound = _state.has_sound[sound_index];
-        const uint8_t has_noise = _state.has_noise[sound_index];
-        const int8_t  sig_sound = (_sound[sound_index].phase != 0 ? +1 : -1);
-        const int8_t  sig_noise = (_noise[noise_index].phase != 0 ? +1 : -1);
-        const uint8_t amplitude = (_sound[sound_index].amplitude & 0x20 ? (_envelope.amplitude & 0x1f) : (_sound[sound_index].amplitude & 0x1f));
-        int8_t        output    = 0;
-
-        if(has_sound != 0) {
-            output |= sig_sound;
-        }
-        if(has_noise != 0) {
-            output |= sig_noise;
-        }
-
-        return static_cast<float>(output) * _state.dac[amplitude];
+        return OutputTraits::compute(_state, _sound[sound_index], _noise[noise_index], _envelope, sound_index);
     };
-#endif
 
     auto output = [&]() -> void
     {
@@ -593,6 +742,114 @@ auto Instance::clock() -> void
     return update();
 }
 
+auto Instance::run(uint32_t ticks, Sink& sink) -> void
+{
+    auto prepare = [&]() -> void
+    {
+        SoundTraits::fixup(_sound[BasicTraits::SOUND0], _sound[BasicTraits::SOUND1]);
+        SoundTraits::fixup(_sound[BasicTraits::SOUND0], _sound[BasicTraits::SOUND2]);
+        SoundTraits::fixup(_sound[BasicTraits::SOUND1], _sound[BasicTraits::SOUND2]);
+    };
+
+    auto get_output = [&](const int sound_index, const int noise_index) -> int16_t
+    {
+        return OutputTraits::compute(_state, _sound[sound_index], _noise[noise_index], _envelope, sound_index);
+    };
+
+    auto has_noise = [&]() -> bool
+    {
+        if(_noise[BasicTraits::NOISE0].period == 0) {
+            return false;
+        }
+        return (_state.has_noise[BasicTraits::SOUND0] | _state.has_noise[BasicTraits::SOUND1] | _state.has_noise[BasicTraits::SOUND2]) != 0;
+    };
+
+    auto has_envelope = [&]() -> bool
+    {
+        if(EnvelopeTraits::idle(_envelope)) {
+            return false;
+        }
+        return ((_sound[BasicTraits::SOUND0].amplitude | _sound[BasicTraits::SOUND1].amplitude | _sound[BasicTraits::SOUND2].amplitude) & 0x20) != 0;
+    };
+
+    auto next_event = [&](uint32_t steps) -> uint32_t
+    {
+        auto limit = [&](const uint32_t next) -> void
+        {
+            if(next < steps) {
+                steps = next;
+            }
+        };
+
+        for(int index = BasicTraits::SOUND0; index <= BasicTraits::SOUND2; ++index) {
+            if((_state.has_sound[index] != 0) && (_sound[index].period != 0)) {
+                limit(SoundTraits::next(_sound[index]));
+            }
+        }
+        if(has_noise()) {
+            limit(NoiseTraits::next(_noise[BasicTraits::NOISE0]));
+        }
+        if(has_envelope()) {
+            limit(EnvelopeTraits::next(_envelope));
+        }
+        return steps;
+    };
+
+    auto advance = [&](const uint32_t steps) -> void
+    {
+        SoundTraits::skip(_sound[BasicTraits::SOUND0], steps);
+        SoundTraits::skip(_sound[BasicTraits::SOUND1], steps);
+        SoundTraits::skip(_sound[BasicTraits::SOUND2], steps);
+        NoiseTraits::skip(_noise[BasicTraits::NOISE0], steps);
+        EnvelopeTraits::skip(_envelope, steps);
+    };
+
+    auto output = [&]() -> void
+    {
+        const Output output {
+            get_output(BasicTraits::SOUND0, BasicTraits::NOISE0),
+            get_output(BasicTraits::SOUND1, BasicTraits::NOISE0),
+            get_output(BasicTraits::SOUND2, BasicTraits::NOISE0),
+        };
+        if((output.channel0 != _output.channel0)
+        || (output.channel1 != _output.channel1)
+        || (output.channel2 != _output.channel2)) {
+            _output = output;
+            sink.psg_output(*this, _state.ticks, _output);
+        }
+    };
+
+    auto update = [&]() -> void
+    {
+        _sink = &sink;
+        ticks += _state.pending;
+        _state.pending &= 0;
+        while(ticks != 0) {
+            const uint32_t until = (8 - (_state.ticks & 0x07));
+            if(ticks < until) {
+                _state.ticks += ticks;
+                break;
+            }
+            prepare();
+            const uint32_t steps = next_event(1 + ((ticks - until) >> 3));
+            const uint32_t count = (until + ((steps - 1) << 3));
+            advance(steps);
+            _state.ticks += count;
+            ticks        -= count;
+            output();
+        }
+    };
+
+    return update();
+}
+
+auto Instance::flush() -> void
+{
+    if(_state.pending != 0) {
+        run(0, *_sink);
+    }
+}
+
 auto Instance::get_index(uint8_t index) -> uint8_t
 {
     return (index = _state.index);
@@ -665,6 +922,8 @@ auto Instance::get_value(uint8_t value) -> uint8_t
 
 auto Instance::set_value(uint8_t value) -> uint8_t
 {
+    flush();
+
     const auto index = _state.index;
     auto&      array = _state.array[index & 0x0f];
 
@@ -723,6 +982,45 @@ auto Instance::set_value(uint8_t value) -> uint8_t
     return value;
 }
 
+auto Instance::get_state_size() const -> size_t
+{
+    return sizeof(_state)
+         + sizeof(_sound)
+         + sizeof(_noise)
+         + sizeof(_envelope)
+         + sizeof(_output);
+}
+
+auto Instance::save_state(uint8_t* data) const -> void
+{
+    auto save = [&](const void* from, const size_t size) -> void
+    {
+        static_cast<void>(::memcpy(data, from, size));
+        data += size;
+    };
+
+    save(&_state, sizeof(_state));
+    save(&_sound, sizeof(_sound));
+    save(&_noise, sizeof(_noise));
+    save(&_envelope, sizeof(_envelope));
+    save(&_output, sizeof(_output));
+}
+
+auto Instance::load_state(const uint8_t* data) -> void
+{
+    auto load = [&](void* into, const size_t size) -> void
+    {
+        static_cast<void>(::memcpy(into, data, size));
+        data += size;
+    };
+
+    load(&_state, sizeof(_state));
+    load(&_sound, sizeof(_sound));
+    load(&_noise, sizeof(_noise));
+    load(&_envelope, sizeof(_envelope));
+    load(&_output, sizeof(_output));
+}
+
 }
 
 // ---------------------------------------------------------------------------
@@ -26,6 +26,7 @@ namespace psg {
 class State;
 class Instance;
 class Interface;
+class Sink;
 
 }
 
@@ -57,12 +58,13 @@ struct State
 {
     uint8_t  type;
     uint32_t ticks;
+    uint32_t pending;
     uint8_t  index;
     uint8_t  array[16];
     uint8_t  has_sound[3];
     uint8_t  has_noise[3];
     uint8_t  dir_port[2];
-    float    dac[32];
+    int16_t  dac[32][2];
 };
 
 }
@@ -124,9 +126,9 @@ namespace psg {
 
 struct Output
 {
-    float channel0;
-    float channel1;
-    float channel2;
+    int16_t channel0;
+    int16_t channel1;
+    int16_t channel2;
 };
 
 }
@@ -152,6 +154,15 @@ public: // public interface
 
     auto clock() -> void;
 
+    auto run(uint32_t ticks, Sink& sink) -> void;
+
+    auto flush() -> void;
+
+    auto defer(uint32_t ticks) -> void
+    {
+        _state.pending += ticks;
+    }
+
     auto get_index(uint8_t index) -> uint8_t;
 
     auto set_index(uint8_t index) -> uint8_t;
@@ -160,6 +171,12 @@ public: // public interface
 
     auto set_value(uint8_t value) -> uint8_t;
 
+    auto get_state_size() const -> size_t;
+
+    auto save_state(uint8_t* data) const -> void;
+
+    auto load_state(const uint8_t* data) -> void;
+
     auto operator->() -> State*
     {
         return &_state;
@@ -172,6 +189,7 @@ public: // public interface
 
 protected: // protected data
     Interface& _interface;
+    Sink*      _sink;
     State      _state;
     Sound      _sound[3];
     Noise      _noise[1];
@@ -209,6 +227,28 @@ public: // public interface
 
 }
 
+// ---------------------------------------------------------------------------
+// psg::Sink
+// ---------------------------------------------------------------------------
+
+namespace psg {
+
+class Sink
+{
+public: // public interface
+    Sink() = default;
+
+    Sink(const Sink&) = default;
+
+    Sink& operator=(const Sink&) = default;
+
+    virtual ~Sink() = default;
+
+    virtual auto psg_output(Instance& instance, uint32_t timestamp, const Output& output) -> void = 0;
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // End-Of-File
 // ---------------------------------------------------------------------------
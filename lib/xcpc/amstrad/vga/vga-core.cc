@@ -31,6 +31,49 @@
 #include <xcpc/libxcpc-priv.h>
 #include "vga-core.h"
 
+// ---------------------------------------------------------------------------
+// <anonymous>::color_table
+// ---------------------------------------------------------------------------
+
+namespace {
+
+const vga::Color color_table[32] = {
+    { "white"                       , 0x8000, 0x8000, 0x8000, 0x8000 },
+    { "white (not official)"        , 0x8000, 0x8000, 0x8000, 0x8000 },
+    { "sea green"                   , 0x0000, 0xffff, 0x8000, 0xa4dd },
+    { "pastel yellow"               , 0xffff, 0xffff, 0x8000, 0xf168 },
+    { "blue"                        , 0x0000, 0x0000, 0x8000, 0x0e97 },
+    { "purple"                      , 0xffff, 0x0000, 0x8000, 0x5b22 },
+    { "cyan"                        , 0x0000, 0x8000, 0x8000, 0x59ba },
+    { "pink"                        , 0xffff, 0x8000, 0x8000, 0xa645 },
+    { "purple (not official)"       , 0xffff, 0x0000, 0x8000, 0x5b22 },
+    { "pastel yellow (not official)", 0xffff, 0xffff, 0x8000, 0xf168 },
+    { "bright yellow"               , 0xffff, 0xffff, 0x0000, 0xe2d0 },
+    { "bright white"                , 0xffff, 0xffff, 0xffff, 0xffff },
+    { "bright red"                  , 0xffff, 0x0000, 0x0000, 0x4c8b },
+    { "bright magenta"              , 0xffff, 0x0000, 0xffff, 0x69ba },
+    { "orange"                      , 0xffff, 0x8000, 0x0000, 0x97ad },
+    { "pastel magenta"              , 0xffff, 0x8000, 0xffff, 0xb4dc },
+    { "blue (not official)"         , 0x0000, 0x0000, 0x8000, 0x0e97 },
+    { "sea green (not official)"    , 0x0000, 0xffff, 0x8000, 0xa4dd },
+    { "bright green"                , 0x0000, 0xffff, 0x0000, 0x9645 },
+    { "bright cyan"                 , 0x0000, 0xffff, 0xffff, 0xb374 },
+    { "black"                       , 0x0000, 0x0000, 0x0000, 0x0000 },
+    { "bright blue"                 , 0x0000, 0x0000, 0xffff, 0x1d2f },
+    { "green"                       , 0x0000, 0x8000, 0x0000, 0x4b23 },
+    { "sky blue"                    , 0x0000, 0x8000, 0xffff, 0x6852 },
+    { "magenta"                     , 0x8000, 0x0000, 0x8000, 0x34dd },
+    { "pastel green"                , 0x8000, 0xffff, 0x8000, 0xcb22 },
+    { "lime"                        , 0x8000, 0xffff, 0x0000, 0xbc8b },
+    { "pastel cyan"                 , 0x8000, 0xffff, 0xffff, 0xd9ba },
+    { "red"                         , 0x8000, 0x0000, 0x0000, 0x2645 },
+    { "mauve"                       , 0x8000, 0x0000, 0xffff, 0x4374 },
+    { "yellow"                      , 0x8000, 0x8000, 0x0000, 0x7168 },
+    { "pastel blue"                 , 0x8000, 0x8000, 0xffff, 0x8e97 }
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // <anonymous>::BasicTraits
 // ---------------------------------------------------------------------------
@@ -58,6 +101,71 @@ struct BasicTraits
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::ModeTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct ModeTraits final
+    : public BasicTraits
+{
+    /*
+     * the gate-array fetches two bytes per character, each byte packs the
+     * pixels with their bits interleaved. once decoded, the pixels of a byte
+     * are packed from the lsb: 2 pixels of 4 bits in mode 0, 4 pixels of 2
+     * bits in mode 1 and 8 pixels of 1 bit in mode 2.
+     */
+
+    static inline auto decode_mode0(const uint32_t index) -> uint8_t
+    {
+        return ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
+             | ((index & BIT5) >> 3) | ((index & BIT1) << 2)
+             | ((index & BIT6) >> 2) | ((index & BIT2) << 3)
+             | ((index & BIT4) << 2) | ((index & BIT0) << 7)
+             ;
+    }
+
+    static inline auto decode_mode1(const uint32_t index) -> uint8_t
+    {
+        return ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
+             | ((index & BIT6) >> 4) | ((index & BIT2) << 1)
+             | ((index & BIT5) >> 1) | ((index & BIT1) << 4)
+             | ((index & BIT4) << 2) | ((index & BIT0) << 7)
+             ;
+    }
+
+    static inline auto decode_mode2(const uint32_t index) -> uint8_t
+    {
+        return ((index & BIT7) >> 7) | ((index & BIT6) >> 5)
+             | ((index & BIT5) >> 3) | ((index & BIT4) >> 1)
+             | ((index & BIT3) << 1) | ((index & BIT2) << 3)
+             | ((index & BIT1) << 5) | ((index & BIT0) << 7)
+             ;
+    }
+
+    static inline auto decode_mode3(const uint32_t index) -> uint8_t
+    {
+        return ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
+             | ((index & BIT6) >> 4) | ((index & BIT2) << 1)
+             | ((index & BIT5) >> 1) | ((index & BIT1) << 4)
+             | ((index & BIT4) << 2) | ((index & BIT0) << 7)
+             ;
+    }
+
+    static inline auto decode(const uint8_t mode, const uint8_t byte) -> uint8_t
+    {
+        switch(mode & 0x03) {
+            case 0x00: return decode_mode0(byte);
+            case 0x01: return decode_mode1(byte);
+            case 0x02: return decode_mode2(byte);
+            default  : return decode_mode3(byte);
+        }
+    }
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // <anonymous>::StateTraits
 // ---------------------------------------------------------------------------
@@ -85,11 +193,7 @@ struct StateTraits final
     {
         uint32_t index = 0;
         for(auto& value : state.mode0) {
-            value = ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
-                  | ((index & BIT5) >> 3) | ((index & BIT1) << 2)
-                  | ((index & BIT6) >> 2) | ((index & BIT2) << 3)
-                  | ((index & BIT4) << 2) | ((index & BIT0) << 7)
-                  ;
+            value = ModeTraits::decode_mode0(index);
             ++index;
         }
     }
@@ -98,11 +202,7 @@ struct StateTraits final
     {
         uint32_t index = 0;
         for(auto& value : state.mode1) {
-            value = ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
-                  | ((index & BIT6) >> 4) | ((index & BIT2) << 1)
-                  | ((index & BIT5) >> 1) | ((index & BIT1) << 4)
-                  | ((index & BIT4) << 2) | ((index & BIT0) << 7)
-                  ;
+            value = ModeTraits::decode_mode1(index);
             ++index;
         }
     }
@@ -111,11 +211,7 @@ struct StateTraits final
     {
         uint32_t index = 0;
         for(auto& value : state.mode2) {
-            value = ((index & BIT7) >> 7) | ((index & BIT6) >> 5)
-                  | ((index & BIT5) >> 3) | ((index & BIT4) >> 1)
-                  | ((index & BIT3) << 1) | ((index & BIT2) << 3)
-                  | ((index & BIT1) << 5) | ((index & BIT0) << 7)
-                  ;
+            value = ModeTraits::decode_mode2(index);
             ++index;
         }
     }
@@ -124,11 +220,7 @@ struct StateTraits final
     {
         uint32_t index = 0;
         for(auto& value : state.mode3) {
-            value = ((index & BIT7) >> 7) | ((index & BIT3) >> 2)
-                  | ((index & BIT6) >> 4) | ((index & BIT2) << 1)
-                  | ((index & BIT5) >> 1) | ((index & BIT1) << 4)
-                  | ((index & BIT4) << 2) | ((index & BIT0) << 7)
-                  ;
+            value = ModeTraits::decode_mode3(index);
             ++index;
         }
     }
@@ -286,6 +378,16 @@ auto Instance::assert_vsync(uint8_t vsync) -> void
     }
 }
 
+auto Instance::get_color(const uint8_t color) -> const Color&
+{
+    return color_table[color & 0x1f];
+}
+
+auto Instance::decode_byte(const uint8_t mode, const uint8_t byte) -> uint8_t
+{
+    return ModeTraits::decode(mode, byte);
+}
+
 }
 
 // ---------------------------------------------------------------------------
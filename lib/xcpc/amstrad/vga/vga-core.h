@@ -43,6 +43,23 @@ enum Type
 
 }
 
+// ---------------------------------------------------------------------------
+// vga::Color
+// ---------------------------------------------------------------------------
+
+namespace vga {
+
+struct Color
+{
+    const char* label;
+    uint16_t    red;
+    uint16_t    green;
+    uint16_t    blue;
+    uint16_t    luminance;
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // vga::Colormap
 // ---------------------------------------------------------------------------
@@ -132,6 +149,10 @@ public: // public interface
 
     auto assert_vsync(uint8_t hsync) -> void;
 
+    static auto get_color(const uint8_t color) -> const Color&;
+
+    static auto decode_byte(const uint8_t mode, const uint8_t byte) -> uint8_t;
+
     auto operator->() -> State*
     {
         return &_state;
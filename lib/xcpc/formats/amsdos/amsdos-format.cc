@@ -0,0 +1,457 @@
+/*
+ * amsdos-format.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "amsdos-format.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::BasicTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BasicTraits
+{
+    using Error      = amsdos::Error;
+    using Header     = amsdos::Header;
+    using Filename   = amsdos::Filename;
+    using Folder     = amsdos::Folder;
+    using FileReader = amsdos::FileReader;
+    using FileWriter = amsdos::FileWriter;
+
+    static constexpr size_t  HEADER_SIZE   = 128;
+    static constexpr size_t  CHECKSUM_SIZE = 67;
+    static constexpr uint8_t TYPE_BASIC    = 0x00;
+    static constexpr uint8_t TYPE_BINARY   = 0x02;
+    static constexpr uint8_t TYPE_ASCII    = 0x16;
+    static constexpr uint8_t TYPE_MASK     = 0x0e;
+    static constexpr uint8_t SOFT_EOF      = 0x1a;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::HeaderTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct HeaderTraits final
+    : public BasicTraits
+{
+    static auto checksum(const uint8_t* bytes) -> uint16_t
+    {
+        uint16_t checksum = 0;
+
+        for(size_t index = 0; index < CHECKSUM_SIZE; ++index) {
+            checksum += bytes[index];
+        }
+        return checksum;
+    }
+
+    static auto is_valid(const std::vector<uint8_t>& bytes) -> bool
+    {
+        if(bytes.size() >= HEADER_SIZE) {
+            const uint16_t computed = checksum(bytes.data());
+            const uint16_t expected = (bytes[CHECKSUM_SIZE + 0] << 0)
+                                    | (bytes[CHECKSUM_SIZE + 1] << 8);
+            return (computed != 0) && (computed == expected);
+        }
+        return false;
+    }
+
+    static auto is_ascii(const uint8_t file_type) -> bool
+    {
+        return (file_type & TYPE_MASK) == (TYPE_ASCII & TYPE_MASK);
+    }
+
+    static auto get_real_length(const Header& header) -> uint32_t
+    {
+        const uint32_t real_length = (header.info.s.real_length_lsb <<  0)
+                                   | (header.info.s.real_length_mid <<  8)
+                                   | (header.info.s.real_length_msb << 16);
+        if(real_length == 0) {
+            return (header.info.s.logical_length_lsb << 0)
+                 | (header.info.s.logical_length_msb << 8);
+        }
+        return real_length;
+    }
+
+    static auto set_filename(Header& header, const std::string& name, const std::string& extension) -> void
+    {
+        auto set_field = [](uint8_t* field, const size_t length, const std::string& string) -> void
+        {
+            for(size_t index = 0; index < length; ++index) {
+                field[index] = (index < string.size() ? string[index] : ' ');
+            }
+        };
+
+        set_field(header.info.s.filename, sizeof(header.info.s.filename), name);
+        set_field(header.info.s.extension, sizeof(header.info.s.extension), extension);
+    }
+
+    static auto set_lengths(Header& header, const size_t size) -> void
+    {
+        const uint32_t logical_length = (size < 0xffff ? size : 0xffff);
+        const uint32_t real_length    = (size < 0xffffff ? size : 0xffffff);
+
+        if((header.info.s.logical_length_lsb | header.info.s.logical_length_msb) == 0) {
+            header.info.s.logical_length_lsb = static_cast<uint8_t>(logical_length >> 0);
+            header.info.s.logical_length_msb = static_cast<uint8_t>(logical_length >> 8);
+        }
+        header.info.s.real_length_lsb = static_cast<uint8_t>(real_length >>  0);
+        header.info.s.real_length_mid = static_cast<uint8_t>(real_length >>  8);
+        header.info.s.real_length_msb = static_cast<uint8_t>(real_length >> 16);
+    }
+
+    static auto set_checksum(Header& header) -> void
+    {
+        const uint16_t checksum = HeaderTraits::checksum(header.info.raw);
+
+        header.info.s.checksum_lsb = static_cast<uint8_t>(checksum >> 0);
+        header.info.s.checksum_msb = static_cast<uint8_t>(checksum >> 8);
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::FolderTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct FolderTraits final
+    : public BasicTraits
+{
+    static auto to_upper(const std::string& string) -> std::string
+    {
+        std::string result(string);
+
+        for(auto& character : result) {
+            character = static_cast<char>(::toupper(static_cast<unsigned char>(character)));
+        }
+        return result;
+    }
+
+    static auto is_regular(const std::string& pathname) -> bool
+    {
+        struct stat statbuf;
+
+        if(::stat(pathname.c_str(), &statbuf) == 0) {
+            return S_ISREG(statbuf.st_mode);
+        }
+        return false;
+    }
+
+    static auto lookup(const std::string& dirname, const std::vector<std::string>& candidates) -> std::string
+    {
+        std::string result;
+        size_t      rank = candidates.size();
+        DIR*        dir  = ::opendir(dirname.c_str());
+
+        if(dir != nullptr) {
+            struct dirent* entry = nullptr;
+            while((entry = ::readdir(dir)) != nullptr) {
+                const std::string entry_name(entry->d_name);
+                const std::string upper_name(to_upper(entry_name));
+                for(size_t index = 0; index < rank; ++index) {
+                    if(upper_name != candidates[index]) {
+                        continue;
+                    }
+                    const std::string pathname(dirname + '/' + entry_name);
+                    if(is_regular(pathname)) {
+                        result = pathname;
+                        rank   = index;
+                    }
+                    break;
+                }
+            }
+            dir = (::closedir(dir), nullptr);
+        }
+        return result;
+    }
+
+    static auto get_extension(const Filename& filename, const uint8_t file_type) -> std::string
+    {
+        if(filename.typed != false) {
+            return filename.extension;
+        }
+        if(HeaderTraits::is_ascii(file_type)) {
+            return std::string();
+        }
+        if((file_type & TYPE_MASK) == TYPE_BASIC) {
+            return std::string("BAS");
+        }
+        return std::string("BIN");
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::Folder
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+Folder::Folder(const std::string& dirname)
+    : _dirname(dirname)
+{
+}
+
+auto Folder::find_file(const Filename& filename) const -> std::string
+{
+    std::vector<std::string> candidates;
+
+    if(filename.typed != false) {
+        if(filename.extension.empty()) {
+            candidates.push_back(filename.name);
+        }
+        candidates.push_back(filename.name + '.' + filename.extension);
+    }
+    else {
+        candidates.push_back(filename.name);
+        candidates.push_back(filename.name + '.');
+        candidates.push_back(filename.name + ".BAS");
+        candidates.push_back(filename.name + ".BIN");
+    }
+    return FolderTraits::lookup(_dirname, candidates);
+}
+
+auto Folder::make_file(const Filename& filename, const uint8_t file_type) const -> std::string
+{
+    const std::string extension(FolderTraits::get_extension(filename, file_type));
+    const std::string basename(extension.empty() ? filename.name : filename.name + '.' + extension);
+    const std::string pathname(FolderTraits::lookup(_dirname, { basename, basename + '.' }));
+
+    if(pathname.empty()) {
+        return _dirname + '/' + basename;
+    }
+    return pathname;
+}
+
+auto Folder::parse(const std::string& string) -> Filename
+{
+    Filename    filename { -1, std::string(), std::string(), false };
+    std::string stripped;
+
+    for(auto character : string) {
+        character &= 0x7f;
+        if((character != ' ') && (character != '\0')) {
+            stripped += static_cast<char>(::toupper(static_cast<unsigned char>(character)));
+        }
+    }
+    const size_t colon = stripped.find(':');
+    if(colon != std::string::npos) {
+        if(colon != 0) {
+            switch(stripped[colon - 1]) {
+                case 'A':
+                    filename.drive = 0;
+                    break;
+                case 'B':
+                    filename.drive = 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+        stripped.erase(0, colon + 1);
+    }
+    const size_t dot = stripped.find('.');
+    if(dot != std::string::npos) {
+        filename.name      = stripped.substr(0, dot);
+        filename.extension = stripped.substr(dot + 1);
+        filename.typed     = true;
+    }
+    else {
+        filename.name = stripped;
+    }
+    return filename;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::FileReader
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+FileReader::FileReader(const std::string& filename)
+    : _header()
+    , _data()
+    , _index(0)
+{
+    std::vector<uint8_t> bytes;
+
+    auto load_file = [&]() -> void
+    {
+        FILE* file = ::fopen(filename.c_str(), "rb");
+        if(file == nullptr) {
+            throw std::runtime_error("unable to open file for reading");
+        }
+        uint8_t buffer[4096];
+        size_t  count = 0;
+        while((count = ::fread(buffer, 1, sizeof(buffer), file)) != 0) {
+            bytes.insert(bytes.end(), buffer, buffer + count);
+        }
+        const bool failed = (::ferror(file) != 0);
+        file = (::fclose(file), nullptr);
+        if(failed) {
+            throw std::runtime_error("unable to read file");
+        }
+    };
+
+    auto load_with_header = [&]() -> void
+    {
+        static_cast<void>(::memcpy(_header.info.raw, bytes.data(), sizeof(_header.info.raw)));
+        const size_t available = bytes.size() - BasicTraits::HEADER_SIZE;
+        const size_t length    = HeaderTraits::get_real_length(_header);
+        const auto   first     = bytes.begin() + BasicTraits::HEADER_SIZE;
+        _data.assign(first, first + (length < available ? length : available));
+    };
+
+    auto load_without_header = [&]() -> void
+    {
+        const size_t      slash    = filename.rfind('/');
+        const std::string basename = FolderTraits::to_upper(slash != std::string::npos ? filename.substr(slash + 1) : filename);
+        const Filename    parsed   = Folder::parse(basename);
+        HeaderTraits::set_filename(_header, parsed.name, parsed.extension);
+        HeaderTraits::set_lengths(_header, bytes.size());
+        _header.info.s.file_type = BasicTraits::TYPE_ASCII;
+        _data.swap(bytes);
+    };
+
+    load_file();
+    if(HeaderTraits::is_valid(bytes)) {
+        load_with_header();
+    }
+    else {
+        load_without_header();
+    }
+}
+
+auto FileReader::get_char(uint8_t& data) -> uint8_t
+{
+    const uint8_t error = test_eof();
+
+    if(error == Error::ERROR_NONE) {
+        data = _data[_index++];
+    }
+    return error;
+}
+
+auto FileReader::unget_char() -> void
+{
+    if(_index != 0) {
+        --_index;
+    }
+}
+
+auto FileReader::test_eof() const -> uint8_t
+{
+    if(_index >= _data.size()) {
+        return Error::ERROR_HARD_EOF;
+    }
+    if(HeaderTraits::is_ascii(_header.info.s.file_type) && (_data[_index] == BasicTraits::SOFT_EOF)) {
+        return Error::ERROR_SOFT_EOF;
+    }
+    return Error::ERROR_NONE;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::FileWriter
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+FileWriter::FileWriter(const std::string& dirname, const Filename& filename)
+    : _dirname(dirname)
+    , _filename(filename)
+    , _header()
+    , _data()
+{
+    HeaderTraits::set_filename(_header, _filename.name, _filename.extension);
+    _header.info.s.file_type = BasicTraits::TYPE_ASCII;
+}
+
+auto FileWriter::put_char(const uint8_t data) -> void
+{
+    _data.push_back(data);
+}
+
+auto FileWriter::put_data(const uint8_t* data, const size_t size) -> void
+{
+    _data.insert(_data.end(), data, data + size);
+}
+
+auto FileWriter::close() -> void
+{
+    const uint8_t     file_type = _header.info.s.file_type;
+    const std::string pathname(Folder(_dirname).make_file(_filename, file_type));
+    FILE*             file = ::fopen(pathname.c_str(), "wb");
+
+    auto write_header = [&]() -> bool
+    {
+        if(HeaderTraits::is_ascii(file_type)) {
+            return true;
+        }
+        _header.info.s.user_number = 0;
+        HeaderTraits::set_lengths(_header, _data.size());
+        HeaderTraits::set_checksum(_header);
+        return ::fwrite(_header.info.raw, 1, sizeof(_header.info.raw), file) == sizeof(_header.info.raw);
+    };
+
+    auto write_data = [&]() -> bool
+    {
+        return ::fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+    };
+
+    if(file == nullptr) {
+        throw std::runtime_error("unable to open file for writing");
+    }
+    const bool written = write_header() && write_data();
+    if((::fclose(file) != 0) || (written == false)) {
+        throw std::runtime_error("unable to write file");
+    }
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
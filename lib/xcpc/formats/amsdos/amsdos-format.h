@@ -0,0 +1,207 @@
+/*
+ * amsdos-format.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_AMSDOS_FORMAT_H__
+#define __XCPC_AMSDOS_FORMAT_H__
+
+// ---------------------------------------------------------------------------
+// amsdos::Error
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+enum Error
+{
+    ERROR_NONE      = 0x00,
+    ERROR_NOT_OPEN  = 0x0e,
+    ERROR_HARD_EOF  = 0x0f,
+    ERROR_SOFT_EOF  = 0x1a,
+    ERROR_NOT_FOUND = 0x22,
+    ERROR_DISC_FULL = 0x24,
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::Header
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+struct Header
+{
+    union {
+        uint8_t raw[128];
+        struct {
+            uint8_t user_number;
+            uint8_t filename[8];
+            uint8_t extension[3];
+            uint8_t reserved1[4];
+            uint8_t block_number;
+            uint8_t last_block;
+            uint8_t file_type;
+            uint8_t data_length_lsb;
+            uint8_t data_length_msb;
+            uint8_t data_location_lsb;
+            uint8_t data_location_msb;
+            uint8_t first_block;
+            uint8_t logical_length_lsb;
+            uint8_t logical_length_msb;
+            uint8_t entry_address_lsb;
+            uint8_t entry_address_msb;
+            uint8_t reserved2[36];
+            uint8_t real_length_lsb;
+            uint8_t real_length_mid;
+            uint8_t real_length_msb;
+            uint8_t checksum_lsb;
+            uint8_t checksum_msb;
+            uint8_t padding[59];
+        } s;
+    } info;
+};
+
+static_assert(sizeof(Header) == 128UL);
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::Filename
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+struct Filename
+{
+    int         drive;     /* -1 when no drive was given   */
+    std::string name;      /* uppercase name               */
+    std::string extension; /* uppercase extension          */
+    bool        typed;     /* true when a '.' was given    */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::Folder
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+class Folder
+{
+public: // public interface
+    Folder(const std::string& dirname);
+
+    Folder(const Folder&) = delete;
+
+    Folder& operator=(const Folder&) = delete;
+
+    virtual ~Folder() = default;
+
+    auto find_file(const Filename& filename) const -> std::string;
+
+    auto make_file(const Filename& filename, const uint8_t file_type) const -> std::string;
+
+    static auto parse(const std::string& string) -> Filename;
+
+private: // private data
+    const std::string _dirname;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::FileReader
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+class FileReader
+{
+public: // public interface
+    FileReader(const std::string& filename);
+
+    FileReader(const FileReader&) = delete;
+
+    FileReader& operator=(const FileReader&) = delete;
+
+    virtual ~FileReader() = default;
+
+    auto get_char(uint8_t& data) -> uint8_t;
+
+    auto unget_char() -> void;
+
+    auto test_eof() const -> uint8_t;
+
+    auto get_header() -> Header&
+    {
+        return _header;
+    }
+
+    auto get_data() const -> const std::vector<uint8_t>&
+    {
+        return _data;
+    }
+
+private: // private data
+    Header               _header;
+    std::vector<uint8_t> _data;
+    size_t               _index;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// amsdos::FileWriter
+// ---------------------------------------------------------------------------
+
+namespace amsdos {
+
+class FileWriter
+{
+public: // public interface
+    FileWriter(const std::string& dirname, const Filename& filename);
+
+    FileWriter(const FileWriter&) = delete;
+
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    virtual ~FileWriter() = default;
+
+    auto put_char(const uint8_t data) -> void;
+
+    auto put_data(const uint8_t* data, const size_t size) -> void;
+
+    auto close() -> void;
+
+    auto get_header() -> Header&
+    {
+        return _header;
+    }
+
+private: // private data
+    const std::string    _dirname;
+    const Filename       _filename;
+    Header               _header;
+    std::vector<uint8_t> _data;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_AMSDOS_FORMAT_H__ */
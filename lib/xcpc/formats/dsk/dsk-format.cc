@@ -30,6 +30,9 @@
 #ifdef HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
@@ -39,8 +42,14 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
 #include <stdexcept>
+#include <xcpc/libxcpc-priv.h>
 #include "dsk-format.h"
 
 // ---------------------------------------------------------------------------
@@ -128,6 +137,30 @@ struct utils
         return length;
     }
 
+    static void seek(int fd, const size_t offset)
+    {
+        const off_t rc = ::lseek(fd, static_cast<off_t>(offset), SEEK_SET);
+        if(rc < 0) {
+            throw std::runtime_error("seek() has failed");
+        }
+    }
+
+    static void sync(int fd)
+    {
+        const int rc = ::fsync(fd);
+        if(rc != 0) {
+            throw std::runtime_error("fsync() has failed");
+        }
+    }
+
+    static void truncate(int fd, const size_t length)
+    {
+        const int rc = ::ftruncate(fd, static_cast<off_t>(length));
+        if(rc != 0) {
+            throw std::runtime_error("ftruncate() has failed");
+        }
+    }
+
     static void close(int fd)
     {
         const int rc = ::close(fd);
@@ -217,6 +250,376 @@ struct traits
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::ImageTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct ImageTraits
+{
+    using DiskRecord  = dsk::DiskRecord;
+    using TrackRecord = dsk::TrackRecord;
+
+    static constexpr size_t   DISK_INFO_SIZE   = 256;
+    static constexpr size_t   TRACK_INFO_SIZE  = 256;
+    static constexpr size_t   SECTOR_INFO_BASE = 24;
+    static constexpr size_t   SECTOR_INFO_SIZE = 8;
+    static constexpr size_t   TRACK_TABLE_SIZE = 204;
+    static constexpr size_t   MAX_TRACK_LENGTH = 0xff00;
+    static constexpr unsigned MAX_SECTORS      = 29;
+    static constexpr size_t   LOAD_CHUNK_SIZE  = 65536;
+
+    static inline auto get_disk(uint8_t* data) -> DiskRecord&
+    {
+        return *reinterpret_cast<DiskRecord*>(data);
+    }
+
+    static inline auto get_disk(const uint8_t* data) -> const DiskRecord&
+    {
+        return *reinterpret_cast<const DiskRecord*>(data);
+    }
+
+    static inline auto get_track(uint8_t* data) -> TrackRecord&
+    {
+        return *reinterpret_cast<TrackRecord*>(data);
+    }
+
+    static inline auto get_sector_length(const uint8_t fdc_n) -> size_t
+    {
+        return static_cast<size_t>(0x80) << (fdc_n & 7);
+    }
+
+    static inline auto get_track_size(const DiskRecord& disk) -> size_t
+    {
+        return (static_cast<size_t>(disk.info.s.track_size_lsb) << 0)
+             | (static_cast<size_t>(disk.info.s.track_size_msb) << 8)
+             ;
+    }
+
+    static inline auto set_track_size(DiskRecord& disk, const size_t track_size) -> void
+    {
+        disk.info.s.track_size_lsb = static_cast<uint8_t>(track_size >> 0);
+        disk.info.s.track_size_msb = static_cast<uint8_t>(track_size >> 8);
+    }
+
+    static inline auto has_magic(const uint8_t* data, const size_t size) -> bool
+    {
+        if(size >= 8) {
+            if(::memcmp(data, dsk::internal::std_magic, 8) == 0) {
+                return true;
+            }
+            if(::memcmp(data, dsk::internal::ext_magic, 8) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static inline auto has_track_info(const uint8_t* data) -> bool
+    {
+        return ::memcmp(data, dsk::internal::trk_info, 10) == 0;
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::CompressTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct CompressTraits
+{
+    using Compression = dsk::Compression;
+    using Bytes       = std::vector<uint8_t>;
+
+    static constexpr size_t CHUNK_SIZE = xcpc::Codec::CHUNK_SIZE;
+
+    static inline auto get_compression(const uint8_t* data, const size_t size) -> Compression
+    {
+        if(xcpc::Codec::is_gzip(data, size)) {
+            return dsk::COMPRESSION_GZIP;
+        }
+        if(xcpc::Codec::is_bzip2(data, size)) {
+            return dsk::COMPRESSION_BZIP2;
+        }
+        return dsk::COMPRESSION_NONE;
+    }
+
+    static auto decompress(const Compression compression, const uint8_t* input, const size_t size, Bytes& output, const size_t limit = SIZE_MAX) -> void
+    {
+        switch(compression) {
+            case dsk::COMPRESSION_GZIP:
+                return gzip_decompress(input, size, output, limit);
+            case dsk::COMPRESSION_BZIP2:
+                return bzip2_decompress(input, size, output, limit);
+            default:
+                break;
+        }
+        output.assign(input, input + size);
+    }
+
+    static auto compress(const Compression compression, const Bytes& input, Bytes& output) -> void
+    {
+        switch(compression) {
+            case dsk::COMPRESSION_GZIP:
+                return gzip_compress(input, output);
+            case dsk::COMPRESSION_BZIP2:
+                return bzip2_compress(input, output);
+            default:
+                break;
+        }
+        output = input;
+    }
+
+    static auto gzip_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+    {
+        return xcpc::Codec::gzip_decompress(input, size, output, limit);
+    }
+
+    static auto gzip_compress(const Bytes& input, Bytes& output) -> void
+    {
+        return xcpc::Codec::gzip_compress(input.data(), input.size(), output);
+    }
+
+    static auto bzip2_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+    {
+        return xcpc::Codec::bzip2_decompress(input, size, output, limit);
+    }
+
+    static auto bzip2_compress(const Bytes& input, Bytes& output) -> void
+    {
+        return xcpc::Codec::bzip2_compress(input.data(), input.size(), output);
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::JournalTraits
+// ---------------------------------------------------------------------------
+
+/*
+ * a journal records the regions of an image about to be written back:
+ *
+ *   magic "XCPC-JNL", image size (u64), number of entries (u32)
+ *   for each entry: offset (u64), length (u32), data
+ *   checksum of all of the above (u32), magic "XCPC-END"
+ *
+ * it is written and synced before the image is touched, and removed once
+ * the image has been synced, so an interrupted write-back is either rolled
+ * forward from a complete journal or never started
+ */
+
+namespace {
+
+struct JournalTraits
+{
+    using Entry   = dsk::Chunk;
+    using Entries = std::vector<Entry>;
+    using Bytes   = std::vector<uint8_t>;
+
+    static constexpr char   head_magic[8] = { 'X', 'C', 'P', 'C', '-', 'J', 'N', 'L' };
+    static constexpr char   tail_magic[8] = { 'X', 'C', 'P', 'C', '-', 'E', 'N', 'D' };
+    static constexpr size_t HEAD_SIZE     = 20;
+    static constexpr size_t ENTRY_SIZE    = 12;
+    static constexpr size_t TAIL_SIZE     = 12;
+
+    static inline auto get_journal(const std::string& filename) -> std::string
+    {
+        return filename + ".journal";
+    }
+
+    static inline auto put_value(Bytes& bytes, const uint64_t value, const unsigned length) -> void
+    {
+        for(unsigned index = 0; index < length; ++index) {
+            bytes.push_back(static_cast<uint8_t>(value >> (index * 8)));
+        }
+    }
+
+    static inline auto get_value(const uint8_t* bytes, const unsigned length) -> uint64_t
+    {
+        uint64_t value = 0;
+        for(unsigned index = 0; index < length; ++index) {
+            value |= (static_cast<uint64_t>(bytes[index]) << (index * 8));
+        }
+        return value;
+    }
+
+    static inline auto get_checksum(const uint8_t* bytes, const size_t length) -> uint32_t
+    {
+        uint32_t checksum = 0x811c9dc5;
+        for(size_t index = 0; index < length; ++index) {
+            checksum = ((checksum ^ bytes[index]) * 0x01000193);
+        }
+        return checksum;
+    }
+
+    static auto encode(const size_t size, const Entries& entries) -> Bytes
+    {
+        Bytes bytes(head_magic, head_magic + sizeof(head_magic));
+        put_value(bytes, size, 8);
+        put_value(bytes, entries.size(), 4);
+        for(auto& entry : entries) {
+            put_value(bytes, entry.offset, 8);
+            put_value(bytes, entry.data.size(), 4);
+            bytes.insert(bytes.end(), entry.data.begin(), entry.data.end());
+        }
+        put_value(bytes, get_checksum(bytes.data(), bytes.size()), 4);
+        bytes.insert(bytes.end(), tail_magic, tail_magic + sizeof(tail_magic));
+        return bytes;
+    }
+
+    static auto decode(const Bytes& bytes, size_t& size, Entries& entries) -> bool
+    {
+        const size_t length = bytes.size();
+        if(length < (HEAD_SIZE + TAIL_SIZE)) {
+            return false;
+        }
+        const uint8_t* tail = &bytes[length - TAIL_SIZE];
+        if(::memcmp(bytes.data(), head_magic, sizeof(head_magic)) != 0) {
+            return false;
+        }
+        if(::memcmp(tail + 4, tail_magic, sizeof(tail_magic)) != 0) {
+            return false;
+        }
+        if(get_value(tail, 4) != get_checksum(bytes.data(), length - TAIL_SIZE)) {
+            return false;
+        }
+        size_t   position = HEAD_SIZE;
+        uint64_t count    = get_value(&bytes[16], 4);
+        size = get_value(&bytes[8], 8);
+        entries.clear();
+        while(count-- != 0) {
+            if((position + ENTRY_SIZE) > (length - TAIL_SIZE)) {
+                return false;
+            }
+            Entry entry;
+            entry.offset = get_value(&bytes[position + 0], 8);
+            const size_t data_length = get_value(&bytes[position + 8], 4);
+            position += ENTRY_SIZE;
+            if((position + data_length) > (length - TAIL_SIZE)) {
+                return false;
+            }
+            entry.data.assign(&bytes[position], &bytes[position + data_length]);
+            position += data_length;
+            entries.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    static auto write_file(const std::string& filename, const int flags, const uint8_t* data, const size_t length) -> void
+    {
+        const int file = utils::open(filename, flags, 0644);
+        try {
+            if(static_cast<size_t>(utils::store(file, data, length)) != length) {
+                throw std::runtime_error(std::string() + '<' + filename + '>' + ' ' + "could not be written");
+            }
+            utils::sync(file);
+        }
+        catch(...) {
+            static_cast<void>(::close(file));
+            throw;
+        }
+        utils::close(file);
+    }
+
+    static auto apply(const std::string& filename, const size_t size, const Entries& entries) -> void
+    {
+        const int file = utils::open(filename, (O_CREAT | O_WRONLY), 0644);
+        try {
+            for(auto& entry : entries) {
+                utils::seek(file, entry.offset);
+                if(static_cast<size_t>(utils::store(file, entry.data.data(), entry.data.size())) != entry.data.size()) {
+                    throw std::runtime_error(std::string() + '<' + filename + '>' + ' ' + "could not be written");
+                }
+            }
+            utils::truncate(file, size);
+            utils::sync(file);
+        }
+        catch(...) {
+            static_cast<void>(::close(file));
+            throw;
+        }
+        utils::close(file);
+    }
+
+    static auto commit(const std::string& filename, const size_t size, const Entries& entries) -> void
+    {
+        const std::string journal(get_journal(filename));
+        const Bytes       bytes(encode(size, entries));
+
+        write_file(journal, (O_CREAT | O_TRUNC | O_WRONLY), bytes.data(), bytes.size());
+        apply(filename, size, entries);
+        utils::unlink(journal);
+    }
+
+    static auto pending(const std::string& filename) -> bool
+    {
+        const std::string journal(get_journal(filename));
+
+        return ::access(journal.c_str(), F_OK) == 0;
+    }
+
+    static auto replay(const std::string& filename) -> void
+    {
+        const std::string journal(get_journal(filename));
+        const int         file = ::open(journal.c_str(), O_RDONLY);
+
+        if(file < 0) {
+            return;
+        }
+        Bytes bytes;
+        try {
+            size_t size = 0;
+            for(;;) {
+                bytes.resize(size + CompressTraits::CHUNK_SIZE);
+                const ssize_t count = utils::fetch(file, &bytes[size], CompressTraits::CHUNK_SIZE);
+                size += count;
+                if(static_cast<size_t>(count) < CompressTraits::CHUNK_SIZE) {
+                    break;
+                }
+            }
+            bytes.resize(size);
+        }
+        catch(...) {
+            static_cast<void>(::close(file));
+            throw;
+        }
+        utils::close(file);
+
+        size_t  size = 0;
+        Entries entries;
+        if(decode(bytes, size, entries) != false) {
+            apply(filename, size, entries);
+        }
+        utils::unlink(journal);
+    }
+
+    /*
+     * compressed images can't be patched in place: the new image is written
+     * next to the old one and renamed over it
+     */
+
+    static auto replace(const std::string& filename, const Bytes& bytes) -> void
+    {
+        const std::string temporary(filename + ".new");
+
+        write_file(temporary, (O_CREAT | O_TRUNC | O_WRONLY), bytes.data(), bytes.size());
+        if(::rename(temporary.c_str(), filename.c_str()) != 0) {
+            static_cast<void>(::unlink(temporary.c_str()));
+            throw std::runtime_error("rename() has failed");
+        }
+    }
+};
+
+constexpr char JournalTraits::head_magic[8];
+constexpr char JournalTraits::tail_magic[8];
+
+}
+
 // ---------------------------------------------------------------------------
 // dsk::BaseAdapter
 // ---------------------------------------------------------------------------
@@ -1113,7 +1516,6 @@ void ImageAdapter::fetch()
     {
         TrackInfoAdapter track_info(_image.disk, _image.track, _file);
         track_info.fetch();
-        track_info.print();
         track_info.check();
         number_of_sectors = track_info.get_number_of_sectors();
         sector_size       = track_info.get_sector_size();
@@ -1126,7 +1528,6 @@ void ImageAdapter::fetch()
             SectorInfoAdapter sector_info(_image.disk, _image.track, sector, _file);
             if(current_sector < number_of_sectors) {
                 sector_info.fetch();
-                sector_info.print();
                 sector_info.check();
             }
             else {
@@ -1144,7 +1545,6 @@ void ImageAdapter::fetch()
             if(current_sector < number_of_sectors) {
                 sector_data.clear();
                 sector_data.fetch();
-                sector_data.print();
             }
             else {
                 sector_data.clear();
@@ -1168,7 +1568,6 @@ void ImageAdapter::fetch()
     {
         DiskInfoAdapter disk_info(_image.disk, _file);
         disk_info.fetch();
-        disk_info.print();
         disk_info.check();
         number_of_sides  = disk_info.get_number_of_sides();
         number_of_tracks = disk_info.get_number_of_tracks();
@@ -1314,6 +1713,71 @@ void ImageAdapter::print()
 
 }
 
+// ---------------------------------------------------------------------------
+// dsk::Visitor
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+Visitor::Visitor()
+{
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::DumpVisitor
+// ---------------------------------------------------------------------------
+
+namespace {
+
+class DumpVisitor final
+    : public dsk::Visitor
+{
+public: // public interface
+    DumpVisitor()
+        : dsk::Visitor()
+        , _disk()
+        , _track()
+    {
+    }
+
+    virtual void on_disk_info(dsk::DiskRecord& disk) override final
+    {
+        dsk::DiskInfoAdapter disk_info(disk, -1);
+        disk_info.print();
+        disk_info.check();
+        _disk = disk;
+    }
+
+    virtual void on_track_info(dsk::TrackRecord& track) override final
+    {
+        dsk::TrackInfoAdapter track_info(_disk, track, -1);
+        track_info.print();
+        track_info.check();
+        _track = track;
+    }
+
+    virtual void on_sector_info(dsk::SectorRecord& sector) override final
+    {
+        dsk::SectorInfoAdapter sector_info(_disk, _track, sector, -1);
+        sector_info.print();
+        sector_info.check();
+    }
+
+    virtual void on_sector_data(dsk::SectorRecord& sector) override final
+    {
+        dsk::SectorDataAdapter sector_data(_disk, _track, sector, -1);
+        sector_data.print();
+    }
+
+private: // private data
+    dsk::DiskRecord  _disk;
+    dsk::TrackRecord _track;
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // dsk::Disk
 // ---------------------------------------------------------------------------
@@ -1324,11 +1788,32 @@ Disk::Disk(const std::string& filename)
     : _image()
     , _filename(filename)
     , _file(-1)
+    , _bytes()
+    , _index()
+    , _loaded(false)
+    , _readonly(false)
+    , _dirty(false)
+    , _resized(false)
+    , _compression(COMPRESSION_NONE)
+    , _pending()
+    , _mutex()
+    , _signal()
+    , _running(false)
+    , _busy(false)
+    , _writer()
+    , _failure()
 {
 }
 
 Disk::~Disk()
 {
+    try {
+        close();
+    }
+    catch(...) {
+        /* nothing to do */
+    }
+    stop_writer();
     if(_file != -1) {
         _file = (utils::close(_file), -1);
     }
@@ -1336,45 +1821,69 @@ Disk::~Disk()
 
 void Disk::dump()
 {
-    constexpr int flags = (O_RDONLY);
-    constexpr int mode  = 0;
-
-    auto do_open = [&]() -> void
+    auto do_dump = [&]() -> void
     {
-        if(_file == -1) {
-            _file = utils::open(_filename, flags, mode);
-        }
-        else {
-            throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is already opened");
+        DumpVisitor visitor;
+
+        if(_loaded != false) {
+            return visit(visitor);
         }
+        load(true);
+        visit(visitor);
+        close();
     };
 
-    auto do_close = [&]() -> void
+    return do_dump();
+}
+
+void Disk::visit(Visitor& visitor)
+{
+    auto visit_disk = [&]() -> void
     {
-        if(_file != -1) {
-            _file = (utils::close(_file), -1);
+        DiskRecord disk;
+        static_cast<void>(::memcpy(disk.info.raw, _bytes.data(), sizeof(disk.info.raw)));
+        visitor.on_disk_info(disk);
+    };
+
+    auto visit_track = [&](TrackIndex& index, std::unique_ptr<SectorRecord[]>& sectors) -> void
+    {
+        TrackRecord track;
+        static_cast<void>(::memcpy(track.info.raw, index.info, sizeof(track.info.raw)));
+        visitor.on_track_info(track);
+        for(unsigned number = 0; number < index.count; ++number) {
+            SectorRecord& sector(sectors[number]);
+            const Span    data(get_sector_data(index.sector[number], 0));
+            const size_t  length = std::min(ImageTraits::get_sector_length(index.sector[number].info[3]), sizeof(sector.data.raw6));
+            static_cast<void>(::memcpy(sector.info.raw, index.sector[number].info, sizeof(sector.info.raw)));
+            static_cast<void>(::memset(sector.data.raw6, track.info.s.filler_byte, length));
+            static_cast<void>(::memcpy(sector.data.raw6, data.data, std::min(data.size, length)));
+            visitor.on_sector_info(sector);
         }
-        else {
-            throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is already closed");
+        for(unsigned number = 0; number < index.count; ++number) {
+            visitor.on_sector_data(sectors[number]);
         }
     };
 
-    auto do_fetch = [&]() -> void
+    auto do_visit = [&]() -> void
     {
-        ImageAdapter image(_image, _file);
-
-        image.clear();
-        image.fetch();
+        if(_loaded == false) {
+            throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is not loaded");
+        }
+        std::unique_ptr<SectorRecord[]> sectors(new SectorRecord[ImageTraits::MAX_SECTORS]);
+        const unsigned tracks = get_number_of_tracks();
+        const unsigned sides  = get_number_of_sides();
+        visit_disk();
+        for(unsigned track = 0; track < tracks; ++track) {
+            for(unsigned side = 0; side < sides; ++side) {
+                TrackIndex* index = get_track(track, side);
+                if((index != nullptr) && (index->info != nullptr)) {
+                    visit_track(*index, sectors);
+                }
+            }
+        }
     };
 
-    auto do_dump = [&]() -> void
-    {
-        do_open();
-        do_fetch();
-        do_close();
-    };
-
-    return do_dump();
+    return do_visit();
 }
 
 void Disk::create()
@@ -1430,6 +1939,670 @@ void Disk::remove()
     return do_remove();
 }
 
+void Disk::load(const bool readonly)
+{
+    auto do_open = [&]() -> void
+    {
+        if(_file != -1) {
+            throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is already opened");
+        }
+        if(readonly == false) {
+            try {
+                _file = utils::open(_filename, O_RDWR);
+                _readonly = false;
+                return;
+            }
+            catch(...) {
+                /* fall back to read-only */
+            }
+        }
+        _file = utils::open(_filename, O_RDONLY);
+        _readonly = true;
+    };
+
+    /* only a writer rolls an interrupted write-back forward, a reader leaves the journal alone */
+    auto do_journal = [&]() -> void
+    {
+        if(JournalTraits::pending(_filename) == false) {
+            return;
+        }
+        if(_readonly == false) {
+            JournalTraits::replay(_filename);
+        }
+        else {
+            ::xcpc_log_alert("<%s> has a pending journal that was not replayed", _filename.c_str());
+        }
+    };
+
+    auto do_close = [&]() -> void
+    {
+        if(_file != -1) {
+            _file = (utils::close(_file), -1);
+        }
+    };
+
+    auto do_decode = [&](const uint8_t* data, const size_t size) -> void
+    {
+        _compression = CompressTraits::get_compression(data, size);
+        CompressTraits::decompress(_compression, data, size, _bytes);
+        _bytes.shrink_to_fit();
+    };
+
+    auto do_read = [&]() -> void
+    {
+        std::vector<uint8_t> bytes;
+        size_t size = 0;
+        for(;;) {
+            bytes.resize(size + ImageTraits::LOAD_CHUNK_SIZE);
+            const ssize_t count = utils::fetch(_file, &bytes[size], ImageTraits::LOAD_CHUNK_SIZE);
+            size += count;
+            if(static_cast<size_t>(count) < ImageTraits::LOAD_CHUNK_SIZE) {
+                break;
+            }
+        }
+        do_decode(bytes.data(), size);
+    };
+
+    auto do_fetch = [&]() -> void
+    {
+#ifdef HAVE_SYS_MMAN_H
+        struct stat status;
+        if((::fstat(_file, &status) == 0) && (S_ISREG(status.st_mode)) && (status.st_size > 0)) {
+            const size_t size = static_cast<size_t>(status.st_size);
+            void* const  data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, _file, 0);
+            if(data != MAP_FAILED) {
+                try {
+                    do_decode(reinterpret_cast<const uint8_t*>(data), size);
+                }
+                catch(...) {
+                    static_cast<void>(::munmap(data, size));
+                    throw;
+                }
+                static_cast<void>(::munmap(data, size));
+                return;
+            }
+        }
+#endif
+        do_read();
+    };
+
+    auto do_check = [&]() -> void
+    {
+        const size_t size = _bytes.size();
+        if((size < ImageTraits::DISK_INFO_SIZE) || (ImageTraits::has_magic(_bytes.data(), size) == false)) {
+            _bytes.clear();
+            throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is not a valid disk image");
+        }
+    };
+
+    auto do_load = [&]() -> void
+    {
+        close();
+        do_open();
+        try {
+            do_journal();
+            do_fetch();
+        }
+        catch(...) {
+            do_close();
+            throw;
+        }
+        do_close();
+        do_check();
+        build_index();
+        _loaded  = true;
+        _dirty   = false;
+        _resized = false;
+    };
+
+    return do_load();
+}
+
+void Disk::flush()
+{
+    auto do_flush = [&]() -> void
+    {
+        write_back(false);
+    };
+
+    return do_flush();
+}
+
+void Disk::close()
+{
+    auto do_close = [&]() -> void
+    {
+        if(_loaded != false) {
+            write_back(true);
+        }
+        _bytes.clear();
+        _index.clear();
+        _loaded      = false;
+        _readonly    = false;
+        _dirty       = false;
+        _resized     = false;
+        _compression = COMPRESSION_NONE;
+        wait_writer();
+    };
+
+    return do_close();
+}
+
+auto Disk::probe(const std::string& filename) -> bool
+{
+    std::vector<uint8_t> bytes(CompressTraits::CHUNK_SIZE);
+    std::vector<uint8_t> magic;
+    bool                 result = false;
+
+    const int file = ::open(filename.c_str(), O_RDONLY);
+    if(file >= 0) {
+        const ssize_t count = ::read(file, bytes.data(), bytes.size());
+        if(count > 0) {
+            bytes.resize(count);
+            try {
+                const Compression compression = CompressTraits::get_compression(bytes.data(), bytes.size());
+                CompressTraits::decompress(compression, bytes.data(), bytes.size(), magic, 8);
+                result = ImageTraits::has_magic(magic.data(), magic.size());
+            }
+            catch(...) {
+                result = false;
+            }
+        }
+        static_cast<void>(::close(file));
+    }
+    return result;
+}
+
+auto Disk::is_extended() const -> bool
+{
+    if(_bytes.size() >= ImageTraits::DISK_INFO_SIZE) {
+        return ::memcmp(_bytes.data(), internal::ext_magic, 8) == 0;
+    }
+    return false;
+}
+
+auto Disk::get_number_of_tracks() const -> unsigned
+{
+    if(_bytes.size() >= ImageTraits::DISK_INFO_SIZE) {
+        return _index.size() / 2;
+    }
+    return 0;
+}
+
+auto Disk::get_number_of_sides() const -> unsigned
+{
+    if(_bytes.size() >= ImageTraits::DISK_INFO_SIZE) {
+        const unsigned sides = ImageTraits::get_disk(_bytes.data()).info.s.number_of_sides;
+        return (sides < 2 ? 1 : 2);
+    }
+    return 0;
+}
+
+auto Disk::get_track(const unsigned track, const unsigned side) -> TrackIndex*
+{
+    if((track < get_number_of_tracks()) && (side < get_number_of_sides())) {
+        TrackIndex& index(_index[(track * 2) + side]);
+        if(index.info != nullptr) {
+            return &index;
+        }
+    }
+    return nullptr;
+}
+
+auto Disk::get_sector(TrackIndex& track, const uint8_t sector_id) -> SectorIndex*
+{
+    for(unsigned index = 0; index < track.count; ++index) {
+        SectorIndex& sector(track.sector[index]);
+        if(sector.info[2] == sector_id) {
+            return &sector;
+        }
+    }
+    return nullptr;
+}
+
+auto Disk::get_sector_data(SectorIndex& sector, const unsigned copy) -> Span
+{
+    Span span = { sector.data.data, sector.length };
+
+    if(sector.copies > 1) {
+        span.data += ((copy % sector.copies) * sector.length);
+    }
+    return span;
+}
+
+auto Disk::set_sector_data(TrackIndex& track, SectorIndex& sector, const uint8_t* data, const size_t size) -> void
+{
+    const size_t length = (size < sector.length ? size : sector.length);
+
+    for(unsigned copy = 0; copy < sector.copies; ++copy) {
+        static_cast<void>(::memcpy(sector.data.data + (copy * sector.length), data, length));
+    }
+    track.dirty = true;
+    _dirty = true;
+}
+
+auto Disk::format_track(const unsigned track, const unsigned side, const uint8_t* ids, const unsigned count, const uint8_t filler) -> bool
+{
+    if((_loaded == false) || (_readonly != false)) {
+        return false;
+    }
+
+    const DiskRecord&    disk(ImageTraits::get_disk(_bytes.data()));
+    const bool           extended   = is_extended();
+    const unsigned       tracks     = disk.info.s.number_of_tracks;
+    const unsigned       sides      = disk.info.s.number_of_sides;
+    unsigned             new_sides  = get_number_of_sides();
+    size_t               track_size = ImageTraits::get_track_size(disk);
+    size_t               length     = ImageTraits::TRACK_INFO_SIZE;
+    std::vector<uint8_t> block;
+
+    auto check = [&]() -> bool
+    {
+        if((track >= ImageTraits::TRACK_TABLE_SIZE) || (side > 1) || (count > ImageTraits::MAX_SECTORS)) {
+            return false;
+        }
+        /* the second side can only be formatted on a double-sided or a blank single-track image */
+        if((side != 0) && (new_sides == 1)) {
+            if(tracks > 1) {
+                return false;
+            }
+            new_sides = 2;
+        }
+        return true;
+    };
+
+    auto compute_length = [&]() -> bool
+    {
+        for(unsigned index = 0; index < count; ++index) {
+            length += ImageTraits::get_sector_length(ids[(index * 4) + 3]);
+        }
+        if(extended != false) {
+            if(((track + 1) * new_sides) > ImageTraits::TRACK_TABLE_SIZE) {
+                return false;
+            }
+            length = ((length + 255) & ~static_cast<size_t>(255));
+            if(length > ImageTraits::MAX_TRACK_LENGTH) {
+                return false;
+            }
+        }
+        else {
+            if((tracks == 0) || ((tracks == 1) && (sides <= 1))) {
+                if(length > track_size) {
+                    track_size = length;
+                }
+            }
+            if((length > track_size) || (track_size > 0xffff)) {
+                return false;
+            }
+            length = track_size;
+        }
+        return true;
+    };
+
+    auto build_track = [&]() -> void
+    {
+        block.assign(length, filler);
+        static_cast<void>(::memset(block.data(), 0, ImageTraits::TRACK_INFO_SIZE));
+        static_cast<void>(::memcpy(block.data(), internal::trk_info, sizeof(internal::trk_info)));
+        TrackRecord& record(ImageTraits::get_track(block.data()));
+        record.info.s.track_number      = static_cast<uint8_t>(track);
+        record.info.s.side_number       = static_cast<uint8_t>(side);
+        record.info.s.sector_size       = (count != 0 ? ids[3] : 2);
+        record.info.s.number_of_sectors = static_cast<uint8_t>(count);
+        record.info.s.gap3_length       = 0x4e;
+        record.info.s.filler_byte       = filler;
+        for(unsigned index = 0; index < count; ++index) {
+            uint8_t* info = &block[ImageTraits::SECTOR_INFO_BASE + (index * ImageTraits::SECTOR_INFO_SIZE)];
+            info[0] = ids[(index * 4) + 0];
+            info[1] = ids[(index * 4) + 1];
+            info[2] = ids[(index * 4) + 2];
+            info[3] = ids[(index * 4) + 3];
+            if(extended != false) {
+                const size_t sector_length = ImageTraits::get_sector_length(info[3]);
+                info[6] = static_cast<uint8_t>(sector_length >> 0);
+                info[7] = static_cast<uint8_t>(sector_length >> 8);
+            }
+        }
+    };
+
+    auto store_in_place = [&]() -> bool
+    {
+        if((track >= tracks) || (new_sides != sides) || (track_size != ImageTraits::get_track_size(disk))) {
+            return false;
+        }
+        TrackIndex* index = get_track(track, side);
+        if((index == nullptr) || (index->length != length)) {
+            return false;
+        }
+        static_cast<void>(::memcpy(index->info, block.data(), length));
+        index_track(*index, index->offset, length);
+        index->dirty = true;
+        _dirty = true;
+        return true;
+    };
+
+    auto store_relayout = [&]() -> void
+    {
+        const unsigned new_tracks = (track < tracks ? tracks : track + 1);
+        std::vector<uint8_t> bytes(_bytes.begin(), _bytes.begin() + ImageTraits::DISK_INFO_SIZE);
+        uint8_t table[ImageTraits::TRACK_TABLE_SIZE];
+        static_cast<void>(::memset(table, 0, sizeof(table)));
+        for(unsigned t = 0; t < new_tracks; ++t) {
+            for(unsigned s = 0; s < new_sides; ++s) {
+                const size_t   number = ((t * new_sides) + s);
+                const uint8_t* data   = nullptr;
+                size_t         size   = 0;
+                size_t         slot   = track_size;
+                if((t == track) && (s == side)) {
+                    data = block.data();
+                    size = block.size();
+                }
+                else if(TrackIndex* index = get_track(t, s)) {
+                    data = index->info;
+                    size = index->length;
+                }
+                if(extended != false) {
+                    slot = ((size + 255) & ~static_cast<size_t>(255));
+                    if((number >= ImageTraits::TRACK_TABLE_SIZE) || (slot > ImageTraits::MAX_TRACK_LENGTH)) {
+                        slot = size = 0;
+                    }
+                    else {
+                        table[number] = static_cast<uint8_t>(slot >> 8);
+                    }
+                }
+                if(size > slot) {
+                    size = slot;
+                }
+                if(data != nullptr) {
+                    bytes.insert(bytes.end(), data, data + size);
+                }
+                bytes.insert(bytes.end(), slot - size, 0);
+            }
+        }
+        DiskRecord& header(ImageTraits::get_disk(bytes.data()));
+        header.info.s.number_of_tracks = static_cast<uint8_t>(new_tracks);
+        header.info.s.number_of_sides  = static_cast<uint8_t>(new_sides);
+        if(extended != false) {
+            static_cast<void>(::memcpy(header.info.s.padding, table, sizeof(table)));
+        }
+        else {
+            ImageTraits::set_track_size(header, track_size);
+        }
+        _bytes.swap(bytes);
+        build_index();
+        _dirty   = true;
+        _resized = true;
+    };
+
+    auto do_format = [&]() -> bool
+    {
+        if((check() == false) || (compute_length() == false)) {
+            return false;
+        }
+        build_track();
+        if(store_in_place() == false) {
+            store_relayout();
+        }
+        return true;
+    };
+
+    return do_format();
+}
+
+auto Disk::build_index() -> void
+{
+    const DiskRecord& disk(ImageTraits::get_disk(_bytes.data()));
+    const bool        extended   = is_extended();
+    const unsigned    tracks     = disk.info.s.number_of_tracks;
+    const unsigned    sides      = get_number_of_sides();
+    const size_t      track_size = ImageTraits::get_track_size(disk);
+    size_t            offset     = ImageTraits::DISK_INFO_SIZE;
+
+    _index.assign(tracks * 2, TrackIndex());
+    for(unsigned track = 0; track < tracks; ++track) {
+        for(unsigned side = 0; side < sides; ++side) {
+            const size_t number = ((track * sides) + side);
+            size_t       length = track_size;
+            if(extended != false) {
+                length = 0;
+                if(number < ImageTraits::TRACK_TABLE_SIZE) {
+                    length = (static_cast<size_t>(disk.info.s.padding[number]) << 8);
+                }
+            }
+            index_track(_index[(track * 2) + side], offset, length);
+            offset += length;
+        }
+    }
+}
+
+auto Disk::index_track(TrackIndex& track, const size_t offset, const size_t length) -> void
+{
+    const size_t size     = _bytes.size();
+    const bool   extended = is_extended();
+    const bool   dirty    = track.dirty;
+    size_t       limit    = length;
+
+    track = TrackIndex();
+    track.offset = offset;
+    track.dirty  = dirty;
+    if((length < ImageTraits::TRACK_INFO_SIZE) || ((offset + ImageTraits::TRACK_INFO_SIZE) > size)) {
+        return;
+    }
+    if((offset + limit) > size) {
+        limit = (size - offset);
+    }
+    uint8_t* info = &_bytes[offset];
+    if(ImageTraits::has_track_info(info) == false) {
+        return;
+    }
+    const TrackRecord& record(ImageTraits::get_track(info));
+    unsigned count = record.info.s.number_of_sectors;
+    if(count > ImageTraits::MAX_SECTORS) {
+        count = ImageTraits::MAX_SECTORS;
+    }
+    size_t position = ImageTraits::TRACK_INFO_SIZE;
+    for(unsigned index = 0; index < count; ++index) {
+        SectorIndex& sector(track.sector[index]);
+        uint8_t*     sector_info = info + ImageTraits::SECTOR_INFO_BASE + (index * ImageTraits::SECTOR_INFO_SIZE);
+        const size_t nominal     = ImageTraits::get_sector_length(sector_info[3]);
+        size_t       stored      = ImageTraits::get_sector_length(record.info.s.sector_size);
+        if(extended != false) {
+            stored = (static_cast<size_t>(sector_info[6]) << 0)
+                   | (static_cast<size_t>(sector_info[7]) << 8)
+                   ;
+        }
+        /* never index past the end of a truncated image */
+        if((position + stored) > limit) {
+            stored = (position < limit ? limit - position : 0);
+        }
+        sector.info      = sector_info;
+        sector.data.data = info + position;
+        sector.data.size = stored;
+        sector.length    = stored;
+        sector.copies    = 1;
+        /* weak sectors are stored as several copies of the nominal size (extended images only) */
+        if((extended != false) && ((nominal * 2) <= stored)) {
+            sector.length = nominal;
+            sector.copies = static_cast<unsigned>(stored / nominal);
+        }
+        position += stored;
+    }
+    track.info   = info;
+    track.length = limit;
+    track.count  = count;
+}
+
+/* the write-back is queued for the writer, the tracks of a newer flush are appended to a pending one */
+auto Disk::write_back(const bool release) -> void
+{
+    std::exception_ptr failure;
+
+    auto get_image = [&](std::vector<Chunk>& chunks) -> void
+    {
+        Chunk chunk;
+        chunk.offset = 0;
+        /* the image is about to be closed: its bytes are moved rather than copied */
+        if(release != false) {
+            chunk.data.swap(_bytes);
+        }
+        else {
+            chunk.data = _bytes;
+        }
+        chunks.push_back(std::move(chunk));
+    };
+
+    auto get_tracks = [&](std::vector<Chunk>& chunks) -> void
+    {
+        for(auto& track : _index) {
+            if((track.dirty != false) && (track.info != nullptr)) {
+                Chunk chunk;
+                chunk.offset = track.offset;
+                chunk.data.assign(track.info, track.info + track.length);
+                chunks.push_back(std::move(chunk));
+            }
+        }
+    };
+
+    auto queue_chunks = [&]() -> void
+    {
+        const bool         whole = ((_compression != COMPRESSION_NONE) || (_resized != false));
+        const size_t       size(_bytes.size());
+        std::vector<Chunk> chunks;
+        if(whole != false) {
+            get_image(chunks);
+        }
+        else {
+            get_tracks(chunks);
+        }
+        /* queue */ {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            if((_pending.queued == false) || (whole != false)) {
+                _pending.chunks.clear();
+            }
+            for(auto& chunk : chunks) {
+                _pending.chunks.push_back(std::move(chunk));
+            }
+            _pending.queued      = true;
+            _pending.filename    = _filename;
+            _pending.compression = _compression;
+            _pending.size        = size;
+            failure  = _failure;
+            _failure = nullptr;
+            if(_running == false) {
+                _running = true;
+                _writer  = std::thread(&Disk::run_writer, this);
+            }
+        }
+        _signal.notify_all();
+    };
+
+    /* a failure of a previous write-back is reported once this one is queued */
+    auto report = [&]() -> void
+    {
+        if(failure) {
+            std::rethrow_exception(failure);
+        }
+    };
+
+    if((_loaded == false) || (_dirty == false)) {
+        return;
+    }
+    if(_readonly != false) {
+        throw std::runtime_error(std::string() + '<' + _filename + '>' + ' ' + "is read-only");
+    }
+    queue_chunks();
+    for(auto& track : _index) {
+        track.dirty = false;
+    }
+    _dirty   = false;
+    _resized = false;
+    return report();
+}
+
+auto Disk::wait_writer() -> void
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto is_idle = [&]() -> bool
+    {
+        return (_busy == false) && (_pending.queued == false);
+    };
+
+    _signal.wait(lock, is_idle);
+    if(_failure) {
+        std::exception_ptr failure(_failure);
+        _failure = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+auto Disk::stop_writer() -> void
+{
+    /* stop the writer once the pending write-back is done */ {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _signal.notify_all();
+    if(_writer.joinable()) {
+        _writer.join();
+    }
+}
+
+auto Disk::run_writer() -> void
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    Pending                      pending;
+    std::vector<uint8_t>         output;
+
+    auto next_task = [&]() -> bool
+    {
+        if(_pending.queued != false) {
+            _pending.queued = false;
+            pending.filename.swap(_pending.filename);
+            pending.compression = _pending.compression;
+            pending.size        = _pending.size;
+            pending.chunks.clear();
+            pending.chunks.swap(_pending.chunks);
+            return true;
+        }
+        return false;
+    };
+
+    auto write_task = [&]() -> void
+    {
+        try {
+            if(pending.compression != COMPRESSION_NONE) {
+                CompressTraits::compress(pending.compression, pending.chunks.front().data, output);
+                JournalTraits::replace(pending.filename, output);
+            }
+            else {
+                JournalTraits::commit(pending.filename, pending.size, pending.chunks);
+            }
+        }
+        catch(...) {
+            const std::lock_guard<std::mutex> guard(_mutex);
+            _failure = std::current_exception();
+        }
+    };
+
+    while(true) {
+        if(next_task() != false) {
+            _busy = true;
+            lock.unlock();
+            write_task();
+            lock.lock();
+            _busy = false;
+            _signal.notify_all();
+        }
+        else if(_running != false) {
+            _signal.wait(lock);
+        }
+        else {
+            break;
+        }
+    }
+}
+
 }
 
 // ---------------------------------------------------------------------------
@@ -465,6 +465,83 @@ public: // public interface
 
 }
 
+// ---------------------------------------------------------------------------
+// dsk::Compression
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+enum Compression
+{
+    COMPRESSION_NONE  = 0,
+    COMPRESSION_GZIP  = 1,
+    COMPRESSION_BZIP2 = 2,
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// dsk::Span
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+struct Span
+{
+    uint8_t* data;
+    size_t   size;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// dsk::Chunk
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+struct Chunk
+{
+    size_t               offset; /* offset of the chunk in the image */
+    std::vector<uint8_t> data;   /* bytes to write at that offset    */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// dsk::SectorIndex
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+struct SectorIndex
+{
+    uint8_t* info;   /* sector info (C, H, R, N, ST1, ST2, size) */
+    Span     data;   /* sector data, all copies of a weak sector */
+    size_t   length; /* length of one copy                      */
+    unsigned copies; /* number of copies                        */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// dsk::TrackIndex
+// ---------------------------------------------------------------------------
+
+namespace dsk {
+
+struct TrackIndex
+{
+    uint8_t*    info;       /* track info, nullptr if not formatted */
+    size_t      offset;     /* offset of the track in the image     */
+    size_t      length;     /* length of the track in the image     */
+    bool        dirty;      /* modified since the last flush        */
+    unsigned    count;      /* number of indexed sectors            */
+    SectorIndex sector[29]; /* indexed sectors                      */
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // dsk::Disk
 // ---------------------------------------------------------------------------
@@ -484,14 +561,102 @@ public: // public interface
 
     virtual void dump();
 
+    virtual void visit(Visitor& visitor);
+
     virtual void create();
 
     virtual void remove();
 
+    virtual void load(const bool readonly);
+
+    virtual void flush();
+
+    virtual void close();
+
+    static auto probe(const std::string& filename) -> bool;
+
+    auto get_filename() const -> const std::string&
+    {
+        return _filename;
+    }
+
+    auto is_loaded() const -> bool
+    {
+        return _loaded;
+    }
+
+    auto is_readonly() const -> bool
+    {
+        return _readonly;
+    }
+
+    auto is_dirty() const -> bool
+    {
+        return _dirty;
+    }
+
+    auto is_compressed() const -> bool
+    {
+        return _compression != COMPRESSION_NONE;
+    }
+
+    auto is_extended() const -> bool;
+
+    auto get_number_of_tracks() const -> unsigned;
+
+    auto get_number_of_sides() const -> unsigned;
+
+    auto get_track(const unsigned track, const unsigned side) -> TrackIndex*;
+
+    auto get_sector(TrackIndex& track, const uint8_t sector_id) -> SectorIndex*;
+
+    auto get_sector_data(SectorIndex& sector, const unsigned copy) -> Span;
+
+    auto set_sector_data(TrackIndex& track, SectorIndex& sector, const uint8_t* data, const size_t size) -> void;
+
+    auto format_track(const unsigned track, const unsigned side, const uint8_t* ids, const unsigned count, const uint8_t filler) -> bool;
+
+protected: // protected types
+    struct Pending
+    {
+        bool               queued;
+        std::string        filename;
+        Compression        compression;
+        size_t             size;
+        std::vector<Chunk> chunks;
+    };
+
+protected: // protected interface
+    auto build_index() -> void;
+
+    auto index_track(TrackIndex& track, const size_t offset, const size_t length) -> void;
+
+    auto write_back(const bool release) -> void;
+
+    auto wait_writer() -> void;
+
+    auto stop_writer() -> void;
+
+    auto run_writer() -> void;
+
 protected: // protected data
-    dsk::ImageRecord _image;
-    std::string      _filename;
-    int              _file;
+    dsk::ImageRecord        _image;
+    std::string             _filename;
+    int                     _file;
+    std::vector<uint8_t>    _bytes;
+    std::vector<TrackIndex> _index;
+    bool                    _loaded;
+    bool                    _readonly;
+    bool                    _dirty;
+    bool                    _resized;
+    Compression             _compression;
+    Pending                 _pending;
+    std::mutex              _mutex;
+    std::condition_variable _signal;
+    bool                    _running;
+    bool                    _busy;
+    std::thread             _writer;
+    std::exception_ptr      _failure;
 };
 
 }
@@ -0,0 +1,527 @@
+/*
+ * mov-format.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "mov-format.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::BasicTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BasicTraits
+{
+    using State     = mov::State;
+    using Header    = mov::Header;
+    using Recording = mov::Recording;
+    using Recorder  = mov::Recorder;
+    using Interface = mov::Interface;
+
+    static constexpr uint32_t MOV_VERSION     = 1;
+    static constexpr uint8_t  MOV_KEYBOARD    = 0x01;
+    static constexpr uint8_t  MOV_RESET       = 0x02;
+    static constexpr uint8_t  MOV_INSERT_DISK = 0x03;
+    static constexpr uint8_t  MOV_REMOVE_DISK = 0x04;
+    static constexpr uint8_t  MOV_END_OF_DATA = 0xff;
+
+    static const char ident[8];
+
+    static inline auto get_uint16(const uint8_t (&data)[2]) -> uint16_t
+    {
+        return (static_cast<uint16_t>(data[0]) << 0)
+             | (static_cast<uint16_t>(data[1]) << 8)
+             ;
+    }
+
+    static inline auto set_uint16(uint8_t (&data)[2], const uint16_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >> 0);
+        data[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static inline auto get_uint32(const uint8_t (&data)[4]) -> uint32_t
+    {
+        return (static_cast<uint32_t>(data[0]) <<  0)
+             | (static_cast<uint32_t>(data[1]) <<  8)
+             | (static_cast<uint32_t>(data[2]) << 16)
+             | (static_cast<uint32_t>(data[3]) << 24)
+             ;
+    }
+
+    static inline auto set_uint32(uint8_t (&data)[4], const uint32_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >>  0);
+        data[1] = static_cast<uint8_t>(value >>  8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+};
+
+constexpr uint8_t BasicTraits::MOV_KEYBOARD;
+constexpr uint8_t BasicTraits::MOV_RESET;
+constexpr uint8_t BasicTraits::MOV_INSERT_DISK;
+constexpr uint8_t BasicTraits::MOV_REMOVE_DISK;
+constexpr uint8_t BasicTraits::MOV_END_OF_DATA;
+
+const char BasicTraits::ident[8] = {
+    'X', 'C', 'P', 'C', '-', 'M', 'O', 'V'
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::StateTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct StateTraits final
+    : public BasicTraits
+{
+    static auto construct(State& state) -> void
+    {
+        auto init_header = [&]() -> void
+        {
+            static_cast<void>(::memset(&state.header, 0, sizeof(state.header)));
+            static_cast<void>(::memcpy(state.header.ident, ident, sizeof(state.header.ident)));
+            set_uint32(state.header.version, MOV_VERSION);
+        };
+
+        auto init_stream = [&]() -> void
+        {
+            state.drive0.clear();
+            state.drive1.clear();
+            state.machine.clear();
+            state.stream.clear();
+            state.cycles = 0;
+            state.offset = 0;
+        };
+
+        init_header();
+        init_stream();
+    }
+
+    static auto check(Header& header) -> void
+    {
+        if(::memcmp(header.ident, ident, sizeof(header.ident)) != 0) {
+            throw std::runtime_error("bad signature");
+        }
+        if(get_uint32(header.version) != MOV_VERSION) {
+            throw std::runtime_error("unsupported version");
+        }
+    }
+
+    static auto put_varint(State& state, uint64_t value) -> void
+    {
+        while(value >= 0x80) {
+            state.stream.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        state.stream.push_back(static_cast<uint8_t>(value));
+    }
+
+    static auto get_varint(const State& state, size_t& offset) -> uint64_t
+    {
+        uint64_t value = 0;
+        unsigned shift = 0;
+
+        while(true) {
+            if((offset >= state.stream.size()) || (shift >= 64)) {
+                throw std::runtime_error("unexpected end of stream");
+            }
+            const uint8_t byte = state.stream[offset++];
+            value |= (static_cast<uint64_t>(byte & 0x7f) << shift);
+            if((byte & 0x80) == 0) {
+                break;
+            }
+            shift += 7;
+        }
+        return value;
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Recording
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+Recording::Recording()
+    : _state()
+{
+    StateTraits::construct(_state);
+}
+
+auto Recording::load(const std::string& filename) -> void
+{
+    FILE*                file = nullptr;
+    std::vector<uint8_t> data;
+
+    auto file_open = [&]() -> void
+    {
+        if((file = ::fopen(filename.c_str(), "r")) == nullptr) {
+            throw std::runtime_error("unable to open movie for reading");
+        }
+    };
+
+    auto file_read = [&]() -> void
+    {
+        uint8_t buffer[4096];
+        size_t  count = 0;
+        while((count = ::fread(buffer, 1, sizeof(buffer), file)) != 0) {
+            data.insert(data.end(), buffer, buffer + count);
+        }
+        if(::ferror(file) != 0) {
+            throw std::runtime_error("unable to load movie");
+        }
+    };
+
+    auto file_close = [&]() -> void
+    {
+        if(file != nullptr) {
+            file = (static_cast<void>(::fclose(file)), nullptr);
+        }
+    };
+
+    auto parse = [&]() -> void
+    {
+        Header& header(_state.header);
+        size_t  offset = sizeof(header);
+
+        auto extract = [&](const size_t length) -> const uint8_t*
+        {
+            if((data.size() - offset) < length) {
+                throw std::runtime_error("unable to load movie header");
+            }
+            const uint8_t* bytes = data.data() + offset;
+            offset += length;
+            return bytes;
+        };
+
+        if(data.size() < sizeof(header)) {
+            throw std::runtime_error("unable to load movie header");
+        }
+        static_cast<void>(::memcpy(&header, data.data(), sizeof(header)));
+        StateTraits::check(header);
+        /* drives */ {
+            const size_t drive0_size = BasicTraits::get_uint16(header.drive0_size);
+            const size_t drive1_size = BasicTraits::get_uint16(header.drive1_size);
+            const char*  drive0 = reinterpret_cast<const char*>(extract(drive0_size));
+            const char*  drive1 = reinterpret_cast<const char*>(extract(drive1_size));
+            _state.drive0.assign(drive0, drive0_size);
+            _state.drive1.assign(drive1, drive1_size);
+        }
+        /* machine */ {
+            const size_t   machine_size = BasicTraits::get_uint32(header.machine_size);
+            const uint8_t* machine      = extract(machine_size);
+            _state.machine.assign(machine, machine + machine_size);
+        }
+        /* stream */ {
+            _state.stream.assign(data.begin() + offset, data.end());
+            _state.cycles = 0;
+            _state.offset = 0;
+        }
+    };
+
+    try {
+        file_open();
+        file_read();
+        file_close();
+        parse();
+    }
+    catch(...) {
+        file_close();
+        throw;
+    }
+}
+
+auto Recording::replay(Interface& interface, const uint64_t cycles) -> void
+{
+    const auto& stream(_state.stream);
+    const auto  length(stream.size());
+    size_t      offset(_state.offset);
+
+    auto fetch = [&]() -> uint8_t
+    {
+        if(offset >= length) {
+            throw std::runtime_error("unexpected end of stream");
+        }
+        return stream[offset++];
+    };
+
+    auto fetch_string = [&]() -> std::string
+    {
+        const uint64_t size = StateTraits::get_varint(_state, offset);
+        if((length - offset) < size) {
+            throw std::runtime_error("unexpected end of stream");
+        }
+        const char* string = reinterpret_cast<const char*>(stream.data() + offset);
+        offset += size;
+        return std::string(string, size);
+    };
+
+    auto keyboard = [&]() -> void
+    {
+        const uint8_t row   = fetch();
+        const uint8_t value = fetch();
+        interface.mov_keyboard(*this, (row & 0x0f), value);
+    };
+
+    auto insert_disk = [&]() -> void
+    {
+        const uint8_t     drive    = fetch();
+        const std::string filename = fetch_string();
+        interface.mov_insert_disk(*this, drive, filename);
+    };
+
+    auto remove_disk = [&]() -> void
+    {
+        const uint8_t drive = fetch();
+        interface.mov_remove_disk(*this, drive);
+    };
+
+    auto process = [&]() -> void
+    {
+        while(offset < length) {
+            const uint64_t timestamp = _state.cycles + StateTraits::get_varint(_state, offset);
+            if(timestamp > cycles) {
+                break;
+            }
+            const uint8_t opcode = fetch();
+            switch(opcode) {
+                case BasicTraits::MOV_KEYBOARD:
+                    keyboard();
+                    break;
+                case BasicTraits::MOV_RESET:
+                    interface.mov_reset(*this);
+                    break;
+                case BasicTraits::MOV_INSERT_DISK:
+                    insert_disk();
+                    break;
+                case BasicTraits::MOV_REMOVE_DISK:
+                    remove_disk();
+                    break;
+                case BasicTraits::MOV_END_OF_DATA:
+                    offset = length;
+                    break;
+                default:
+                    throw std::runtime_error("unsupported command");
+            }
+            _state.cycles = timestamp;
+            _state.offset = offset;
+        }
+    };
+
+    auto truncate = [&]() -> void
+    {
+        _state.offset = length;
+    };
+
+    try {
+        process();
+    }
+    catch(...) {
+        truncate();
+        throw;
+    }
+}
+
+auto Recording::finished() const -> bool
+{
+    return _state.offset >= _state.stream.size();
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Recorder
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+Recorder::Recorder(const std::string& filename, const std::string& drive0, const std::string& drive1, const uint8_t* machine, const size_t length, const uint64_t cycles)
+    : _file(nullptr)
+    , _state()
+{
+    StateTraits::construct(_state);
+
+    auto check = [&]() -> void
+    {
+        if((drive0.size() > 0xffff) || (drive1.size() > 0xffff)) {
+            throw std::runtime_error("invalid movie drive filename");
+        }
+        if(length > 0xffffffff) {
+            throw std::runtime_error("invalid movie machine state");
+        }
+    };
+
+    auto prepare = [&]() -> void
+    {
+        _state.drive0 = drive0;
+        _state.drive1 = drive1;
+        _state.cycles = cycles;
+        BasicTraits::set_uint32(_state.header.machine_size, static_cast<uint32_t>(length));
+        BasicTraits::set_uint16(_state.header.drive0_size, static_cast<uint16_t>(drive0.size()));
+        BasicTraits::set_uint16(_state.header.drive1_size, static_cast<uint16_t>(drive1.size()));
+    };
+
+    auto write = [&](const void* data, const size_t size) -> void
+    {
+        if(::fwrite(data, 1, size, _file) != size) {
+            _file = (::fclose(_file), nullptr);
+            throw std::runtime_error("unable to save movie header");
+        }
+    };
+
+    auto file_open = [&]() -> void
+    {
+        if((_file = ::fopen(filename.c_str(), "w")) == nullptr) {
+            throw std::runtime_error("unable to open movie for writing");
+        }
+    };
+
+    check();
+    prepare();
+    file_open();
+    write(&_state.header, sizeof(_state.header));
+    write(drive0.data(), drive0.size());
+    write(drive1.data(), drive1.size());
+    write(machine, length);
+    flush();
+}
+
+Recorder::~Recorder()
+{
+    try {
+        close(_state.cycles);
+    }
+    catch(...) {
+        if(_file != nullptr) {
+            _file = (::fclose(_file), nullptr);
+        }
+    }
+}
+
+auto Recorder::keyboard(const uint64_t cycles, const uint8_t row, const uint8_t value) -> void
+{
+    if(_file != nullptr) {
+        delay(cycles);
+        _state.stream.push_back(BasicTraits::MOV_KEYBOARD);
+        _state.stream.push_back(row & 0x0f);
+        _state.stream.push_back(value);
+        flush();
+    }
+}
+
+auto Recorder::reset(const uint64_t cycles) -> void
+{
+    if(_file != nullptr) {
+        delay(cycles);
+        _state.stream.push_back(BasicTraits::MOV_RESET);
+        flush();
+    }
+}
+
+auto Recorder::insert_disk(const uint64_t cycles, const uint8_t drive, const std::string& filename) -> void
+{
+    if(_file != nullptr) {
+        delay(cycles);
+        _state.stream.push_back(BasicTraits::MOV_INSERT_DISK);
+        _state.stream.push_back(drive);
+        StateTraits::put_varint(_state, filename.size());
+        _state.stream.insert(_state.stream.end(), filename.begin(), filename.end());
+        flush();
+    }
+}
+
+auto Recorder::remove_disk(const uint64_t cycles, const uint8_t drive) -> void
+{
+    if(_file != nullptr) {
+        delay(cycles);
+        _state.stream.push_back(BasicTraits::MOV_REMOVE_DISK);
+        _state.stream.push_back(drive);
+        flush();
+    }
+}
+
+auto Recorder::close(const uint64_t cycles) -> void
+{
+    auto finalize = [&]() -> void
+    {
+        delay(cycles);
+        _state.stream.push_back(BasicTraits::MOV_END_OF_DATA);
+        flush();
+    };
+
+    auto file_close = [&]() -> void
+    {
+        if(::fclose(_file) != 0) {
+            _file = nullptr;
+            throw std::runtime_error("unable to close movie");
+        }
+        _file = nullptr;
+    };
+
+    if(_file != nullptr) {
+        finalize();
+        file_close();
+    }
+}
+
+auto Recorder::delay(const uint64_t cycles) -> void
+{
+    const uint64_t elapsed = (cycles >= _state.cycles ? cycles - _state.cycles : 0);
+
+    StateTraits::put_varint(_state, elapsed);
+
+    _state.cycles += elapsed;
+}
+
+auto Recorder::flush() -> void
+{
+    const size_t size = _state.stream.size();
+
+    if(::fwrite(_state.stream.data(), 1, size, _file) != size) {
+        throw std::runtime_error("unable to save movie stream");
+    }
+    if(::fflush(_file) != 0) {
+        throw std::runtime_error("unable to save movie stream");
+    }
+    _state.stream.clear();
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
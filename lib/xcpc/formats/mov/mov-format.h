@@ -0,0 +1,176 @@
+/*
+ * mov-format.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_MOV_FORMAT_H__
+#define __XCPC_MOV_FORMAT_H__
+
+// ---------------------------------------------------------------------------
+// forward declarations
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+class Recording;
+class Recorder;
+class Interface;
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Header
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+struct Header
+{
+    uint8_t ident[8];
+    uint8_t version[4];
+    uint8_t machine_size[4];
+    uint8_t drive0_size[2];
+    uint8_t drive1_size[2];
+    uint8_t reserved[12];
+};
+
+static_assert(sizeof(Header) == 32UL);
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::State
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+struct State
+{
+    Header               header;
+    std::string          drive0;  /* disk in drive0 when recording started */
+    std::string          drive1;  /* disk in drive1 when recording started */
+    std::vector<uint8_t> machine; /* machine state when recording started  */
+    std::vector<uint8_t> stream;  /* cycle-stamped input events            */
+    uint64_t             cycles;  /* cycle of the last event               */
+    size_t               offset;  /* offset of the next event              */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Recording
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+class Recording
+{
+public: // public interface
+    Recording();
+
+    Recording(const Recording&) = delete;
+
+    Recording& operator=(const Recording&) = delete;
+
+    virtual ~Recording() = default;
+
+    auto load(const std::string& filename) -> void;
+
+    auto replay(Interface& interface, const uint64_t cycles) -> void;
+
+    auto finished() const -> bool;
+
+    auto operator->() -> State*
+    {
+        return &_state;
+    }
+
+private: // private data
+    State _state;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Recorder
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+class Recorder
+{
+public: // public interface
+    Recorder(const std::string& filename, const std::string& drive0, const std::string& drive1, const uint8_t* machine, const size_t length, const uint64_t cycles);
+
+    Recorder(const Recorder&) = delete;
+
+    Recorder& operator=(const Recorder&) = delete;
+
+    virtual ~Recorder();
+
+    auto keyboard(const uint64_t cycles, const uint8_t row, const uint8_t value) -> void;
+
+    auto reset(const uint64_t cycles) -> void;
+
+    auto insert_disk(const uint64_t cycles, const uint8_t drive, const std::string& filename) -> void;
+
+    auto remove_disk(const uint64_t cycles, const uint8_t drive) -> void;
+
+    auto close(const uint64_t cycles) -> void;
+
+private: // private interface
+    auto delay(const uint64_t cycles) -> void;
+
+    auto flush() -> void;
+
+private: // private data
+    FILE*    _file;
+    State    _state;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// mov::Interface
+// ---------------------------------------------------------------------------
+
+namespace mov {
+
+class Interface
+{
+public: // public interface
+    Interface() = default;
+
+    Interface(const Interface&) = default;
+
+    Interface& operator=(const Interface&) = default;
+
+    virtual ~Interface() = default;
+
+    virtual auto mov_keyboard(Recording& recording, uint8_t row, uint8_t value) -> void = 0;
+
+    virtual auto mov_reset(Recording& recording) -> void = 0;
+
+    virtual auto mov_insert_disk(Recording& recording, uint8_t drive, const std::string& filename) -> void = 0;
+
+    virtual auto mov_remove_disk(Recording& recording, uint8_t drive) -> void = 0;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_MOV_FORMAT_H__ */
@@ -29,6 +29,21 @@
 #include <vector>
 #include <iostream>
 #include <stdexcept>
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include "sna-format.h"
 
 // ---------------------------------------------------------------------------
@@ -42,6 +57,7 @@ struct BasicTraits
     using State          = sna::State;
     using Header         = sna::Header;
     using Memory         = sna::Memory;
+    using Chunk          = sna::Chunk;
     using Snapshot       = sna::Snapshot;
     using SnapshotReader = sna::SnapshotReader;
     using SnapshotWriter = sna::SnapshotWriter;
@@ -49,11 +65,49 @@ struct BasicTraits
     static constexpr uint8_t SNAPSHOT_VERSION_1 = 1;
     static constexpr uint8_t SNAPSHOT_VERSION_2 = 2;
     static constexpr uint8_t SNAPSHOT_VERSION_3 = 3;
+    static constexpr uint8_t SNAPSHOT_RLE_CODE  = 0xe5;
+    static constexpr size_t  SNAPSHOT_MEM_SIZE  = 65536;
+    static constexpr size_t  SNAPSHOT_MEM_COUNT = 8;
 
     static const char signature[8];
     static const char reserved[8];
+    static const char mem_chunk[3];
+
+    static inline auto get_uint32(const uint8_t (&data)[4]) -> uint32_t
+    {
+        return (static_cast<uint32_t>(data[0]) <<  0)
+             | (static_cast<uint32_t>(data[1]) <<  8)
+             | (static_cast<uint32_t>(data[2]) << 16)
+             | (static_cast<uint32_t>(data[3]) << 24)
+             ;
+    }
+
+    static inline auto set_uint32(uint8_t (&data)[4], const uint32_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >>  0);
+        data[1] = static_cast<uint8_t>(value >>  8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    static inline auto get_ram_size(const Header& header) -> size_t
+    {
+        return (static_cast<size_t>(header.ram_size_h) << 18)
+             | (static_cast<size_t>(header.ram_size_l) << 10)
+             ;
+    }
+
+    static inline auto set_ram_size(Header& header, const size_t ram_size) -> void
+    {
+        header.ram_size_h = static_cast<uint8_t>(ram_size >> 18);
+        header.ram_size_l = static_cast<uint8_t>(ram_size >> 10);
+    }
 };
 
+constexpr uint8_t BasicTraits::SNAPSHOT_RLE_CODE;
+constexpr size_t  BasicTraits::SNAPSHOT_MEM_SIZE;
+constexpr size_t  BasicTraits::SNAPSHOT_MEM_COUNT;
+
 const char BasicTraits::signature[8] = {
     'M', 'V', ' ', '-', ' ', 'S', 'N', 'A'
 };
@@ -62,6 +116,10 @@ const char BasicTraits::reserved[8] = {
     '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0'
 };
 
+const char BasicTraits::mem_chunk[3] = {
+    'M', 'E', 'M'
+};
+
 }
 
 // ---------------------------------------------------------------------------
@@ -106,6 +164,152 @@ struct StateTraits final
             throw std::runtime_error("bad version");
         }
     }
+
+    static auto memory_block(State& state, const size_t index) -> uint8_t*
+    {
+        return state.memory[index * (SNAPSHOT_MEM_SIZE / sizeof(Memory))].data;
+    }
+
+    static auto compress(const uint8_t* data, const size_t size, std::vector<uint8_t>& output) -> void
+    {
+        size_t offset = 0;
+
+        output.clear();
+        while(offset < size) {
+            const uint8_t value = data[offset];
+            size_t        count = 1;
+            while(((offset + count) < size) && (data[offset + count] == value) && (count < 255)) {
+                ++count;
+            }
+            if((count >= 3) || (value == SNAPSHOT_RLE_CODE)) {
+                if(count == 1) {
+                    output.push_back(SNAPSHOT_RLE_CODE);
+                    output.push_back(0x00);
+                }
+                else {
+                    output.push_back(SNAPSHOT_RLE_CODE);
+                    output.push_back(static_cast<uint8_t>(count));
+                    output.push_back(value);
+                }
+            }
+            else {
+                output.insert(output.end(), count, value);
+            }
+            offset += count;
+        }
+    }
+
+    static auto decompress(const uint8_t* data, const size_t size, uint8_t* output) -> void
+    {
+        const uint8_t* const data_end = data + size;
+        uint8_t*             out_iter = output;
+        uint8_t* const       out_end  = output + SNAPSHOT_MEM_SIZE;
+
+        while(data < data_end) {
+            const uint8_t value = *data++;
+            if(value != SNAPSHOT_RLE_CODE) {
+                if(out_iter == out_end) {
+                    throw std::runtime_error("bad snapshot memory chunk");
+                }
+                *out_iter++ = value;
+                continue;
+            }
+            if(data == data_end) {
+                throw std::runtime_error("bad snapshot memory chunk");
+            }
+            const size_t count = *data++;
+            if(count == 0) {
+                if(out_iter == out_end) {
+                    throw std::runtime_error("bad snapshot memory chunk");
+                }
+                *out_iter++ = SNAPSHOT_RLE_CODE;
+                continue;
+            }
+            if((data == data_end) || (static_cast<size_t>(out_end - out_iter) < count)) {
+                throw std::runtime_error("bad snapshot memory chunk");
+            }
+            out_iter = static_cast<uint8_t*>(::memset(out_iter, *data++, count)) + count;
+        }
+        if(out_iter != out_end) {
+            throw std::runtime_error("bad snapshot memory chunk");
+        }
+    }
+
+    static auto parse(State& state, const uint8_t* data, const size_t size) -> void
+    {
+        size_t offset   = 0;
+        size_t ram_size = 0;
+
+        auto extract = [&](const size_t length, const char* error) -> const uint8_t*
+        {
+            if((size - offset) < length) {
+                throw std::runtime_error(error);
+            }
+            const uint8_t* bytes = data + offset;
+            offset += length;
+            return bytes;
+        };
+
+        auto parse_header = [&]() -> void
+        {
+            static_cast<void>(::memcpy(&state.header, extract(sizeof(Header), "unable to load snapshot header"), sizeof(Header)));
+            check(state.header);
+        };
+
+        auto parse_dump = [&]() -> void
+        {
+            size_t remaining = get_ram_size(state.header);
+            for(auto& memory : state.memory) {
+                constexpr size_t memory_size = sizeof(memory.data);
+                if(remaining < memory_size) {
+                    break;
+                }
+                static_cast<void>(::memcpy(memory.data, extract(memory_size, "unable to load snapshot memory"), memory_size));
+                remaining -= memory_size;
+                ram_size  += memory_size;
+            }
+        };
+
+        auto parse_mem_chunk = [&](const Chunk& chunk, const uint8_t* bytes, const size_t length) -> void
+        {
+            const unsigned int index = (chunk.name[3] - '0');
+            if(index >= SNAPSHOT_MEM_COUNT) {
+                return; /* beyond the memory of the snapshot state */
+            }
+            uint8_t* block = memory_block(state, index);
+            if(length == SNAPSHOT_MEM_SIZE) {
+                static_cast<void>(::memcpy(block, bytes, length));
+            }
+            else {
+                decompress(bytes, length, block);
+            }
+            if(ram_size < ((index + 1) * SNAPSHOT_MEM_SIZE)) {
+                ram_size = ((index + 1) * SNAPSHOT_MEM_SIZE);
+            }
+        };
+
+        auto parse_chunks = [&]() -> void
+        {
+            if(state.header.version < SNAPSHOT_VERSION_3) {
+                return;
+            }
+            while((size - offset) >= sizeof(Chunk)) {
+                Chunk chunk;
+                static_cast<void>(::memcpy(&chunk, extract(sizeof(Chunk), "unable to load snapshot chunk"), sizeof(Chunk)));
+                const size_t   length = get_uint32(chunk.size);
+                const uint8_t* bytes  = extract(length, "unable to load snapshot chunk");
+                if((::memcmp(chunk.name, mem_chunk, sizeof(mem_chunk)) == 0) && (chunk.name[3] >= '0') && (chunk.name[3] <= '9')) {
+                    parse_mem_chunk(chunk, bytes, length);
+                }
+                /* other chunks (CPC+, ROMS, DSCA, ...) are skipped */
+            }
+        };
+
+        parse_header();
+        parse_dump();
+        parse_chunks();
+        set_ram_size(state.header, ram_size);
+    }
 };
 
 }
@@ -145,66 +349,79 @@ auto Snapshot::save(const std::string& filename) -> void
 namespace sna {
 
 SnapshotReader::SnapshotReader(const std::string& filename)
-    : _file(nullptr)
+    : _fd(-1)
+    , _data(nullptr)
+    , _size(0)
+    , _buffer()
 {
-    if((_file = ::fopen(filename.c_str(), "r")) == nullptr) {
-        throw std::runtime_error("unable to open snapshot for reading");
-    }
-}
-
-SnapshotReader::~SnapshotReader()
-{
-    if(_file != nullptr) {
-        _file = (::fclose(_file), nullptr);
-    }
-}
-
-auto SnapshotReader::load(Snapshot& snapshot) -> void
-{
-    auto load_check = [&](Header& header) -> void
+    auto file_open = [&]() -> void
     {
-        StateTraits::check(header);
+        if((_fd = ::open(filename.c_str(), O_RDONLY)) == -1) {
+            throw std::runtime_error("unable to open snapshot for reading");
+        }
     };
 
-    auto load_header = [&](Header& header) -> void
+    auto file_size = [&]() -> void
     {
-        constexpr size_t header_size = sizeof(header);
-        const     size_t byte_count  = ::fread(&header, 1, header_size, _file);
-
-        if(byte_count != header_size) {
-            throw std::runtime_error("unable to load snapshot header");
+        struct stat statbuf;
+        if(::fstat(_fd, &statbuf) != 0) {
+            throw std::runtime_error("unable to stat snapshot");
         }
+        _size = static_cast<size_t>(statbuf.st_size);
     };
 
-    auto load_memory = [&](Memory& memory) -> void
+    auto file_map = [&]() -> void
     {
-        constexpr size_t memory_size = sizeof(memory);
-        const     size_t byte_count  = ::fread(&memory, 1, memory_size, _file);
-
-        if(byte_count != memory_size) {
-            throw std::runtime_error("unable to load snapshot memory");
+#ifdef HAVE_SYS_MMAN_H
+        if(_size != 0) {
+            void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if(data != MAP_FAILED) {
+                _data = static_cast<const uint8_t*>(data);
+                return;
+            }
         }
+#endif
+        _buffer.resize(_size);
+        if(::read(_fd, _buffer.data(), _size) != static_cast<ssize_t>(_size)) {
+            throw std::runtime_error("unable to read snapshot");
+        }
+        _data = _buffer.data();
     };
 
-    load_check(snapshot->header);
-    load_header(snapshot->header);
-    load_check(snapshot->header);
-
-    size_t remaining_bytes = 0;
-    remaining_bytes |= ((static_cast<size_t>(snapshot->header.ram_size_h)) << 18);
-    remaining_bytes |= ((static_cast<size_t>(snapshot->header.ram_size_l)) << 10);
-    for(auto& memory : snapshot->memory) {
-        constexpr size_t memory_size = sizeof(memory.data);
-        if(remaining_bytes >= memory_size) {
-            load_memory(memory);
-            remaining_bytes -= memory_size;
-        }
-        else {
-            break;
+    auto file_close = [&]() -> void
+    {
+        if(_fd != -1) {
+            _fd = (static_cast<void>(::close(_fd)), -1);
         }
+    };
+
+    try {
+        file_open();
+        file_size();
+        file_map();
+        file_close();
+    }
+    catch(...) {
+        file_close();
+        throw;
     }
 }
 
+SnapshotReader::~SnapshotReader()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if((_data != nullptr) && (_data != _buffer.data())) {
+        static_cast<void>(::munmap(const_cast<uint8_t*>(_data), _size));
+    }
+#endif
+    _data = nullptr;
+}
+
+auto SnapshotReader::load(Snapshot& snapshot) -> void
+{
+    return StateTraits::parse(*snapshot.operator->(), _data, _size);
+}
+
 }
 
 // ---------------------------------------------------------------------------
@@ -230,47 +447,84 @@ SnapshotWriter::~SnapshotWriter()
 
 auto SnapshotWriter::save(Snapshot& snapshot) -> void
 {
+    std::vector<uint8_t> packed;
+
     auto save_check = [&](Header& header) -> void
     {
         StateTraits::check(header);
     };
 
-    auto save_header = [&](Header& header) -> void
+    auto save_bytes = [&](const void* data, const size_t size, const char* error) -> void
     {
-        constexpr size_t header_size = sizeof(header);
-        const     size_t byte_count  = ::fwrite(&header, 1, header_size, _file);
+        const size_t byte_count = ::fwrite(data, 1, size, _file);
 
-        if(byte_count != header_size) {
-            throw std::runtime_error("unable to save snapshot header");
+        if(byte_count != size) {
+            throw std::runtime_error(error);
         }
     };
 
+    auto save_header = [&](const Header& header) -> void
+    {
+        save_bytes(&header, sizeof(header), "unable to save snapshot header");
+    };
+
     auto save_memory = [&](Memory& memory) -> void
     {
-        constexpr size_t memory_size = sizeof(memory.data);
-        const     size_t byte_count  = ::fwrite(&memory.data, 1, memory_size, _file);
+        save_bytes(&memory.data, sizeof(memory.data), "unable to save snapshot memory");
+    };
 
-        if(byte_count != memory_size) {
-            throw std::runtime_error("unable to save snapshot memory");
+    auto save_chunk = [&](const size_t index) -> void
+    {
+        const uint8_t* block = StateTraits::memory_block(*snapshot.operator->(), index);
+        Chunk          chunk;
+
+        StateTraits::compress(block, BasicTraits::SNAPSHOT_MEM_SIZE, packed);
+        if(packed.size() >= BasicTraits::SNAPSHOT_MEM_SIZE) {
+            packed.assign(block, block + BasicTraits::SNAPSHOT_MEM_SIZE);
         }
+        static_cast<void>(::memcpy(chunk.name, BasicTraits::mem_chunk, sizeof(BasicTraits::mem_chunk)));
+        chunk.name[3] = static_cast<uint8_t>('0' + index);
+        BasicTraits::set_uint32(chunk.size, static_cast<uint32_t>(packed.size()));
+        save_bytes(&chunk, sizeof(chunk), "unable to save snapshot chunk");
+        save_bytes(packed.data(), packed.size(), "unable to save snapshot chunk");
     };
 
-    save_check(snapshot->header);
-    save_header(snapshot->header);
-    save_check(snapshot->header);
-
-    size_t remaining_bytes = 0;
-    remaining_bytes |= ((static_cast<size_t>(snapshot->header.ram_size_h)) << 18);
-    remaining_bytes |= ((static_cast<size_t>(snapshot->header.ram_size_l)) << 10);
-    for(auto& memory : snapshot->memory) {
-        constexpr size_t memory_size = sizeof(memory.data);
-        if(remaining_bytes >= memory_size) {
-            save_memory(memory);
-            remaining_bytes -= memory_size;
+    auto save_dump = [&]() -> void
+    {
+        size_t remaining_bytes = BasicTraits::get_ram_size(snapshot->header);
+        save_header(snapshot->header);
+        for(auto& memory : snapshot->memory) {
+            constexpr size_t memory_size = sizeof(memory.data);
+            if(remaining_bytes >= memory_size) {
+                save_memory(memory);
+                remaining_bytes -= memory_size;
+            }
+            else {
+                break;
+            }
         }
-        else {
-            break;
+    };
+
+    auto save_chunks = [&]() -> void
+    {
+        const size_t ram_size = BasicTraits::get_ram_size(snapshot->header);
+        Header       header(snapshot->header);
+
+        BasicTraits::set_ram_size(header, 0);
+        save_header(header);
+        for(size_t index = 0; index < BasicTraits::SNAPSHOT_MEM_COUNT; ++index) {
+            if((index * BasicTraits::SNAPSHOT_MEM_SIZE) < ram_size) {
+                save_chunk(index);
+            }
         }
+    };
+
+    save_check(snapshot->header);
+    if(snapshot->header.version >= BasicTraits::SNAPSHOT_VERSION_3) {
+        save_chunks();
+    }
+    else {
+        save_dump();
     }
 }
 
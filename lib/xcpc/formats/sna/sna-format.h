@@ -120,7 +120,8 @@ struct Header
     uint8_t psg_reg_15;
     uint8_t ram_size_l;
     uint8_t ram_size_h;
-    uint8_t padding[147];
+    uint8_t cpc_type;
+    uint8_t padding[146];
 };
 
 }
@@ -138,6 +139,22 @@ struct Memory
 
 }
 
+// ---------------------------------------------------------------------------
+// sna::Chunk
+// ---------------------------------------------------------------------------
+
+namespace sna {
+
+struct Chunk
+{
+    uint8_t name[4];
+    uint8_t size[4];
+};
+
+static_assert(sizeof(Chunk) == 8UL);
+
+}
+
 // ---------------------------------------------------------------------------
 // sna::State
 // ---------------------------------------------------------------------------
@@ -207,7 +224,10 @@ public: // public interface
     auto load(Snapshot& snapshot) -> void;
 
 private: // private data
-    FILE* _file;
+    int                  _fd;
+    const uint8_t*       _data;
+    size_t               _size;
+    std::vector<uint8_t> _buffer;
 };
 
 }
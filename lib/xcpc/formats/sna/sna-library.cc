@@ -0,0 +1,526 @@
+/*
+ * sna-library.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <xcpc/amstrad/vga/vga-core.h>
+#include "sna-format.h"
+#include "sna-library.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::BasicTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BasicTraits
+{
+    using Snapshot = sna::Snapshot;
+    using Header   = sna::Header;
+    using Preview  = sna::Preview;
+    using Library  = sna::Library;
+
+    static constexpr uint32_t INDEX_VERSION = 1;
+    static constexpr int      PIXEL_SCALE_X = 4; /* in high-resolution pixels */
+    static constexpr int      PIXEL_SCALE_Y = 2; /* in scanlines              */
+
+    static const char index_ident[8];
+
+    static auto is_snapshot(const std::string& filename) -> bool
+    {
+        const size_t length = filename.length();
+
+        if(length > 4) {
+            const char* extension = &filename[length - 4];
+            return (extension[0] == '.')
+                && (::tolower(extension[1]) == 's')
+                && (::tolower(extension[2]) == 'n')
+                && (::tolower(extension[3]) == 'a');
+        }
+        return false;
+    }
+
+    static auto get_status(const std::string& filename, Preview& preview) -> bool
+    {
+        struct stat statbuf;
+
+        if((::stat(filename.c_str(), &statbuf) == 0) && S_ISREG(statbuf.st_mode)) {
+            preview.mtime = static_cast<int64_t>(statbuf.st_mtime);
+            preview.size  = static_cast<uint64_t>(statbuf.st_size);
+            return true;
+        }
+        return false;
+    }
+
+    static auto make_directory(const std::string& dirname) -> bool
+    {
+        if((::mkdir(dirname.c_str(), 0755) != 0) && (errno != EEXIST)) {
+            return false;
+        }
+        return true;
+    }
+
+    static auto get_index() -> std::string
+    {
+        std::string dirname;
+
+        if(const char* cache = ::getenv("XDG_CACHE_HOME")) {
+            dirname = cache;
+        }
+        else if(const char* home = ::getenv("HOME")) {
+            dirname = std::string(home) + "/.cache";
+            if(make_directory(dirname) == false) {
+                return std::string();
+            }
+        }
+        if(dirname.empty() == false) {
+            dirname += "/xcpc";
+            if(make_directory(dirname) != false) {
+                return dirname + "/snapshots.idx";
+            }
+        }
+        return std::string();
+    }
+};
+
+constexpr uint32_t BasicTraits::INDEX_VERSION;
+constexpr int      BasicTraits::PIXEL_SCALE_X;
+constexpr int      BasicTraits::PIXEL_SCALE_Y;
+
+const char BasicTraits::index_ident[8] = {
+    'X', 'C', 'P', 'C', '-', 'I', 'D', 'X'
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::RenderTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct RenderTraits final
+    : public BasicTraits
+{
+    static auto clamp(const int value, const int minimum, const int maximum, const int fallback) -> int
+    {
+        if(value < minimum) {
+            return fallback;
+        }
+        if(value > maximum) {
+            return maximum;
+        }
+        return value;
+    }
+
+    /* the byte is decoded by the gate-array, the pixels are packed from the lsb */
+    static auto get_ink(const uint8_t bits, const int mode, const int pixel) -> uint8_t
+    {
+        switch(mode) {
+            case 1: /* 4 pixels of 4 colors per byte */
+                return ((bits >> ((pixel >> 1) * 2)) & 0x03);
+            case 2: /* 8 pixels of 2 colors per byte */
+                return ((bits >> pixel) & 0x01);
+            default: /* 2 pixels of 16 colors per byte */
+                return ((bits >> ((pixel >> 2) * 4)) & 0x0f);
+        }
+    }
+
+    static auto render(Snapshot& snapshot, Preview& preview) -> void
+    {
+        const Header& header  = snapshot->header;
+        const int     mode    = ((header.vga_config & 0x03) == 3 ? 0 : (header.vga_config & 0x03));
+        const int     cols    = clamp(header.vdc_reg_01, 1, 64, 40);
+        const int     rows    = clamp(header.vdc_reg_06, 1, 64, 25);
+        const int     rass    = (header.vdc_reg_09 & 0x07) + 1;
+        const int     width   = (cols * 16);
+        const int     height  = (rows * rass);
+        const int     start   = (((header.vdc_reg_12 << 8) | header.vdc_reg_13) & 0x3fff);
+        uint8_t               palette[16];
+        std::vector<uint8_t>  line(width);
+        std::vector<uint32_t> sums;
+
+        static_cast<void>(::memcpy(palette, &header.vga_ink_00, sizeof(palette)));
+
+        auto decode_line = [&](const int row, const int ras) -> void
+        {
+            const int address = start + (row * cols);
+            for(int x = 0; x < width; x += 8) {
+                const int col  = (x >> 4);
+                const int addr = ((address & 0x3000) << 2) | ((ras & 0x07) << 11) | (((address + col) & 0x03ff) << 1) | ((x >> 3) & 1);
+                const uint8_t byte = snapshot->memory[addr >> 14].data[addr & 0x3fff];
+                const uint8_t bits = vga::Instance::decode_byte(mode, byte);
+                for(int pixel = 0; pixel < 8; ++pixel) {
+                    line[x + pixel] = (palette[get_ink(bits, mode, pixel)] & 0x1f);
+                }
+            }
+        };
+
+        auto accumulate = [&](const int y) -> void
+        {
+            uint32_t* sum = &sums[(y / PIXEL_SCALE_Y) * preview.width * 3];
+            for(int x = 0; x < width; ++x) {
+                const vga::Color& color = vga::Instance::get_color(line[x]);
+                uint32_t*         pixel = &sum[(x / PIXEL_SCALE_X) * 3];
+                pixel[0] += (color.red   >> 8);
+                pixel[1] += (color.green >> 8);
+                pixel[2] += (color.blue  >> 8);
+            }
+        };
+
+        auto average = [&]() -> void
+        {
+            const uint32_t count = (PIXEL_SCALE_X * PIXEL_SCALE_Y);
+            preview.pixels.resize(sums.size());
+            for(size_t index = 0; index < sums.size(); ++index) {
+                preview.pixels[index] = static_cast<uint8_t>(sums[index] / count);
+            }
+        };
+
+        preview.version  = header.version;
+        preview.cpc_type = header.cpc_type;
+        preview.ram_size = static_cast<uint16_t>((header.ram_size_h << 8) | header.ram_size_l);
+        preview.width    = static_cast<uint16_t>(width  / PIXEL_SCALE_X);
+        preview.height   = static_cast<uint16_t>(height / PIXEL_SCALE_Y);
+        sums.assign(preview.width * preview.height * 3, 0);
+        for(int y = 0; y < (preview.height * PIXEL_SCALE_Y); ++y) {
+            decode_line((y / rass), (y % rass));
+            accumulate(y);
+        }
+        average();
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::IndexTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct IndexTraits final
+    : public BasicTraits
+{
+    static auto get_uint(FILE* file, const int bytes) -> uint64_t
+    {
+        uint8_t  buffer[8];
+        uint64_t value = 0;
+
+        if(::fread(buffer, bytes, 1, file) != 1) {
+            throw std::runtime_error("unexpected end of index");
+        }
+        for(int index = 0; index < bytes; ++index) {
+            value |= (static_cast<uint64_t>(buffer[index]) << (index * 8));
+        }
+        return value;
+    }
+
+    static auto put_uint(FILE* file, const int bytes, const uint64_t value) -> void
+    {
+        uint8_t buffer[8];
+
+        for(int index = 0; index < bytes; ++index) {
+            buffer[index] = static_cast<uint8_t>(value >> (index * 8));
+        }
+        if(::fwrite(buffer, bytes, 1, file) != 1) {
+            throw std::runtime_error("unable to write index");
+        }
+    }
+
+    static auto get_bytes(FILE* file, void* data, const size_t size) -> void
+    {
+        if((size != 0) && (::fread(data, size, 1, file) != 1)) {
+            throw std::runtime_error("unexpected end of index");
+        }
+    }
+
+    static auto put_bytes(FILE* file, const void* data, const size_t size) -> void
+    {
+        if((size != 0) && (::fwrite(data, size, 1, file) != 1)) {
+            throw std::runtime_error("unable to write index");
+        }
+    }
+
+    static auto read(FILE* file, std::map<std::string, Preview>& previews) -> void
+    {
+        char ident[8];
+
+        get_bytes(file, ident, sizeof(ident));
+        if(::memcmp(ident, index_ident, sizeof(ident)) != 0) {
+            throw std::runtime_error("bad index signature");
+        }
+        if(get_uint(file, 4) != INDEX_VERSION) {
+            throw std::runtime_error("bad index version");
+        }
+        for(uint64_t count = get_uint(file, 4); count != 0; --count) {
+            std::string filename(get_uint(file, 2), '\0');
+            Preview     preview;
+            get_bytes(file, &filename[0], filename.size());
+            preview.mtime    = static_cast<int64_t>(get_uint(file, 8));
+            preview.size     = get_uint(file, 8);
+            preview.version  = static_cast<uint8_t>(get_uint(file, 1));
+            preview.cpc_type = static_cast<uint8_t>(get_uint(file, 1));
+            preview.ram_size = static_cast<uint16_t>(get_uint(file, 2));
+            preview.width    = static_cast<uint16_t>(get_uint(file, 2));
+            preview.height   = static_cast<uint16_t>(get_uint(file, 2));
+            preview.pixels.resize(preview.width * preview.height * 3);
+            get_bytes(file, preview.pixels.data(), preview.pixels.size());
+            previews[filename] = std::move(preview);
+        }
+    }
+
+    static auto write(FILE* file, const std::map<std::string, Preview>& previews) -> void
+    {
+        put_bytes(file, index_ident, sizeof(index_ident));
+        put_uint(file, 4, INDEX_VERSION);
+        put_uint(file, 4, previews.size());
+        for(auto& entry : previews) {
+            const std::string& filename(entry.first);
+            const Preview&     preview(entry.second);
+            put_uint(file, 2, filename.size());
+            put_bytes(file, filename.data(), filename.size());
+            put_uint(file, 8, static_cast<uint64_t>(preview.mtime));
+            put_uint(file, 8, preview.size);
+            put_uint(file, 1, preview.version);
+            put_uint(file, 1, preview.cpc_type);
+            put_uint(file, 2, preview.ram_size);
+            put_uint(file, 2, preview.width);
+            put_uint(file, 2, preview.height);
+            put_bytes(file, preview.pixels.data(), preview.pixels.size());
+        }
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// sna::Library
+// ---------------------------------------------------------------------------
+
+namespace sna {
+
+Library::Library(const std::string& directory)
+    : _directory(directory)
+    , _index(BasicTraits::get_index())
+    , _mutex()
+    , _previews()
+    , _running(false)
+    , _ready(false)
+    , _dirty(false)
+    , _thread()
+{
+}
+
+Library::~Library()
+{
+    try {
+        stop();
+    }
+    catch(...) {
+        /* nothing to do */
+    }
+}
+
+auto Library::start() -> void
+{
+    if(_thread.joinable() == false) {
+        _running.store(true, std::memory_order_release);
+        _thread = std::thread([this]() -> void { scan(); });
+    }
+}
+
+auto Library::stop() -> void
+{
+    if(_thread.joinable()) {
+        _running.store(false, std::memory_order_release);
+        _thread.join();
+    }
+    save_index();
+}
+
+auto Library::lookup(const std::string& filename, Preview& preview) -> bool
+{
+    Preview current;
+
+    if(BasicTraits::get_status(filename, current) == false) {
+        return false;
+    }
+    /* lookup the index */ {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        auto entry = _previews.find(filename);
+        if((entry != _previews.end())
+        && (entry->second.mtime == current.mtime)
+        && (entry->second.size  == current.size)) {
+            preview = entry->second;
+            return true;
+        }
+    }
+    try {
+        std::unique_ptr<Snapshot> snapshot(new Snapshot);
+        snapshot->load(filename);
+        render(*snapshot, current);
+    }
+    catch(...) {
+        return false;
+    }
+    /* update the index */ {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _previews[filename] = current;
+        _dirty = true;
+    }
+    preview = std::move(current);
+    return true;
+}
+
+auto Library::render(Snapshot& snapshot, Preview& preview) -> void
+{
+    return RenderTraits::render(snapshot, preview);
+}
+
+auto Library::scan() -> void
+{
+    std::vector<std::string> filenames;
+
+    auto list_directory = [&]() -> void
+    {
+        DIR* dir = ::opendir(_directory.c_str());
+
+        if(dir != nullptr) {
+            struct dirent* entry = nullptr;
+            while((entry = ::readdir(dir)) != nullptr) {
+                const std::string entry_name(entry->d_name);
+                if(BasicTraits::is_snapshot(entry_name)) {
+                    filenames.push_back(_directory + '/' + entry_name);
+                }
+            }
+            dir = (::closedir(dir), nullptr);
+        }
+    };
+
+    auto index_files = [&]() -> void
+    {
+        Preview preview;
+        for(auto& filename : filenames) {
+            if(_running.load(std::memory_order_acquire) == false) {
+                break;
+            }
+            static_cast<void>(lookup(filename, preview));
+        }
+    };
+
+    auto prune_index = [&]() -> void
+    {
+        Preview preview;
+        const std::lock_guard<std::mutex> lock(_mutex);
+        for(auto entry = _previews.begin(); entry != _previews.end();) {
+            if(BasicTraits::get_status(entry->first, preview) == false) {
+                entry  = _previews.erase(entry);
+                _dirty = true;
+            }
+            else {
+                ++entry;
+            }
+        }
+    };
+
+    load_index();
+    list_directory();
+    index_files();
+    prune_index();
+    save_index();
+    _ready.store(true, std::memory_order_release);
+}
+
+auto Library::load_index() -> void
+{
+    std::map<std::string, Preview> previews;
+    FILE* file = nullptr;
+
+    if(_index.empty() || ((file = ::fopen(_index.c_str(), "rb")) == nullptr)) {
+        return;
+    }
+    try {
+        IndexTraits::read(file, previews);
+    }
+    catch(...) {
+        previews.clear();
+    }
+    file = (static_cast<void>(::fclose(file)), nullptr);
+    /* merge with the entries found meanwhile */ {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        for(auto& entry : _previews) {
+            previews[entry.first] = std::move(entry.second);
+        }
+        _previews.swap(previews);
+    }
+}
+
+auto Library::save_index() -> void
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const std::string temporary(_index + ".tmp");
+    FILE* file = nullptr;
+
+    if(_index.empty() || (_dirty == false)) {
+        return;
+    }
+    if((file = ::fopen(temporary.c_str(), "wb")) == nullptr) {
+        return;
+    }
+    try {
+        IndexTraits::write(file, _previews);
+    }
+    catch(...) {
+        file = (static_cast<void>(::fclose(file)), nullptr);
+        static_cast<void>(::remove(temporary.c_str()));
+        return;
+    }
+    if(::fclose(file) != 0) {
+        static_cast<void>(::remove(temporary.c_str()));
+        return;
+    }
+    if(::rename(temporary.c_str(), _index.c_str()) == 0) {
+        _dirty = false;
+    }
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
@@ -0,0 +1,100 @@
+/*
+ * sna-library.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_SNA_LIBRARY_H__
+#define __XCPC_SNA_LIBRARY_H__
+
+#include <map>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <xcpc/formats/sna/sna-format.h>
+
+// ---------------------------------------------------------------------------
+// sna::Preview
+// ---------------------------------------------------------------------------
+
+namespace sna {
+
+struct Preview
+{
+    int64_t              mtime;    /* modification time of the snapshot */
+    uint64_t             size;     /* size of the snapshot in bytes     */
+    uint8_t              version;  /* snapshot version                  */
+    uint8_t              cpc_type; /* 0: cpc464, 1: cpc664, 2: cpc6128  */
+    uint16_t             ram_size; /* ram size in KB                    */
+    uint16_t             width;    /* thumbnail width                   */
+    uint16_t             height;   /* thumbnail height                  */
+    std::vector<uint8_t> pixels;   /* thumbnail pixels (packed RGB)     */
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// sna::Library
+// ---------------------------------------------------------------------------
+
+namespace sna {
+
+class Library
+{
+public: // public interface
+    Library(const std::string& directory);
+
+    Library(const Library&) = delete;
+
+    Library& operator=(const Library&) = delete;
+
+    virtual ~Library();
+
+    auto start() -> void;
+
+    auto stop() -> void;
+
+    auto lookup(const std::string& filename, Preview& preview) -> bool;
+
+    auto ready() const -> bool
+    {
+        return _ready.load(std::memory_order_acquire);
+    }
+
+    static auto render(Snapshot& snapshot, Preview& preview) -> void;
+
+private: // private interface
+    auto scan() -> void;
+
+    auto load_index() -> void;
+
+    auto save_index() -> void;
+
+private: // private data
+    const std::string              _directory;
+    const std::string              _index;
+    std::mutex                     _mutex;
+    std::map<std::string, Preview> _previews;
+    std::atomic<bool>              _running;
+    std::atomic<bool>              _ready;
+    bool                           _dirty;
+    std::thread                    _thread;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_SNA_LIBRARY_H__ */
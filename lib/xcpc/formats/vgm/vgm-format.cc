@@ -0,0 +1,450 @@
+/*
+ * vgm-format.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "vgm-format.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::BasicTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BasicTraits
+{
+    using State     = vgm::State;
+    using Header    = vgm::Header;
+    using Recording = vgm::Recording;
+    using Recorder  = vgm::Recorder;
+    using Interface = vgm::Interface;
+
+    static constexpr uint32_t VGM_VERSION      = 0x00000151;
+    static constexpr uint32_t VGM_SAMPLE_RATE  = 44100;
+    static constexpr size_t   VGM_BUFFER_SIZE  = 65536;
+    static constexpr uint8_t  VGM_AY8910_WRITE = 0xa0;
+    static constexpr uint8_t  VGM_WAIT_NNNN    = 0x61;
+    static constexpr uint8_t  VGM_WAIT_735     = 0x62;
+    static constexpr uint8_t  VGM_WAIT_882     = 0x63;
+    static constexpr uint8_t  VGM_END_OF_DATA  = 0x66;
+    static constexpr uint8_t  VGM_WAIT_N       = 0x70;
+
+    static const char ident[4];
+
+    static inline auto get_uint32(const uint8_t (&data)[4]) -> uint32_t
+    {
+        return (static_cast<uint32_t>(data[0]) <<  0)
+             | (static_cast<uint32_t>(data[1]) <<  8)
+             | (static_cast<uint32_t>(data[2]) << 16)
+             | (static_cast<uint32_t>(data[3]) << 24)
+             ;
+    }
+
+    static inline auto set_uint32(uint8_t (&data)[4], const uint32_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >>  0);
+        data[1] = static_cast<uint8_t>(value >>  8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+};
+
+constexpr uint8_t BasicTraits::VGM_AY8910_WRITE;
+constexpr uint8_t BasicTraits::VGM_WAIT_NNNN;
+constexpr uint8_t BasicTraits::VGM_WAIT_735;
+constexpr uint8_t BasicTraits::VGM_WAIT_882;
+constexpr uint8_t BasicTraits::VGM_END_OF_DATA;
+constexpr uint8_t BasicTraits::VGM_WAIT_N;
+
+const char BasicTraits::ident[4] = {
+    'V', 'g', 'm', ' '
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::StateTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct StateTraits final
+    : public BasicTraits
+{
+    static auto construct(State& state, const uint32_t clock, const uint8_t chip) -> void
+    {
+        auto init_header = [&]() -> void
+        {
+            static_cast<void>(::memset(&state.header, 0, sizeof(state.header)));
+            static_cast<void>(::memcpy(state.header.ident, ident, sizeof(state.header.ident)));
+            set_uint32(state.header.eof_offset, sizeof(state.header) - 4);
+            set_uint32(state.header.version, VGM_VERSION);
+            set_uint32(state.header.data_offset, sizeof(state.header) - 0x34);
+            set_uint32(state.header.ay8910_clock, clock);
+            state.header.ay8910_type  = chip;
+            state.header.ay8910_flags = 0x01;
+        };
+
+        auto init_stream = [&]() -> void
+        {
+            state.stream.clear();
+        };
+
+        init_header();
+        init_stream();
+    }
+
+    static auto check(Header& header) -> void
+    {
+        if(::memcmp(header.ident, ident, sizeof(header.ident)) != 0) {
+            throw std::runtime_error("bad signature");
+        }
+        if(get_uint32(header.ay8910_clock) == 0) {
+            throw std::runtime_error("no ay8910 stream");
+        }
+    }
+
+    static auto delay(State& state, uint64_t samples) -> void
+    {
+        auto& stream(state.stream);
+
+        while(samples != 0) {
+            if(samples == 735) {
+                stream.push_back(VGM_WAIT_735);
+                samples -= 735;
+            }
+            else if(samples == 882) {
+                stream.push_back(VGM_WAIT_882);
+                samples -= 882;
+            }
+            else if(samples <= 16) {
+                stream.push_back(VGM_WAIT_N | static_cast<uint8_t>(samples - 1));
+                samples -= samples;
+            }
+            else {
+                const uint64_t count = (samples < 65535 ? samples : 65535);
+                stream.push_back(VGM_WAIT_NNNN);
+                stream.push_back(static_cast<uint8_t>(count >> 0));
+                stream.push_back(static_cast<uint8_t>(count >> 8));
+                samples -= count;
+            }
+        }
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Recording
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+Recording::Recording()
+    : _state()
+{
+    StateTraits::construct(_state, 0, CHIP_AY8910);
+}
+
+auto Recording::load(const std::string& filename) -> void
+{
+    FILE*                file = nullptr;
+    std::vector<uint8_t> data;
+
+    auto file_open = [&]() -> void
+    {
+        if((file = ::fopen(filename.c_str(), "r")) == nullptr) {
+            throw std::runtime_error("unable to open recording for reading");
+        }
+    };
+
+    auto file_read = [&]() -> void
+    {
+        uint8_t buffer[4096];
+        size_t  count = 0;
+        while((count = ::fread(buffer, 1, sizeof(buffer), file)) != 0) {
+            data.insert(data.end(), buffer, buffer + count);
+        }
+        if(::ferror(file) != 0) {
+            throw std::runtime_error("unable to load recording");
+        }
+    };
+
+    auto file_close = [&]() -> void
+    {
+        if(file != nullptr) {
+            file = (static_cast<void>(::fclose(file)), nullptr);
+        }
+    };
+
+    auto parse = [&]() -> void
+    {
+        Header& header(_state.header);
+        size_t  data_beg = 0x40;
+        size_t  data_end = data.size();
+
+        if(data.size() < data_beg) {
+            throw std::runtime_error("unable to load recording header");
+        }
+        static_cast<void>(::memset(&header, 0, sizeof(header)));
+        static_cast<void>(::memcpy(&header, data.data(), (data.size() < sizeof(header) ? data.size() : sizeof(header))));
+        if((BasicTraits::get_uint32(header.version) >= 0x150) && (BasicTraits::get_uint32(header.data_offset) != 0)) {
+            data_beg = 0x34 + BasicTraits::get_uint32(header.data_offset);
+        }
+        if(BasicTraits::get_uint32(header.version) < 0x151) {
+            static_cast<void>(::memset(header.ay8910_clock, 0, sizeof(header.ay8910_clock)));
+        }
+        if(data_beg < sizeof(header)) {
+            static_cast<void>(::memset(reinterpret_cast<uint8_t*>(&header) + data_beg, 0, sizeof(header) - data_beg));
+        }
+        if((BasicTraits::get_uint32(header.gd3_offset) != 0) && ((0x14 + BasicTraits::get_uint32(header.gd3_offset)) < data_end)) {
+            data_end = 0x14 + BasicTraits::get_uint32(header.gd3_offset);
+        }
+        if(data_beg > data_end) {
+            throw std::runtime_error("unable to load recording stream");
+        }
+        StateTraits::check(header);
+        _state.stream.assign(data.begin() + data_beg, data.begin() + data_end);
+    };
+
+    try {
+        file_open();
+        file_read();
+        file_close();
+        parse();
+    }
+    catch(...) {
+        file_close();
+        throw;
+    }
+}
+
+auto Recording::replay(Interface& interface) -> void
+{
+    const auto& stream(_state.stream);
+    const auto  length(stream.size());
+    size_t      offset(0);
+
+    auto fetch = [&]() -> uint8_t
+    {
+        if(offset >= length) {
+            throw std::runtime_error("unexpected end of stream");
+        }
+        return stream[offset++];
+    };
+
+    auto ay8910_write = [&]() -> void
+    {
+        const uint8_t index = fetch();
+        const uint8_t value = fetch();
+        if((index & 0x80) == 0) {
+            interface.vgm_write(*this, index, value);
+        }
+    };
+
+    auto wait_nnnn = [&]() -> void
+    {
+        const uint8_t lsb = fetch();
+        const uint8_t msb = fetch();
+        interface.vgm_delay(*this, ((static_cast<uint32_t>(msb) << 8) | lsb));
+    };
+
+    auto process = [&]() -> void
+    {
+        while(offset < length) {
+            const uint8_t opcode = fetch();
+            switch(opcode) {
+                case BasicTraits::VGM_AY8910_WRITE:
+                    ay8910_write();
+                    break;
+                case BasicTraits::VGM_WAIT_NNNN:
+                    wait_nnnn();
+                    break;
+                case BasicTraits::VGM_WAIT_735:
+                    interface.vgm_delay(*this, 735);
+                    break;
+                case BasicTraits::VGM_WAIT_882:
+                    interface.vgm_delay(*this, 882);
+                    break;
+                case BasicTraits::VGM_END_OF_DATA:
+                    return;
+                default:
+                    if((opcode & 0xf0) != BasicTraits::VGM_WAIT_N) {
+                        throw std::runtime_error("unsupported command");
+                    }
+                    interface.vgm_delay(*this, ((opcode & 0x0f) + 1));
+                    break;
+            }
+        }
+    };
+
+    return process();
+}
+
+auto Recording::get_clock() const -> uint32_t
+{
+    return BasicTraits::get_uint32(_state.header.ay8910_clock);
+}
+
+auto Recording::get_chip() const -> uint8_t
+{
+    return _state.header.ay8910_type;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Recorder
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+Recorder::Recorder(const std::string& filename, const uint32_t clock, const uint8_t chip, const uint32_t timestamp)
+    : _file(nullptr)
+    , _state()
+    , _clock(clock)
+    , _ticks(timestamp)
+    , _elapsed(0)
+    , _samples(0)
+    , _written(0)
+{
+    StateTraits::construct(_state, clock, chip);
+
+    if(_clock == 0) {
+        throw std::runtime_error("invalid recording clock");
+    }
+    if((_file = ::fopen(filename.c_str(), "w")) == nullptr) {
+        throw std::runtime_error("unable to open recording for writing");
+    }
+    if(::fwrite(&_state.header, 1, sizeof(_state.header), _file) != sizeof(_state.header)) {
+        _file = (::fclose(_file), nullptr);
+        throw std::runtime_error("unable to save recording header");
+    }
+    _state.stream.reserve(BasicTraits::VGM_BUFFER_SIZE);
+}
+
+Recorder::~Recorder()
+{
+    try {
+        close(_ticks);
+    }
+    catch(...) {
+        if(_file != nullptr) {
+            _file = (::fclose(_file), nullptr);
+        }
+    }
+}
+
+auto Recorder::write(const uint32_t timestamp, const uint8_t index, const uint8_t value) -> void
+{
+    if(_file == nullptr) {
+        return;
+    }
+    delay(timestamp);
+    _state.stream.push_back(BasicTraits::VGM_AY8910_WRITE);
+    _state.stream.push_back(index & 0x7f);
+    _state.stream.push_back(value);
+    if(_state.stream.size() >= BasicTraits::VGM_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+auto Recorder::rebase(const uint32_t timestamp, const uint32_t new_timestamp) -> void
+{
+    if(_file != nullptr) {
+        delay(timestamp);
+        _ticks = new_timestamp;
+    }
+}
+
+auto Recorder::close(const uint32_t timestamp) -> void
+{
+    auto finalize = [&]() -> void
+    {
+        delay(timestamp);
+        _state.stream.push_back(BasicTraits::VGM_END_OF_DATA);
+        flush();
+    };
+
+    auto update_header = [&]() -> void
+    {
+        BasicTraits::set_uint32(_state.header.eof_offset, static_cast<uint32_t>(sizeof(_state.header) + _written - 4));
+        BasicTraits::set_uint32(_state.header.total_samples, static_cast<uint32_t>(_samples));
+        if(::fseek(_file, 0, SEEK_SET) != 0) {
+            throw std::runtime_error("unable to update recording header");
+        }
+        if(::fwrite(&_state.header, 1, sizeof(_state.header), _file) != sizeof(_state.header)) {
+            throw std::runtime_error("unable to update recording header");
+        }
+    };
+
+    auto file_close = [&]() -> void
+    {
+        if(::fclose(_file) != 0) {
+            _file = nullptr;
+            throw std::runtime_error("unable to close recording");
+        }
+        _file = nullptr;
+    };
+
+    if(_file != nullptr) {
+        finalize();
+        update_header();
+        file_close();
+    }
+}
+
+auto Recorder::delay(const uint32_t timestamp) -> void
+{
+    _elapsed += static_cast<uint32_t>(timestamp - _ticks);
+    _ticks    = timestamp;
+
+    const uint64_t samples = ((_elapsed * BasicTraits::VGM_SAMPLE_RATE) / _clock);
+
+    StateTraits::delay(_state, samples - _samples);
+
+    _samples = samples;
+}
+
+auto Recorder::flush() -> void
+{
+    const size_t size = _state.stream.size();
+
+    if(::fwrite(_state.stream.data(), 1, size, _file) != size) {
+        throw std::runtime_error("unable to save recording stream");
+    }
+    _written += size;
+    _state.stream.clear();
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
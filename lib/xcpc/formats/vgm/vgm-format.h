@@ -0,0 +1,197 @@
+/*
+ * vgm-format.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_VGM_FORMAT_H__
+#define __XCPC_VGM_FORMAT_H__
+
+// ---------------------------------------------------------------------------
+// forward declarations
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+class Recording;
+class Recorder;
+class Interface;
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Chip
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+enum Chip
+{
+    CHIP_AY8910 = 0x00,
+    CHIP_AY8912 = 0x01,
+    CHIP_AY8913 = 0x02,
+    CHIP_YM2149 = 0x10,
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Header
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+struct Header
+{
+    uint8_t ident[4];
+    uint8_t eof_offset[4];
+    uint8_t version[4];
+    uint8_t sn76489_clock[4];
+    uint8_t ym2413_clock[4];
+    uint8_t gd3_offset[4];
+    uint8_t total_samples[4];
+    uint8_t loop_offset[4];
+    uint8_t loop_samples[4];
+    uint8_t rate[4];
+    uint8_t reserved1[12];
+    uint8_t data_offset[4];
+    uint8_t reserved2[60];
+    uint8_t ay8910_clock[4];
+    uint8_t ay8910_type;
+    uint8_t ay8910_flags;
+    uint8_t reserved3[6];
+};
+
+static_assert(sizeof(Header) == 128UL);
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::State
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+struct State
+{
+    Header               header;
+    std::vector<uint8_t> stream;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Recording
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+class Recording
+{
+public: // public interface
+    Recording();
+
+    Recording(const Recording&) = delete;
+
+    Recording& operator=(const Recording&) = delete;
+
+    virtual ~Recording() = default;
+
+    auto load(const std::string& filename) -> void;
+
+    auto replay(Interface& interface) -> void;
+
+    auto get_clock() const -> uint32_t;
+
+    auto get_chip() const -> uint8_t;
+
+    auto operator->() -> State*
+    {
+        return &_state;
+    }
+
+private: // private data
+    State _state;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Recorder
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+class Recorder
+{
+public: // public interface
+    Recorder(const std::string& filename, const uint32_t clock, const uint8_t chip, const uint32_t timestamp);
+
+    Recorder(const Recorder&) = delete;
+
+    Recorder& operator=(const Recorder&) = delete;
+
+    virtual ~Recorder();
+
+    auto write(const uint32_t timestamp, const uint8_t index, const uint8_t value) -> void;
+
+    auto rebase(const uint32_t timestamp, const uint32_t new_timestamp) -> void;
+
+    auto close(const uint32_t timestamp) -> void;
+
+private: // private interface
+    auto delay(const uint32_t timestamp) -> void;
+
+    auto flush() -> void;
+
+private: // private data
+    FILE*    _file;
+    State    _state;
+    uint32_t _clock;
+    uint32_t _ticks;
+    uint64_t _elapsed;
+    uint64_t _samples;
+    uint64_t _written;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// vgm::Interface
+// ---------------------------------------------------------------------------
+
+namespace vgm {
+
+class Interface
+{
+public: // public interface
+    Interface() = default;
+
+    Interface(const Interface&) = default;
+
+    Interface& operator=(const Interface&) = default;
+
+    virtual ~Interface() = default;
+
+    virtual auto vgm_delay(Recording& recording, uint32_t samples) -> void = 0;
+
+    virtual auto vgm_write(Recording& recording, uint8_t index, uint8_t value) -> void = 0;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_VGM_FORMAT_H__ */
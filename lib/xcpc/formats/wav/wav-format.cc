@@ -0,0 +1,352 @@
+/*
+ * wav-format.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include "wav-format.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::BasicTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BasicTraits
+{
+    using Format      = wav::Format;
+    using Header      = wav::Header;
+    using WaveWriter  = wav::WaveWriter;
+    using WaveCapture = wav::WaveCapture;
+
+    static constexpr size_t   WAV_QUEUE_FRAMES = 131072;
+    static constexpr uint32_t WAV_POLL_DELAY   = 10;
+
+    static inline auto set_uint16(uint8_t (&data)[2], const uint16_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >> 0);
+        data[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static inline auto set_uint32(uint8_t (&data)[4], const uint32_t value) -> void
+    {
+        data[0] = static_cast<uint8_t>(value >>  0);
+        data[1] = static_cast<uint8_t>(value >>  8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    static inline auto get_sample_size(const Format format) -> uint16_t
+    {
+        switch(format) {
+            case Format::FORMAT_PCM16:
+                return 2;
+            case Format::FORMAT_FLT32:
+                return 4;
+            default:
+                break;
+        }
+        throw std::runtime_error("invalid wave format");
+    }
+};
+
+constexpr uint32_t BasicTraits::WAV_POLL_DELAY;
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::HeaderTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct HeaderTraits final
+    : public BasicTraits
+{
+    static auto construct(Header& header, const Format format, const uint16_t channels, const uint32_t sample_rate) -> void
+    {
+        const uint16_t sample_size = get_sample_size(format);
+        const uint16_t block_align = (channels * sample_size);
+
+        static_cast<void>(::memcpy(header.riff_id, "RIFF", sizeof(header.riff_id)));
+        static_cast<void>(::memcpy(header.wave_id, "WAVE", sizeof(header.wave_id)));
+        static_cast<void>(::memcpy(header.fmt_id , "fmt ", sizeof(header.fmt_id )));
+        static_cast<void>(::memcpy(header.data_id, "data", sizeof(header.data_id)));
+        set_uint32(header.riff_size, sizeof(header) - 8);
+        set_uint32(header.fmt_size, 16);
+        set_uint16(header.format_tag, format);
+        set_uint16(header.channels, channels);
+        set_uint32(header.sample_rate, sample_rate);
+        set_uint32(header.byte_rate, sample_rate * block_align);
+        set_uint16(header.block_align, block_align);
+        set_uint16(header.bits_per_sample, sample_size * 8);
+        set_uint32(header.data_size, 0);
+    }
+
+    static auto update(Header& header, const uint64_t data_size) -> void
+    {
+        set_uint32(header.riff_size, static_cast<uint32_t>(sizeof(header) - 8 + data_size));
+        set_uint32(header.data_size, static_cast<uint32_t>(data_size));
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// wav::WaveWriter
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+WaveWriter::WaveWriter(const std::string& filename, const Format format, const uint16_t channels, const uint32_t sample_rate)
+    : _file(nullptr)
+    , _header()
+    , _format(format)
+    , _channels(channels)
+    , _written(0)
+    , _buffer()
+{
+    HeaderTraits::construct(_header, format, channels, sample_rate);
+
+    if((_file = ::fopen(filename.c_str(), "w")) == nullptr) {
+        throw std::runtime_error("unable to open wave for writing");
+    }
+    if(::fwrite(&_header, 1, sizeof(_header), _file) != sizeof(_header)) {
+        _file = (::fclose(_file), nullptr);
+        throw std::runtime_error("unable to save wave header");
+    }
+}
+
+WaveWriter::~WaveWriter()
+{
+    try {
+        close();
+    }
+    catch(...) {
+        if(_file != nullptr) {
+            _file = (::fclose(_file), nullptr);
+        }
+    }
+}
+
+auto WaveWriter::write(const float* samples, const size_t count) -> void
+{
+    const size_t length = (count * _channels);
+
+    auto convert_pcm16 = [&]() -> void
+    {
+        _buffer.resize(length * 2);
+        uint8_t* data = _buffer.data();
+        for(size_t index = 0; index < length; ++index) {
+            float value = samples[index];
+            if(value < -1.0f) {
+                value = -1.0f;
+            }
+            if(value > +1.0f) {
+                value = +1.0f;
+            }
+            const int16_t sample = static_cast<int16_t>(value * 32767.0f);
+            *data++ = static_cast<uint8_t>(static_cast<uint16_t>(sample) >> 0);
+            *data++ = static_cast<uint8_t>(static_cast<uint16_t>(sample) >> 8);
+        }
+    };
+
+    auto convert_flt32 = [&]() -> void
+    {
+        _buffer.resize(length * 4);
+        uint8_t* data = _buffer.data();
+        for(size_t index = 0; index < length; ++index) {
+            uint32_t sample = 0;
+            static_cast<void>(::memcpy(&sample, &samples[index], sizeof(sample)));
+            *data++ = static_cast<uint8_t>(sample >>  0);
+            *data++ = static_cast<uint8_t>(sample >>  8);
+            *data++ = static_cast<uint8_t>(sample >> 16);
+            *data++ = static_cast<uint8_t>(sample >> 24);
+        }
+    };
+
+    auto convert = [&]() -> void
+    {
+        switch(_format) {
+            case Format::FORMAT_PCM16:
+                convert_pcm16();
+                break;
+            case Format::FORMAT_FLT32:
+                convert_flt32();
+                break;
+            default:
+                throw std::runtime_error("invalid wave format");
+        }
+    };
+
+    auto output = [&]() -> void
+    {
+        const size_t size = _buffer.size();
+        if(::fwrite(_buffer.data(), 1, size, _file) != size) {
+            throw std::runtime_error("unable to save wave data");
+        }
+        _written += size;
+    };
+
+    if(_file != nullptr) {
+        convert();
+        output();
+    }
+}
+
+auto WaveWriter::close() -> void
+{
+    auto update_header = [&]() -> void
+    {
+        HeaderTraits::update(_header, _written);
+        if(::fseek(_file, 0, SEEK_SET) != 0) {
+            throw std::runtime_error("unable to update wave header");
+        }
+        if(::fwrite(&_header, 1, sizeof(_header), _file) != sizeof(_header)) {
+            throw std::runtime_error("unable to update wave header");
+        }
+    };
+
+    auto file_close = [&]() -> void
+    {
+        if(::fclose(_file) != 0) {
+            _file = nullptr;
+            throw std::runtime_error("unable to close wave");
+        }
+        _file = nullptr;
+    };
+
+    if(_file != nullptr) {
+        update_header();
+        file_close();
+    }
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// wav::WaveCapture
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+WaveCapture::WaveCapture(const std::string& filename, const Format format, const uint16_t channels, const uint32_t sample_rate)
+    : _writer(filename, format, channels, sample_rate)
+    , _channels(channels)
+    , _queue(BasicTraits::WAV_QUEUE_FRAMES * channels)
+    , _rd_index(0)
+    , _wr_index(0)
+    , _dropped(0)
+    , _running(true)
+    , _failure()
+    , _thread()
+{
+    _thread = std::thread([this]() -> void { loop(); });
+}
+
+WaveCapture::~WaveCapture()
+{
+    try {
+        close();
+    }
+    catch(...) {
+        /* nothing to do */
+    }
+}
+
+auto WaveCapture::push(const float* samples, const size_t count) -> void
+{
+    const uint64_t length   = (count * _channels);
+    const uint64_t capacity = _queue.size();
+    const uint64_t rd_index = _rd_index.load(std::memory_order_acquire);
+    const uint64_t wr_index = _wr_index.load(std::memory_order_relaxed);
+
+    if((capacity - (wr_index - rd_index)) < length) {
+        _dropped.fetch_add(count, std::memory_order_relaxed);
+        return;
+    }
+    for(uint64_t index = 0; index < length; ++index) {
+        _queue[(wr_index + index) % capacity] = samples[index];
+    }
+    _wr_index.store(wr_index + length, std::memory_order_release);
+}
+
+auto WaveCapture::close() -> void
+{
+    if(_thread.joinable()) {
+        _running.store(false, std::memory_order_release);
+        _thread.join();
+        _writer.close();
+    }
+    if(_failure) {
+        std::exception_ptr failure(_failure);
+        _failure = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+auto WaveCapture::drain() -> void
+{
+    const uint64_t capacity = _queue.size();
+    const uint64_t wr_index = _wr_index.load(std::memory_order_acquire);
+    uint64_t       rd_index = _rd_index.load(std::memory_order_relaxed);
+
+    while(rd_index != wr_index) {
+        const uint64_t offset = (rd_index % capacity);
+        uint64_t       length = (wr_index - rd_index);
+        if(length > (capacity - offset)) {
+            length = (capacity - offset);
+        }
+        _writer.write(&_queue[offset], (length / _channels));
+        rd_index += length;
+        _rd_index.store(rd_index, std::memory_order_release);
+    }
+}
+
+auto WaveCapture::loop() -> void
+{
+    try {
+        while(_running.load(std::memory_order_acquire)) {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(BasicTraits::WAV_POLL_DELAY));
+        }
+        drain();
+    }
+    catch(...) {
+        _failure = std::current_exception();
+    }
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
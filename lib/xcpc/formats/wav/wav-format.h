@@ -0,0 +1,146 @@
+/*
+ * wav-format.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_WAV_FORMAT_H__
+#define __XCPC_WAV_FORMAT_H__
+
+#include <atomic>
+#include <thread>
+#include <exception>
+
+// ---------------------------------------------------------------------------
+// wav::Format
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+enum Format
+{
+    FORMAT_PCM16 = 1,
+    FORMAT_FLT32 = 3,
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// wav::Header
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+struct Header
+{
+    uint8_t riff_id[4];
+    uint8_t riff_size[4];
+    uint8_t wave_id[4];
+    uint8_t fmt_id[4];
+    uint8_t fmt_size[4];
+    uint8_t format_tag[2];
+    uint8_t channels[2];
+    uint8_t sample_rate[4];
+    uint8_t byte_rate[4];
+    uint8_t block_align[2];
+    uint8_t bits_per_sample[2];
+    uint8_t data_id[4];
+    uint8_t data_size[4];
+};
+
+static_assert(sizeof(Header) == 44UL);
+
+}
+
+// ---------------------------------------------------------------------------
+// wav::WaveWriter
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+class WaveWriter
+{
+public: // public interface
+    WaveWriter(const std::string& filename, const Format format, const uint16_t channels, const uint32_t sample_rate);
+
+    WaveWriter(const WaveWriter&) = delete;
+
+    WaveWriter& operator=(const WaveWriter&) = delete;
+
+    virtual ~WaveWriter();
+
+    auto write(const float* samples, const size_t count) -> void;
+
+    auto close() -> void;
+
+private: // private data
+    FILE*                _file;
+    Header               _header;
+    Format               _format;
+    uint16_t             _channels;
+    uint64_t             _written;
+    std::vector<uint8_t> _buffer;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// wav::WaveCapture
+// ---------------------------------------------------------------------------
+
+namespace wav {
+
+class WaveCapture
+{
+public: // public interface
+    WaveCapture(const std::string& filename, const Format format, const uint16_t channels, const uint32_t sample_rate);
+
+    WaveCapture(const WaveCapture&) = delete;
+
+    WaveCapture& operator=(const WaveCapture&) = delete;
+
+    virtual ~WaveCapture();
+
+    auto push(const float* samples, const size_t count) -> void;
+
+    auto close() -> void;
+
+    auto get_dropped() const -> uint64_t
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private: // private interface
+    auto drain() -> void;
+
+    auto loop() -> void;
+
+private: // private data
+    WaveWriter            _writer;
+    uint16_t              _channels;
+    std::vector<float>    _queue;
+    std::atomic<uint64_t> _rd_index;
+    std::atomic<uint64_t> _wr_index;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool>     _running;
+    std::exception_ptr    _failure;
+    std::thread           _thread;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_WAV_FORMAT_H__ */
@@ -17,6 +17,7 @@
 #ifndef __XCPC_LIBXCPC_CXX_H__
 #define __XCPC_LIBXCPC_CXX_H__
 
+#include <condition_variable>
 #include <xcpc/libxcpc.h>
 #include <miniaudio/miniaudio.h>
 
@@ -271,6 +272,239 @@ public: // public interface
 
 }
 
+// ---------------------------------------------------------------------------
+// xcpc::Buffer
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+class Buffer
+{
+public: // public interface
+    Buffer();
+
+    Buffer(const Buffer&) = default;
+
+    Buffer& operator=(const Buffer&) = default;
+
+    virtual ~Buffer() = default;
+
+    auto clear() -> void;
+
+    auto reserve(const size_t capacity) -> void;
+
+    auto append(const size_t length) -> uint8_t*;
+
+    auto write(const void* data, const size_t length) -> void;
+
+    auto peek(size_t& offset, const size_t length) const -> const uint8_t*;
+
+    auto read(size_t& offset, void* data, const size_t length) const -> void;
+
+    auto shrink() -> void;
+
+    auto data() -> uint8_t*
+    {
+        return _bytes.data();
+    }
+
+    auto data() const -> const uint8_t*
+    {
+        return _bytes.data();
+    }
+
+    auto size() const -> size_t
+    {
+        return _size;
+    }
+
+    auto capacity() const -> size_t
+    {
+        return _bytes.capacity();
+    }
+
+protected: // protected data
+    std::vector<uint8_t> _bytes;
+    size_t               _size;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::RewindRing
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+class RewindRing
+{
+public: // public interface
+    RewindRing();
+
+    RewindRing(const RewindRing&) = delete;
+
+    RewindRing& operator=(const RewindRing&) = delete;
+
+    virtual ~RewindRing() = default;
+
+    auto resize(const size_t length) -> void;
+
+    auto clear() -> void;
+
+    auto push(const Buffer& state) -> void;
+
+    auto pop(Buffer& state) -> bool;
+
+    auto memory() const -> size_t;
+
+    auto length() const -> size_t
+    {
+        return _slots.size();
+    }
+
+    auto count() const -> size_t
+    {
+        return _count;
+    }
+
+    auto head() const -> size_t
+    {
+        return _head;
+    }
+
+protected: // protected data
+    std::vector<Buffer> _slots;
+    Buffer              _state;
+    size_t              _head;
+    size_t              _count;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::SaveSlots
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+struct SlotIdentity
+{
+    uint32_t machine_type; /* machine model            */
+    uint32_t memory_size;  /* memory size              */
+    uint64_t rom_digest;   /* digest of the loaded roms */
+};
+
+class SaveSlots
+{
+public: // public interface
+    SaveSlots();
+
+    SaveSlots(const SaveSlots&) = delete;
+
+    SaveSlots& operator=(const SaveSlots&) = delete;
+
+    virtual ~SaveSlots();
+
+    auto store(const unsigned slot, const SlotIdentity& identity, const Buffer& state) -> void;
+
+    auto fetch(const unsigned slot, const SlotIdentity& identity, Buffer& state) -> bool;
+
+    auto flush() -> void;
+
+    static constexpr unsigned SLOT_COUNT = 10;
+
+protected: // protected types
+    struct Pending
+    {
+        bool                 queued;
+        std::string          filename;
+        std::vector<uint8_t> bytes;
+    };
+
+protected: // protected interface
+    auto get_filename(const unsigned slot) -> std::string;
+
+    auto run_writer() -> void;
+
+protected: // protected data
+    Buffer                  _slots[SLOT_COUNT];
+    Pending                 _pending[SLOT_COUNT];
+    std::string             _directory;
+    std::mutex              _mutex;
+    std::condition_variable _signal;
+    bool                    _running;
+    bool                    _busy;
+    std::thread             _writer;
+    std::exception_ptr      _failure;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::Hash64
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+class Hash64
+{
+public: // public interface
+    Hash64(const uint64_t seed = 0);
+
+    Hash64(const Hash64&) = default;
+
+    Hash64& operator=(const Hash64&) = default;
+
+    virtual ~Hash64() = default;
+
+    auto reset(const uint64_t seed) -> void;
+
+    auto update(const void* data, const size_t length) -> void;
+
+    auto digest() const -> uint64_t;
+
+protected: // protected data
+    uint64_t _lanes[4];
+    uint64_t _seed;
+    uint64_t _total;
+    uint8_t  _block[32];
+    size_t   _count;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::Codec
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+class Codec
+{
+public: // public interface
+    using Bytes = std::vector<uint8_t>;
+
+    static constexpr size_t CHUNK_SIZE = 65536;
+
+    static auto is_gzip(const uint8_t* data, const size_t size) -> bool;
+
+    static auto is_bzip2(const uint8_t* data, const size_t size) -> bool;
+
+    static auto has_gzip() -> bool;
+
+    static auto has_bzip2() -> bool;
+
+    static auto gzip_compress(const uint8_t* input, const size_t size, Bytes& output, const int level = -1) -> void;
+
+    static auto gzip_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit = SIZE_MAX) -> void;
+
+    static auto bzip2_compress(const uint8_t* input, const size_t size, Bytes& output) -> void;
+
+    static auto bzip2_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit = SIZE_MAX) -> void;
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // xcpc::MonoFrame<T>
 // ---------------------------------------------------------------------------
@@ -358,6 +592,10 @@ public: // public interface
 
     AudioDevice(const AudioConfig& config);
 
+    explicit AudioDevice(const bool enabled);
+
+    AudioDevice(const AudioConfig& config, const bool enabled);
+
     AudioDevice(const AudioDevice&) = delete;
 
     AudioDevice& operator=(const AudioDevice&) = delete;
@@ -382,7 +620,18 @@ public: // public interface
         return get();
     }
 
+    auto is_headless() const -> bool
+    {
+        return _enabled == false;
+    }
+
+    auto is_enabled() const -> bool
+    {
+        return _enabled;
+    }
+
 private: // private data
+    const bool      _enabled;
     MiniAudioDevice _impl;
     AudioProcessor* _processor;
 };
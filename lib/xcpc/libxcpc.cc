@@ -29,8 +29,17 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBBZ2
+#include <bzlib.h>
+#endif
+#include <libdsk/libdsk.h>
 #include "libxcpc-priv.h"
 
 // ---------------------------------------------------------------------------
@@ -484,6 +493,13 @@ struct libxcpc_traits
         if(library.joystick1 != nullptr) { library.joystick1 = (::free(library.joystick1), nullptr); }
     }
 
+    static auto init_geometries(XcpcLibrary& library) -> void
+    {
+        /* libdsk loads its custom geometries lazily, load them before any thread does */ {
+            static_cast<void>(::dg_stdformat(nullptr, FMT_180K, nullptr, nullptr));
+        }
+    }
+
     static auto begin(XcpcLibrary& library) -> void
     {
         if(library.initialized++ == 0) {
@@ -491,6 +507,7 @@ struct libxcpc_traits
             init_streams(library);
             init_directories(library);
             init_joysticks(library);
+            init_geometries(library);
         }
     }
 
@@ -1204,6 +1221,1008 @@ auto Utils::memory_size_to_string(const MemorySize value) -> std::string
 
 }
 
+// ---------------------------------------------------------------------------
+// xcpc::Buffer
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+Buffer::Buffer()
+    : _bytes()
+    , _size(0)
+{
+}
+
+auto Buffer::clear() -> void
+{
+    _size = 0;
+}
+
+auto Buffer::reserve(const size_t capacity) -> void
+{
+    if(_bytes.size() < capacity) {
+        _bytes.resize(capacity);
+    }
+}
+
+auto Buffer::append(const size_t length) -> uint8_t*
+{
+    const size_t offset = _size;
+
+    if((_bytes.size() - _size) < length) {
+        _bytes.resize(_size + length);
+    }
+    _size += length;
+
+    return _bytes.data() + offset;
+}
+
+auto Buffer::write(const void* data, const size_t length) -> void
+{
+    static_cast<void>(::memcpy(append(length), data, length));
+}
+
+auto Buffer::peek(size_t& offset, const size_t length) const -> const uint8_t*
+{
+    if((offset > _size) || ((_size - offset) < length)) {
+        throw std::runtime_error("buffer underflow");
+    }
+    const uint8_t* bytes = _bytes.data() + offset;
+
+    offset += length;
+
+    return bytes;
+}
+
+auto Buffer::read(size_t& offset, void* data, const size_t length) const -> void
+{
+    static_cast<void>(::memcpy(data, peek(offset, length), length));
+}
+
+auto Buffer::shrink() -> void
+{
+    _bytes.resize(_size);
+    _bytes.shrink_to_fit();
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::RewindTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct RewindTraits
+{
+    static constexpr size_t RUN_MAX   = 0xffff; /* longest run of a token       */
+    static constexpr size_t RUN_QUIET = 4;      /* unchanged bytes ending a run */
+
+    /*
+     * a delta is a sequence of tokens, each one made of the count of
+     * unchanged bytes to skip, the count of changed bytes, then the
+     * changed bytes xor'ed with their previous value. xor being its own
+     * inverse, the same delta moves the state forward or backward.
+     */
+
+    static auto put_count(xcpc::Buffer& delta, const size_t count) -> void
+    {
+        const uint16_t value = static_cast<uint16_t>(count);
+
+        delta.write(&value, sizeof(value));
+    }
+
+    static auto get_count(const uint8_t* data) -> size_t
+    {
+        uint16_t value = 0;
+
+        static_cast<void>(::memcpy(&value, data, sizeof(value)));
+
+        return value;
+    }
+
+    static auto encode(uint8_t* prev, const uint8_t* next, const size_t size, xcpc::Buffer& delta) -> void
+    {
+        auto is_quiet = [&](const size_t index) -> bool
+        {
+            const size_t limit = ((size - index) > RUN_QUIET ? index + RUN_QUIET : size);
+
+            for(size_t at = index; at < limit; ++at) {
+                if(prev[at] != next[at]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto count_unchanged = [&](size_t index) -> size_t
+        {
+            const size_t start = index;
+            const size_t limit = ((size - start) > RUN_MAX ? start + RUN_MAX : size);
+
+            while((index + sizeof(uint64_t)) <= limit) {
+                uint64_t prev_word = 0;
+                uint64_t next_word = 0;
+                static_cast<void>(::memcpy(&prev_word, &prev[index], sizeof(uint64_t)));
+                static_cast<void>(::memcpy(&next_word, &next[index], sizeof(uint64_t)));
+                if(prev_word != next_word) {
+                    break;
+                }
+                index += sizeof(uint64_t);
+            }
+            while((index < limit) && (prev[index] == next[index])) {
+                ++index;
+            }
+            return index - start;
+        };
+
+        auto count_changed = [&](size_t index) -> size_t
+        {
+            const size_t start = index;
+            const size_t limit = ((size - start) > RUN_MAX ? start + RUN_MAX : size);
+
+            while((index < limit) && ((prev[index] != next[index]) || !is_quiet(index))) {
+                ++index;
+            }
+            return index - start;
+        };
+
+        size_t index = 0;
+        delta.clear();
+        while(index < size) {
+            const size_t skipped = count_unchanged(index);
+            const size_t changed = count_changed(index + skipped);
+            put_count(delta, skipped);
+            put_count(delta, changed);
+            index += skipped;
+            uint8_t* bytes = delta.append(changed);
+            for(size_t count = 0; count < changed; ++count, ++index) {
+                bytes[count] = prev[index] ^ next[index];
+                prev[index]  = next[index];
+            }
+        }
+    }
+
+    static auto decode(uint8_t* state, const size_t size, const xcpc::Buffer& delta) -> void
+    {
+        const uint8_t* bytes  = delta.data();
+        size_t         offset = 0;
+        size_t         index  = 0;
+
+        while((offset + 4) <= delta.size()) {
+            const size_t skipped = get_count(&bytes[offset + 0]);
+            const size_t changed = get_count(&bytes[offset + 2]);
+            offset += 4;
+            index  += skipped;
+            if(((index + changed) > size) || ((offset + changed) > delta.size())) {
+                throw std::runtime_error("corrupted rewind delta");
+            }
+            for(size_t count = 0; count < changed; ++count) {
+                state[index++] ^= bytes[offset++];
+            }
+        }
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::RewindRing
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+RewindRing::RewindRing()
+    : _slots()
+    , _state()
+    , _head(0)
+    , _count(0)
+{
+}
+
+auto RewindRing::resize(const size_t length) -> void
+{
+    _slots.clear();
+    _slots.resize(length);
+    _state.clear();
+    _state.shrink();
+    _head  = 0;
+    _count = 0;
+}
+
+auto RewindRing::clear() -> void
+{
+    _state.clear();
+    _head  = 0;
+    _count = 0;
+}
+
+auto RewindRing::push(const Buffer& state) -> void
+{
+    const size_t length = _slots.size();
+
+    if(length == 0) {
+        return;
+    }
+    if(_state.size() != state.size()) {
+        _state.clear();
+        _state.write(state.data(), state.size());
+        _head  = 0;
+        _count = 0;
+        return;
+    }
+    Buffer& delta(_slots[_head]);
+    RewindTraits::encode(_state.data(), state.data(), state.size(), delta);
+    if(delta.capacity() > ((delta.size() * 2) + 4096)) {
+        delta.shrink();
+    }
+    _head = (_head + 1) % length;
+    if(_count < length) {
+        ++_count;
+    }
+}
+
+auto RewindRing::pop(Buffer& state) -> bool
+{
+    const size_t length = _slots.size();
+
+    if(_count == 0) {
+        return false;
+    }
+    _head = (_head + length - 1) % length;
+    --_count;
+    RewindTraits::decode(_state.data(), _state.size(), _slots[_head]);
+    state.clear();
+    state.write(_state.data(), _state.size());
+
+    return true;
+}
+
+auto RewindRing::memory() const -> size_t
+{
+    size_t total = _state.capacity();
+
+    for(auto& slot : _slots) {
+        total += slot.capacity();
+    }
+    return total;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::SlotTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct SlotTraits
+{
+    using Bytes        = std::vector<uint8_t>;
+    using Buffer       = xcpc::Buffer;
+    using Codec        = xcpc::Codec;
+    using SlotIdentity = xcpc::SlotIdentity;
+
+    static constexpr uint8_t  SLOT_MAGIC[8] = { 'X', 'C', 'P', 'C', 'S', 'L', 'O', 'T' };
+    static constexpr uint32_t SLOT_VERSION  = 1;
+    static constexpr size_t   SLOT_HEADER   = 32;
+
+    static auto put_u32(uint8_t* bytes, const uint32_t value) -> void
+    {
+        for(unsigned index = 0; index < 4; ++index) {
+            bytes[index] = static_cast<uint8_t>(value >> (index * 8));
+        }
+    }
+
+    static auto put_u64(uint8_t* bytes, const uint64_t value) -> void
+    {
+        for(unsigned index = 0; index < 8; ++index) {
+            bytes[index] = static_cast<uint8_t>(value >> (index * 8));
+        }
+    }
+
+    static auto get_u32(const uint8_t* bytes) -> uint32_t
+    {
+        uint32_t value = 0;
+        for(unsigned index = 0; index < 4; ++index) {
+            value |= static_cast<uint32_t>(bytes[index]) << (index * 8);
+        }
+        return value;
+    }
+
+    static auto get_u64(const uint8_t* bytes) -> uint64_t
+    {
+        uint64_t value = 0;
+        for(unsigned index = 0; index < 8; ++index) {
+            value |= static_cast<uint64_t>(bytes[index]) << (index * 8);
+        }
+        return value;
+    }
+
+    /*
+     * a slot is a header followed by the machine state:
+     *
+     *   magic "XCPCSLOT", version (u32), machine type (u32),
+     *   memory size (u32), reserved (u32), rom digest (u64)
+     */
+
+    static auto put_header(Buffer& buffer, const SlotIdentity& identity) -> void
+    {
+        uint8_t* header = buffer.append(SLOT_HEADER);
+
+        static_cast<void>(::memcpy(&header[0], SLOT_MAGIC, sizeof(SLOT_MAGIC)));
+        put_u32(&header[ 8], SLOT_VERSION);
+        put_u32(&header[12], identity.machine_type);
+        put_u32(&header[16], identity.memory_size);
+        put_u32(&header[20], 0);
+        put_u64(&header[24], identity.rom_digest);
+    }
+
+    static auto check_header(const Buffer& buffer, const SlotIdentity& identity) -> void
+    {
+        const uint8_t* header = buffer.data();
+
+        if((buffer.size() < SLOT_HEADER) || (::memcmp(&header[0], SLOT_MAGIC, sizeof(SLOT_MAGIC)) != 0)) {
+            throw std::runtime_error("the save slot is not a valid slot");
+        }
+        if(get_u32(&header[8]) != SLOT_VERSION) {
+            throw std::runtime_error("the save slot has an unsupported version");
+        }
+        if((get_u32(&header[12]) != identity.machine_type)
+        || (get_u32(&header[16]) != identity.memory_size)
+        || (get_u64(&header[24]) != identity.rom_digest)) {
+            throw std::runtime_error("the save slot was saved by a different machine or with different roms");
+        }
+    }
+
+    static auto make_directory(const std::string& dirname) -> void
+    {
+        if((::mkdir(dirname.c_str(), 0755) != 0) && (errno != EEXIST)) {
+            throw std::runtime_error(std::string("unable to create") + ' ' + '<' + dirname + '>');
+        }
+    }
+
+    static auto get_directory() -> std::string
+    {
+        std::string dirname;
+
+        const char* data = ::getenv("XDG_DATA_HOME");
+        const char* home = ::getenv("HOME");
+
+        if((data != nullptr) && (*data != '\0')) {
+            make_directory(dirname = data);
+        }
+        else if((home != nullptr) && (*home != '\0')) {
+            dirname = home;
+            make_directory(dirname += "/.local");
+            make_directory(dirname += "/share");
+        }
+        else {
+            throw std::runtime_error("unable to locate the save slots directory");
+        }
+        make_directory(dirname += "/xcpc");
+        make_directory(dirname += "/slots");
+
+        return dirname;
+    }
+
+    /* slots favour speed over size, they are rewritten on every quick-save */
+    static auto compress(const Bytes& input, Bytes& output) -> void
+    {
+        if(Codec::has_gzip() == false) {
+            return output.assign(input.data(), input.data() + input.size());
+        }
+        return Codec::gzip_compress(input.data(), input.size(), output, 1);
+    }
+
+    static auto decompress(const Bytes& input, Bytes& output) -> void
+    {
+        if(Codec::is_gzip(input.data(), input.size()) == false) {
+            output = input;
+            return;
+        }
+        return Codec::gzip_decompress(input.data(), input.size(), output);
+    }
+
+    static auto read_file(const std::string& filename, Bytes& bytes) -> bool
+    {
+        FILE* file = ::fopen(filename.c_str(), "rb");
+
+        if(file == nullptr) {
+            return false;
+        }
+        bytes.clear();
+        while(true) {
+            uint8_t      chunk[4096];
+            const size_t count = ::fread(chunk, 1, sizeof(chunk), file);
+            if(count == 0) {
+                break;
+            }
+            bytes.insert(bytes.end(), chunk, chunk + count);
+        }
+        const bool failed = (::ferror(file) != 0);
+        file = (static_cast<void>(::fclose(file)), nullptr);
+        if(failed) {
+            throw std::runtime_error(std::string("unable to read") + ' ' + '<' + filename + '>');
+        }
+        return true;
+    }
+
+    /* the slot is written aside then renamed, a crash never leaves it half-written */
+    static auto write_file(const std::string& filename, const Bytes& bytes) -> void
+    {
+        const std::string temporary(filename + ".new");
+        FILE*             file = ::fopen(temporary.c_str(), "wb");
+
+        if(file == nullptr) {
+            throw std::runtime_error(std::string("unable to open") + ' ' + '<' + temporary + '>');
+        }
+        bool failed = (::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size());
+        if(::fflush(file) != 0) {
+            failed = true;
+        }
+        if(::fsync(::fileno(file)) != 0) {
+            failed = true;
+        }
+        if(::fclose(file) != 0) {
+            failed = true;
+        }
+        if((failed != false) || (::rename(temporary.c_str(), filename.c_str()) != 0)) {
+            static_cast<void>(::unlink(temporary.c_str()));
+            throw std::runtime_error(std::string("unable to write") + ' ' + '<' + filename + '>');
+        }
+    }
+};
+
+}
+
+constexpr uint8_t  SlotTraits::SLOT_MAGIC[8];
+constexpr uint32_t SlotTraits::SLOT_VERSION;
+constexpr size_t   SlotTraits::SLOT_HEADER;
+
+// ---------------------------------------------------------------------------
+// xcpc::SaveSlots
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+constexpr unsigned SaveSlots::SLOT_COUNT;
+
+SaveSlots::SaveSlots()
+    : _slots()
+    , _pending()
+    , _directory()
+    , _mutex()
+    , _signal()
+    , _running(false)
+    , _busy(false)
+    , _writer()
+    , _failure()
+{
+}
+
+SaveSlots::~SaveSlots()
+{
+    /* stop the writer once the pending slots are written */ {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _signal.notify_all();
+    if(_writer.joinable()) {
+        _writer.join();
+    }
+}
+
+/* the slot is queued for the writer, a newer store of the same slot replaces a pending one */
+auto SaveSlots::store(const unsigned slot, const SlotIdentity& identity, const Buffer& state) -> void
+{
+    std::exception_ptr failure;
+
+    auto store_cache = [&]() -> void
+    {
+        _slots[slot].clear();
+        SlotTraits::put_header(_slots[slot], identity);
+        _slots[slot].write(state.data(), state.size());
+    };
+
+    auto store_slot = [&]() -> void
+    {
+        const std::string filename(get_filename(slot));
+        /* queue */ {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            Pending& pending(_pending[slot]);
+            pending.queued   = true;
+            pending.filename = filename;
+            pending.bytes.assign(_slots[slot].data(), _slots[slot].data() + _slots[slot].size());
+            failure  = _failure;
+            _failure = nullptr;
+            if(_running == false) {
+                _running = true;
+                _writer  = std::thread(&SaveSlots::run_writer, this);
+            }
+        }
+        _signal.notify_all();
+    };
+
+    /* a failure of a previous write is reported once this one is queued */
+    auto report = [&]() -> void
+    {
+        if(failure) {
+            std::rethrow_exception(failure);
+        }
+    };
+
+    if(slot >= SLOT_COUNT) {
+        throw std::runtime_error("invalid save slot");
+    }
+    store_cache();
+    store_slot();
+    return report();
+}
+
+auto SaveSlots::fetch(const unsigned slot, const SlotIdentity& identity, Buffer& state) -> bool
+{
+    auto load_slot = [&]() -> bool
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> output;
+
+        if(SlotTraits::read_file(get_filename(slot), bytes) == false) {
+            return false;
+        }
+        SlotTraits::decompress(bytes, output);
+        _slots[slot].clear();
+        _slots[slot].write(output.data(), output.size());
+
+        return true;
+    };
+
+    if(slot >= SLOT_COUNT) {
+        throw std::runtime_error("invalid save slot");
+    }
+    if((_slots[slot].size() == 0) && (load_slot() == false)) {
+        return false;
+    }
+    SlotTraits::check_header(_slots[slot], identity);
+    state.clear();
+    state.write(_slots[slot].data() + SlotTraits::SLOT_HEADER, _slots[slot].size() - SlotTraits::SLOT_HEADER);
+
+    return true;
+}
+
+auto SaveSlots::flush() -> void
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto is_idle = [&]() -> bool
+    {
+        if(_busy != false) {
+            return false;
+        }
+        for(auto& pending : _pending) {
+            if(pending.queued != false) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    _signal.wait(lock, is_idle);
+    if(_failure) {
+        std::exception_ptr failure(_failure);
+        _failure = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+auto SaveSlots::run_writer() -> void
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::string                  filename;
+    std::vector<uint8_t>         bytes;
+    std::vector<uint8_t>         output;
+
+    auto next_slot = [&]() -> bool
+    {
+        for(auto& pending : _pending) {
+            if(pending.queued != false) {
+                pending.queued = false;
+                filename.swap(pending.filename);
+                bytes.swap(pending.bytes);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto write_slot = [&]() -> void
+    {
+        try {
+            SlotTraits::compress(bytes, output);
+            SlotTraits::write_file(filename, output);
+        }
+        catch(...) {
+            const std::lock_guard<std::mutex> guard(_mutex);
+            _failure = std::current_exception();
+        }
+    };
+
+    while(true) {
+        if(next_slot() != false) {
+            _busy = true;
+            lock.unlock();
+            write_slot();
+            lock.lock();
+            _busy = false;
+            _signal.notify_all();
+        }
+        else if(_running != false) {
+            _signal.wait(lock);
+        }
+        else {
+            break;
+        }
+    }
+}
+
+auto SaveSlots::get_filename(const unsigned slot) -> std::string
+{
+    char buffer[32];
+
+    if(_directory.empty()) {
+        _directory = SlotTraits::get_directory();
+    }
+    static_cast<void>(::snprintf(buffer, sizeof(buffer), "slot-%u.state", slot));
+
+    return _directory + '/' + buffer;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::HashTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct HashTraits
+{
+    static constexpr uint64_t PRIME1 = 0x9e3779b185ebca87ULL;
+    static constexpr uint64_t PRIME2 = 0xc2b2ae3d27d4eb4fULL;
+    static constexpr uint64_t PRIME3 = 0x165667b19e3779f9ULL;
+    static constexpr uint64_t PRIME4 = 0x85ebca77c2b2ae63ULL;
+    static constexpr uint64_t PRIME5 = 0x27d4eb2f165667c5ULL;
+
+    static auto rotl(const uint64_t value, const int count) -> uint64_t
+    {
+        return (value << count) | (value >> (64 - count));
+    }
+
+    static auto read32(const uint8_t* data) -> uint64_t
+    {
+        return (static_cast<uint64_t>(data[0]) <<  0)
+             | (static_cast<uint64_t>(data[1]) <<  8)
+             | (static_cast<uint64_t>(data[2]) << 16)
+             | (static_cast<uint64_t>(data[3]) << 24)
+             ;
+    }
+
+    static auto read64(const uint8_t* data) -> uint64_t
+    {
+        return (read32(data + 0) << 0) | (read32(data + 4) << 32);
+    }
+
+    static auto round(uint64_t lane, const uint64_t value) -> uint64_t
+    {
+        lane += value * PRIME2;
+        lane  = rotl(lane, 31);
+        lane *= PRIME1;
+        return lane;
+    }
+
+    static auto merge(uint64_t hash, const uint64_t lane) -> uint64_t
+    {
+        hash ^= round(0, lane);
+        hash  = hash * PRIME1 + PRIME4;
+        return hash;
+    }
+
+    static auto stripe(uint64_t (&lanes)[4], const uint8_t* data) -> void
+    {
+        lanes[0] = round(lanes[0], read64(data +  0));
+        lanes[1] = round(lanes[1], read64(data +  8));
+        lanes[2] = round(lanes[2], read64(data + 16));
+        lanes[3] = round(lanes[3], read64(data + 24));
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::Hash64
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+Hash64::Hash64(const uint64_t seed)
+    : _lanes()
+    , _seed(seed)
+    , _total(0)
+    , _block()
+    , _count(0)
+{
+    reset(seed);
+}
+
+auto Hash64::reset(const uint64_t seed) -> void
+{
+    _lanes[0] = seed + HashTraits::PRIME1 + HashTraits::PRIME2;
+    _lanes[1] = seed + HashTraits::PRIME2;
+    _lanes[2] = seed + 0;
+    _lanes[3] = seed - HashTraits::PRIME1;
+    _seed     = seed;
+    _total   &= 0;
+    _count   &= 0;
+}
+
+auto Hash64::update(const void* data, const size_t length) -> void
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t         count = length;
+
+    auto fill = [&]() -> void
+    {
+        const size_t chunk = std::min(count, sizeof(_block) - _count);
+        static_cast<void>(::memcpy(&_block[_count], bytes, chunk));
+        _count += chunk;
+        bytes  += chunk;
+        count  -= chunk;
+        if(_count == sizeof(_block)) {
+            HashTraits::stripe(_lanes, _block);
+            _count &= 0;
+        }
+    };
+
+    auto bulk = [&]() -> void
+    {
+        while(count >= sizeof(_block)) {
+            HashTraits::stripe(_lanes, bytes);
+            bytes += sizeof(_block);
+            count -= sizeof(_block);
+        }
+    };
+
+    _total += length;
+    if(_count != 0) {
+        fill();
+    }
+    if(_count == 0) {
+        bulk();
+    }
+    if(count != 0) {
+        fill();
+    }
+}
+
+auto Hash64::digest() const -> uint64_t
+{
+    const uint8_t* bytes = _block;
+    size_t         count = _count;
+    uint64_t       hash  = 0;
+
+    auto converge = [&]() -> void
+    {
+        if(_total >= sizeof(_block)) {
+            hash = HashTraits::rotl(_lanes[0],  1)
+                 + HashTraits::rotl(_lanes[1],  7)
+                 + HashTraits::rotl(_lanes[2], 12)
+                 + HashTraits::rotl(_lanes[3], 18)
+                 ;
+            hash = HashTraits::merge(hash, _lanes[0]);
+            hash = HashTraits::merge(hash, _lanes[1]);
+            hash = HashTraits::merge(hash, _lanes[2]);
+            hash = HashTraits::merge(hash, _lanes[3]);
+        }
+        else {
+            hash = _seed + HashTraits::PRIME5;
+        }
+        hash += _total;
+    };
+
+    auto finalize = [&]() -> void
+    {
+        for(; count >= 8; bytes += 8, count -= 8) {
+            hash ^= HashTraits::round(0, HashTraits::read64(bytes));
+            hash  = HashTraits::rotl(hash, 27) * HashTraits::PRIME1 + HashTraits::PRIME4;
+        }
+        for(; count >= 4; bytes += 4, count -= 4) {
+            hash ^= HashTraits::read32(bytes) * HashTraits::PRIME1;
+            hash  = HashTraits::rotl(hash, 23) * HashTraits::PRIME2 + HashTraits::PRIME3;
+        }
+        for(; count >= 1; bytes += 1, count -= 1) {
+            hash ^= (*bytes) * HashTraits::PRIME5;
+            hash  = HashTraits::rotl(hash, 11) * HashTraits::PRIME1;
+        }
+    };
+
+    auto avalanche = [&]() -> void
+    {
+        hash ^= (hash >> 33);
+        hash *= HashTraits::PRIME2;
+        hash ^= (hash >> 29);
+        hash *= HashTraits::PRIME3;
+        hash ^= (hash >> 32);
+    };
+
+    converge();
+    finalize();
+    avalanche();
+
+    return hash;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// xcpc::Codec
+// ---------------------------------------------------------------------------
+
+namespace xcpc {
+
+constexpr size_t Codec::CHUNK_SIZE;
+
+auto Codec::is_gzip(const uint8_t* data, const size_t size) -> bool
+{
+    return (size >= 2) && (data[0] == 0x1f) && (data[1] == 0x8b);
+}
+
+auto Codec::is_bzip2(const uint8_t* data, const size_t size) -> bool
+{
+    return (size >= 3) && (data[0] == 'B') && (data[1] == 'Z') && (data[2] == 'h');
+}
+
+#ifdef HAVE_LIBZ
+auto Codec::has_gzip() -> bool
+{
+    return true;
+}
+
+auto Codec::gzip_compress(const uint8_t* input, const size_t size, Bytes& output, const int level) -> void
+{
+    z_stream stream;
+    int      status = Z_OK;
+
+    static_cast<void>(::memset(&stream, 0, sizeof(stream)));
+    if(::deflateInit2(&stream, level, Z_DEFLATED, (15 + 16), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2() has failed");
+    }
+    output.resize(::deflateBound(&stream, static_cast<uLong>(size)));
+    stream.next_in   = const_cast<Bytef*>(input);
+    stream.avail_in  = static_cast<uInt>(size);
+    stream.next_out  = output.data();
+    stream.avail_out = static_cast<uInt>(output.size());
+    status = ::deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    static_cast<void>(::deflateEnd(&stream));
+    if(status != Z_STREAM_END) {
+        throw std::runtime_error("deflate() has failed");
+    }
+}
+
+/*
+ * decompress the input, stopping as soon as 'limit' bytes are available;
+ * a truncated input is only accepted when it holds at least 'limit' bytes
+ */
+
+auto Codec::gzip_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+{
+    z_stream stream;
+    int      status = Z_OK;
+
+    static_cast<void>(::memset(&stream, 0, sizeof(stream)));
+    if(::inflateInit2(&stream, (15 + 32)) != Z_OK) {
+        throw std::runtime_error("inflateInit2() has failed");
+    }
+    stream.next_in  = const_cast<Bytef*>(input);
+    stream.avail_in = static_cast<uInt>(size);
+    output.clear();
+    while((status == Z_OK) && (output.size() < limit)) {
+        const size_t length = output.size();
+        output.resize(length + CHUNK_SIZE);
+        stream.next_out  = &output[length];
+        stream.avail_out = static_cast<uInt>(CHUNK_SIZE);
+        status = ::inflate(&stream, Z_NO_FLUSH);
+        output.resize(length + (CHUNK_SIZE - stream.avail_out));
+    }
+    static_cast<void>(::inflateEnd(&stream));
+    if((status != Z_STREAM_END) && (output.size() < limit)) {
+        throw std::runtime_error("inflate() has failed");
+    }
+}
+#else
+auto Codec::has_gzip() -> bool
+{
+    return false;
+}
+
+auto Codec::gzip_compress(const uint8_t* input, const size_t size, Bytes& output, const int level) -> void
+{
+    throw std::runtime_error("gzip compression is not supported");
+}
+
+auto Codec::gzip_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+{
+    throw std::runtime_error("gzip compression is not supported");
+}
+#endif
+
+#ifdef HAVE_LIBBZ2
+auto Codec::has_bzip2() -> bool
+{
+    return true;
+}
+
+auto Codec::bzip2_compress(const uint8_t* input, const size_t size, Bytes& output) -> void
+{
+    unsigned int length = static_cast<unsigned int>(size + (size / 100) + 600);
+
+    output.resize(length);
+    char* dst = reinterpret_cast<char*>(output.data());
+    char* src = reinterpret_cast<char*>(const_cast<uint8_t*>(input));
+    const int status = ::BZ2_bzBuffToBuffCompress(dst, &length, src, static_cast<unsigned int>(size), 9, 0, 0);
+    if(status != BZ_OK) {
+        throw std::runtime_error("BZ2_bzBuffToBuffCompress() has failed");
+    }
+    output.resize(length);
+}
+
+auto Codec::bzip2_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+{
+    bz_stream stream;
+    int       status = BZ_OK;
+
+    static_cast<void>(::memset(&stream, 0, sizeof(stream)));
+    if(::BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+        throw std::runtime_error("BZ2_bzDecompressInit() has failed");
+    }
+    stream.next_in  = reinterpret_cast<char*>(const_cast<uint8_t*>(input));
+    stream.avail_in = static_cast<unsigned int>(size);
+    output.clear();
+    while((status == BZ_OK) && (output.size() < limit)) {
+        const size_t length = output.size();
+        output.resize(length + CHUNK_SIZE);
+        stream.next_out  = reinterpret_cast<char*>(&output[length]);
+        stream.avail_out = static_cast<unsigned int>(CHUNK_SIZE);
+        status = ::BZ2_bzDecompress(&stream);
+        output.resize(length + (CHUNK_SIZE - stream.avail_out));
+        if((status == BZ_OK) && (stream.avail_in == 0) && (stream.avail_out != 0)) {
+            break;
+        }
+    }
+    static_cast<void>(::BZ2_bzDecompressEnd(&stream));
+    if((status != BZ_STREAM_END) && (output.size() < limit)) {
+        throw std::runtime_error("BZ2_bzDecompress() has failed");
+    }
+}
+#else
+auto Codec::has_bzip2() -> bool
+{
+    return false;
+}
+
+auto Codec::bzip2_compress(const uint8_t* input, const size_t size, Bytes& output) -> void
+{
+    throw std::runtime_error("bzip2 compression is not supported");
+}
+
+auto Codec::bzip2_decompress(const uint8_t* input, const size_t size, Bytes& output, const size_t limit) -> void
+{
+    throw std::runtime_error("bzip2 compression is not supported");
+}
+#endif
+
+}
+
 // ---------------------------------------------------------------------------
 // <anonymous>::AudioTraits
 // ---------------------------------------------------------------------------
@@ -1277,6 +2296,15 @@ struct MiniAudioConfigTraits final
         return config;
     }
 
+    static auto get_headless() -> bool
+    {
+        const char* value = ::getenv("XCPC_AUDIO_HEADLESS");
+
+        if(value != nullptr) {
+            return ::atoi(value) != 0;
+        }
+        return false;
+    }
 };
 
 }
@@ -1295,6 +2323,44 @@ struct MiniAudioDeviceTraits final
         if(::ma_device_init(nullptr, config, &device) != MA_SUCCESS) {
             throw std::runtime_error("ma_device_init() has failed");
         }
+        /* log the requested and negotiated parameters */ {
+            ::xcpc_log_debug("xcpc.audio.requested.samplerate = %u", config->sampleRate);
+            ::xcpc_log_debug("xcpc.audio.requested.channels   = %u", config->playback.channels);
+            ::xcpc_log_debug("xcpc.audio.requested.period     = %u ms", config->periodSizeInMilliseconds);
+            ::xcpc_log_debug("xcpc.audio.device.samplerate    = %u", device.sampleRate);
+            ::xcpc_log_debug("xcpc.audio.device.channels      = %u", device.playback.channels);
+            ::xcpc_log_debug("xcpc.audio.internal.samplerate  = %u", device.playback.internalSampleRate);
+            ::xcpc_log_debug("xcpc.audio.internal.channels    = %u", device.playback.internalChannels);
+            ::xcpc_log_debug("xcpc.audio.internal.period      = %u frames", device.playback.internalPeriodSizeInFrames);
+            ::xcpc_log_debug("xcpc.audio.internal.periods     = %u", device.playback.internalPeriods);
+        }
+    }
+
+    static void init_null(MiniAudioDevice& device, MiniAudioConfig* config)
+    {
+        auto get_sampleRate = [&]() -> uint32_t
+        {
+            if(config->sampleRate != 0) {
+                return config->sampleRate;
+            }
+            return 44100;
+        };
+
+        auto get_channels = [&]() -> uint32_t
+        {
+            if(config->playback.channels != 0) {
+                return config->playback.channels;
+            }
+            return 2;
+        };
+
+        /* the null device is never started, only its parameters are used */ {
+            static_cast<void>(::memset(&device, 0, sizeof(device)));
+            device.type              = ma_device_type_playback;
+            device.sampleRate        = get_sampleRate();
+            device.playback.format   = ma_format_f32;
+            device.playback.channels = get_channels();
+        }
     }
 
     static void uninit(MiniAudioDevice& device)
@@ -1345,7 +2411,19 @@ AudioDevice::AudioDevice()
 }
 
 AudioDevice::AudioDevice(const AudioConfig& config)
-    : _impl()
+    : AudioDevice(config, true)
+{
+}
+
+AudioDevice::AudioDevice(const bool enabled)
+    : AudioDevice((enabled != false ? MiniAudioConfigTraits::get_audio_config() : AudioConfig(ma_device_type_playback)), enabled)
+{
+}
+
+/* a headless device is a disabled device, it keeps the parameters of the configuration */
+AudioDevice::AudioDevice(const AudioConfig& config, const bool enabled)
+    : _enabled(enabled && (MiniAudioConfigTraits::get_headless() == false))
+    , _impl()
     , _processor(nullptr)
 {
     AudioConfig settings(config);
@@ -1369,22 +2447,37 @@ AudioDevice::AudioDevice(const AudioConfig& config)
         return settings.get();
     };
 
-    MiniAudioDeviceTraits::init(_impl, get_config());
+    auto init_device = [&]() -> void
+    {
+        if(_enabled == false) {
+            return MiniAudioDeviceTraits::init_null(_impl, get_config());
+        }
+        MiniAudioDeviceTraits::init(_impl, get_config());
+    };
+
+    init_device();
 }
 
 AudioDevice::~AudioDevice()
 {
+    if(_enabled == false) {
+        return;
+    }
     MiniAudioDeviceTraits::uninit(_impl);
 }
 
 void AudioDevice::start()
 {
-    MiniAudioDeviceTraits::start(_impl);
+    if(_enabled != false) {
+        MiniAudioDeviceTraits::start(_impl);
+    }
 }
 
 void AudioDevice::stop()
 {
-    MiniAudioDeviceTraits::stop(_impl);
+    if(_enabled != false) {
+        MiniAudioDeviceTraits::stop(_impl);
+    }
 }
 
 void AudioDevice::attach(AudioProcessor& processor)
@@ -74,6 +74,7 @@ AC_CHECK_HEADERS([shlobj.h])
 AC_CHECK_HEADERS([stat.h])
 AC_CHECK_HEADERS([sys/farptr.h])
 AC_CHECK_HEADERS([sys/ioctl.h])
+AC_CHECK_HEADERS([sys/mman.h])
 AC_CHECK_HEADERS([sys/stat.h])
 AC_CHECK_HEADERS([sys/types.h])
 AC_CHECK_HEADERS([sys/time.h])
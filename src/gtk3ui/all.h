@@ -43,6 +43,7 @@
 #include <gtk3ui/gtk3-toolbar.h>
 #include <gtk3ui/gtk3-tool-item.h>
 #include <gtk3ui/gtk3-label.h>
+#include <gtk3ui/gtk3-image.h>
 #include <gtk3ui/gtk3-emulator.h>
 
 // ---------------------------------------------------------------------------
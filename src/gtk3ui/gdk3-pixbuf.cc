@@ -64,6 +64,23 @@ struct PixbufTraits
         return pixbuf;
     }
 
+    static GdkPixbuf* create_from_data(const uint8_t* data, int width, int height)
+    {
+        GdkPixbuf* pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+
+        if(pixbuf == nullptr) {
+            throw std::runtime_error("gdk_pixbuf_new() has failed");
+        }
+        /* copy the packed rgb rows */ {
+            const int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+            guchar*   pixels    = gdk_pixbuf_get_pixels(pixbuf);
+            for(int row = 0; row < height; ++row) {
+                static_cast<void>(::memcpy(&pixels[row * rowstride], &data[row * width * 3], (width * 3)));
+            }
+        }
+        return pixbuf;
+    }
+
     static GdkPixbuf* unref(GdkPixbuf* pixbuf)
     {
         if(pixbuf != nullptr) {
@@ -118,6 +135,12 @@ void Pixbuf::create_from_resource(const std::string& resource)
     _instance = traits::create_from_resource(resource);
 }
 
+void Pixbuf::create_from_data(const uint8_t* data, int width, int height)
+{
+    _instance = traits::unref(_instance);
+    _instance = traits::create_from_data(data, width, height);
+}
+
 void Pixbuf::unref()
 {
     _instance = traits::unref(_instance);
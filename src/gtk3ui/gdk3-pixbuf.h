@@ -48,6 +48,8 @@ public: // public interface
 
     void create_from_resource(const std::string& resource);
 
+    void create_from_data(const uint8_t* data, int width, int height);
+
     void unref();
 
 protected: // protected data
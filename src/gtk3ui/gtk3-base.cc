@@ -60,6 +60,7 @@ const char sig_key_release_event[]    = "key-release-event";
 const char sig_button_press_event[]   = "button-press-event";
 const char sig_button_release_event[] = "button-release-event";
 const char sig_motion_notify_event[]  = "motion-notify-event";
+const char sig_update_preview[]       = "update-preview";
 
 }
 
@@ -49,6 +49,7 @@ extern const char sig_key_release_event[];
 extern const char sig_button_press_event[];
 extern const char sig_button_release_event[];
 extern const char sig_motion_notify_event[];
+extern const char sig_update_preview[];
 
 }
 
@@ -72,6 +72,38 @@ struct FileChooserDialogTraits
         filename = (g_free(filename), nullptr);
         return result;
     }
+
+    static std::string get_preview_filename(FileChooserDialog& file_chooser_dialog)
+    {
+        std::string result;
+        gchar* filename = ::gtk_file_chooser_get_preview_filename(file_chooser_dialog);
+        if(filename != nullptr) {
+            result = filename;
+            filename = (g_free(filename), nullptr);
+        }
+        return result;
+    }
+
+    static void set_current_folder(FileChooserDialog& file_chooser_dialog, const std::string& folder)
+    {
+        if(file_chooser_dialog) {
+            static_cast<void>(::gtk_file_chooser_set_current_folder(file_chooser_dialog, folder.c_str()));
+        }
+    }
+
+    static void set_preview_widget(FileChooserDialog& file_chooser_dialog, Widget& widget)
+    {
+        if(file_chooser_dialog) {
+            ::gtk_file_chooser_set_preview_widget(file_chooser_dialog, widget);
+        }
+    }
+
+    static void set_preview_widget_active(FileChooserDialog& file_chooser_dialog, bool active)
+    {
+        if(file_chooser_dialog) {
+            ::gtk_file_chooser_set_preview_widget_active(file_chooser_dialog, active);
+        }
+    }
 };
 
 }
@@ -107,6 +139,31 @@ std::string FileChooserDialog::get_filename()
     return traits::get_filename(*this);
 }
 
+std::string FileChooserDialog::get_preview_filename()
+{
+    return traits::get_preview_filename(*this);
+}
+
+void FileChooserDialog::set_current_folder(const std::string& folder)
+{
+    return traits::set_current_folder(*this, folder);
+}
+
+void FileChooserDialog::set_preview_widget(Widget& widget)
+{
+    return traits::set_preview_widget(*this, widget);
+}
+
+void FileChooserDialog::set_preview_widget_active(bool active)
+{
+    return traits::set_preview_widget_active(*this, active);
+}
+
+void FileChooserDialog::add_update_preview_callback(GCallback callback, void* data)
+{
+    return signal_connect(sig_update_preview, callback, data);
+}
+
 }
 
 // ---------------------------------------------------------------------------
@@ -50,6 +50,16 @@ public: // public interface
     }
 
     std::string get_filename();
+
+    std::string get_preview_filename();
+
+    void set_current_folder(const std::string& folder);
+
+    void set_preview_widget(Widget& widget);
+
+    void set_preview_widget_active(bool active);
+
+    void add_update_preview_callback(GCallback callback, void* data);
 };
 
 }
@@ -0,0 +1,113 @@
+/*
+ * gtk3-image.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "gtk3-image.h"
+
+// ---------------------------------------------------------------------------
+// gtk3::ImageTraits
+// ---------------------------------------------------------------------------
+
+namespace gtk3 {
+
+struct ImageTraits
+    : BasicTraits
+{
+    static GtkWidget* create_image()
+    {
+        return ::gtk_image_new();
+    }
+
+    static void set_from_pixbuf(Image& image, gdk3::Pixbuf& pixbuf)
+    {
+        if(image) {
+            ::gtk_image_set_from_pixbuf(image, pixbuf);
+        }
+    }
+
+    static void clear(Image& image)
+    {
+        if(image) {
+            ::gtk_image_clear(image);
+        }
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::traits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+using traits = gtk3::ImageTraits;
+
+}
+
+// ---------------------------------------------------------------------------
+// gtk3::Image
+// ---------------------------------------------------------------------------
+
+namespace gtk3 {
+
+Image::Image()
+    : Image(traits::create_image())
+{
+}
+
+Image::Image(GtkWidget* instance)
+    : Widget(instance)
+{
+}
+
+void Image::create_image()
+{
+    if(_instance == nullptr) {
+        _instance = traits::create_image();
+        traits::register_widget_instance(_instance);
+    }
+}
+
+void Image::set_from_pixbuf(gdk3::Pixbuf& pixbuf)
+{
+    return traits::set_from_pixbuf(*this, pixbuf);
+}
+
+void Image::clear()
+{
+    return traits::clear(*this);
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
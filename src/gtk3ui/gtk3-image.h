@@ -0,0 +1,61 @@
+/*
+ * gtk3-image.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK3_CXX_IMAGE_H__
+#define __GTK3_CXX_IMAGE_H__
+
+#include <gtk3ui/gdk3-pixbuf.h>
+#include <gtk3ui/gtk3-widget.h>
+
+// ---------------------------------------------------------------------------
+// gtk3::Image
+// ---------------------------------------------------------------------------
+
+namespace gtk3 {
+
+class Image
+    : public Widget
+{
+public: // public interface
+    Image();
+
+    Image(GtkWidget*);
+
+    Image(const Image&) = delete;
+
+    Image& operator=(const Image&) = delete;
+
+    virtual ~Image() = default;
+
+    operator GtkImage*() const
+    {
+        return GTK_IMAGE(_instance);
+    }
+
+    void create_image();
+
+    void set_from_pixbuf(gdk3::Pixbuf& pixbuf);
+
+    void clear();
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __GTK3_CXX_IMAGE_H__ */
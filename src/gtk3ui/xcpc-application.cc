@@ -106,6 +106,27 @@ struct Callbacks
         }
     }
 
+    static auto on_quick_save(GtkWidget* widget, Application* application) -> void
+    {
+        if(application != nullptr) {
+            application->on_quick_save();
+        }
+    }
+
+    static auto on_quick_load(GtkWidget* widget, Application* application) -> void
+    {
+        if(application != nullptr) {
+            application->on_quick_load();
+        }
+    }
+
+    static auto on_quick_slot(GtkWidget* widget, Application* application) -> void
+    {
+        if(application != nullptr) {
+            application->on_quick_slot();
+        }
+    }
+
     static auto on_exit(GtkWidget* widget, Application* application) -> void
     {
         if(application != nullptr) {
@@ -134,6 +155,13 @@ struct Callbacks
         }
     }
 
+    static auto on_emulator_rewind(GtkWidget* widget, Application* application) -> void
+    {
+        if(application != nullptr) {
+            application->on_emulator_rewind();
+        }
+    }
+
     static auto on_machine_cpc464(GtkWidget* widget, Application* application) -> void
     {
         if(application != nullptr) {
@@ -410,7 +438,7 @@ struct Callbacks
                     on_snapshot_save(widget, application);
                     break;
                 case XK_F4:
-                    on_ignore(widget, application);
+                    on_emulator_rewind(widget, application);
                     break;
                 case XK_F5:
                     on_emulator_reset(widget, application);
@@ -428,13 +456,13 @@ struct Callbacks
                     on_drive1_disk_remove(widget, application);
                     break;
                 case XK_F10:
-                    on_ignore(widget, application);
+                    on_quick_slot(widget, application);
                     break;
                 case XK_F11:
-                    on_ignore(widget, application);
+                    on_quick_save(widget, application);
                     break;
                 case XK_F12:
-                    on_ignore(widget, application);
+                    on_quick_load(widget, application);
                     break;
                 default:
                     break;
@@ -694,7 +722,11 @@ FileMenu::FileMenu(Application& application)
     , _menu(nullptr)
     , _snapshot_load(nullptr)
     , _snapshot_save(nullptr)
-    , _separator(nullptr)
+    , _separator1(nullptr)
+    , _quick_save(nullptr)
+    , _quick_load(nullptr)
+    , _quick_slot(nullptr)
+    , _separator2(nullptr)
     , _exit(nullptr)
 {
 }
@@ -728,10 +760,40 @@ void FileMenu::build()
         _menu.append(_snapshot_save);
     };
 
-    auto build_separator = [&]() -> void
+    auto build_separator1 = [&]() -> void
     {
-        _separator.create_separator_menu_item();
-        _menu.append(_separator);
+        _separator1.create_separator_menu_item();
+        _menu.append(_separator1);
+    };
+
+    auto build_quick_save = [&]() -> void
+    {
+        _quick_save.create_menu_item_with_label(_("Quick save"));
+        _quick_save.set_accel(GDK_KEY_F11, GdkModifierType(0));
+        _quick_save.add_activate_callback(G_CALLBACK(&Callbacks::on_quick_save), &_application);
+        _menu.append(_quick_save);
+    };
+
+    auto build_quick_load = [&]() -> void
+    {
+        _quick_load.create_menu_item_with_label(_("Quick load"));
+        _quick_load.set_accel(GDK_KEY_F12, GdkModifierType(0));
+        _quick_load.add_activate_callback(G_CALLBACK(&Callbacks::on_quick_load), &_application);
+        _menu.append(_quick_load);
+    };
+
+    auto build_quick_slot = [&]() -> void
+    {
+        _quick_slot.create_menu_item_with_label(_("Next quick slot"));
+        _quick_slot.set_accel(GDK_KEY_F10, GdkModifierType(0));
+        _quick_slot.add_activate_callback(G_CALLBACK(&Callbacks::on_quick_slot), &_application);
+        _menu.append(_quick_slot);
+    };
+
+    auto build_separator2 = [&]() -> void
+    {
+        _separator2.create_separator_menu_item();
+        _menu.append(_separator2);
     };
 
     auto build_exit = [&]() -> void
@@ -747,7 +809,11 @@ void FileMenu::build()
         build_menu();
         build_snapshot_load();
         build_snapshot_save();
-        build_separator();
+        build_separator1();
+        build_quick_save();
+        build_quick_load();
+        build_quick_slot();
+        build_separator2();
         build_exit();
     };
 
@@ -771,6 +837,7 @@ ControlsMenu::ControlsMenu(Application& application)
     , _emulator_pause(nullptr)
     , _separator(nullptr)
     , _emulator_reset(nullptr)
+    , _emulator_rewind(nullptr)
 {
 }
 
@@ -815,6 +882,14 @@ void ControlsMenu::build()
         _menu.append(_emulator_reset);
     };
 
+    auto build_emulator_rewind = [&]() -> void
+    {
+        _emulator_rewind.create_menu_item_with_label(_("Rewind"));
+        _emulator_rewind.set_accel(GDK_KEY_F4, GdkModifierType(0));
+        _emulator_rewind.add_activate_callback(G_CALLBACK(&Callbacks::on_emulator_rewind), &_application);
+        _menu.append(_emulator_rewind);
+    };
+
     auto build_all = [&]() -> void
     {
         build_self();
@@ -823,6 +898,7 @@ void ControlsMenu::build()
         build_emulator_pause();
         build_separator();
         build_emulator_reset();
+        build_emulator_rewind();
     };
 
     return build_all();
@@ -851,11 +927,13 @@ void ControlsMenu::hide_pause()
 void ControlsMenu::show_reset()
 {
     _emulator_reset.show();
+    _emulator_rewind.show();
 }
 
 void ControlsMenu::hide_reset()
 {
     _emulator_reset.hide();
+    _emulator_rewind.hide();
 }
 
 }
@@ -2314,6 +2392,7 @@ Application::Application(int& argc, char**& argv)
     , _app_icon(nullptr)
     , _app_window(*this)
     , _timer(0)
+    , _quick_slot(0)
 {
 }
 
@@ -2401,6 +2480,49 @@ auto Application::reset_emulator() -> void
     update_all();
 }
 
+auto Application::rewind_emulator() -> void
+{
+    try {
+        if(_machine->rewind() == false) {
+            ::xcpc_log_alert("rewind-emulator: no older state is available");
+        }
+    }
+    catch(const std::exception& e) {
+        ::xcpc_log_error("rewind-emulator has failed (%s)", e.what());
+    }
+    update_all();
+}
+
+auto Application::quick_save_emulator() -> void
+{
+    try {
+        _machine->quick_save(_quick_slot);
+    }
+    catch(const std::exception& e) {
+        ::xcpc_log_error("quick-save has failed (%s)", e.what());
+    }
+    update_all();
+}
+
+auto Application::quick_load_emulator() -> void
+{
+    try {
+        if(_machine->quick_load(_quick_slot) == false) {
+            ::xcpc_log_alert("quick-load: slot %u is empty or a movie is active", _quick_slot);
+        }
+    }
+    catch(const std::exception& e) {
+        ::xcpc_log_error("quick-load has failed (%s)", e.what());
+    }
+    update_all();
+}
+
+auto Application::next_quick_slot() -> void
+{
+    _quick_slot = ((_quick_slot + 1) % xcpc::SaveSlots::SLOT_COUNT);
+    ::xcpc_log_alert("quick-slot: slot %u is selected", _quick_slot);
+}
+
 auto Application::create_disk_into_drive0(const std::string& filename) -> void
 {
     try {
@@ -2660,6 +2782,26 @@ auto Application::on_emulator_reset() -> void
     reset_emulator();
 }
 
+auto Application::on_emulator_rewind() -> void
+{
+    rewind_emulator();
+}
+
+auto Application::on_quick_save() -> void
+{
+    quick_save_emulator();
+}
+
+auto Application::on_quick_load() -> void
+{
+    quick_load_emulator();
+}
+
+auto Application::on_quick_slot() -> void
+{
+    next_quick_slot();
+}
+
 auto Application::on_machine_cpc464() -> void
 {
     set_machine_type("cpc464");
@@ -162,7 +162,11 @@ private: // private data
     gtk3::Menu              _menu;
     gtk3::MenuItem          _snapshot_load;
     gtk3::MenuItem          _snapshot_save;
-    gtk3::SeparatorMenuItem _separator;
+    gtk3::SeparatorMenuItem _separator1;
+    gtk3::MenuItem          _quick_save;
+    gtk3::MenuItem          _quick_load;
+    gtk3::MenuItem          _quick_slot;
+    gtk3::SeparatorMenuItem _separator2;
     gtk3::MenuItem          _exit;
 };
 
@@ -208,6 +212,7 @@ private: // private data
     gtk3::MenuItem          _emulator_pause;
     gtk3::SeparatorMenuItem _separator;
     gtk3::MenuItem          _emulator_reset;
+    gtk3::MenuItem          _emulator_rewind;
 };
 
 }
@@ -801,6 +806,14 @@ public: // public methods
 
     virtual auto reset_emulator() -> void override final;
 
+    virtual auto rewind_emulator() -> void override final;
+
+    virtual auto quick_save_emulator() -> void override final;
+
+    virtual auto quick_load_emulator() -> void override final;
+
+    virtual auto next_quick_slot() -> void override final;
+
     virtual auto create_disk_into_drive0(const std::string& filename) -> void override final;
 
     virtual auto insert_disk_into_drive0(const std::string& filename) -> void override final;
@@ -844,6 +857,12 @@ public: // public signals
 
     virtual auto on_snapshot_save() -> void override final;
 
+    virtual auto on_quick_save() -> void override final;
+
+    virtual auto on_quick_load() -> void override final;
+
+    virtual auto on_quick_slot() -> void override final;
+
     virtual auto on_exit() -> void override final;
 
     virtual auto on_emulator_play() -> void override final;
@@ -852,6 +871,8 @@ public: // public signals
 
     virtual auto on_emulator_reset() -> void override final;
 
+    virtual auto on_emulator_rewind() -> void override final;
+
     virtual auto on_machine_cpc464() -> void override final;
 
     virtual auto on_machine_cpc664() -> void override final;
@@ -967,6 +988,7 @@ private: // private data
     gdk3::Pixbuf    _app_icon;
     impl::AppWindow _app_window;
     guint           _timer;
+    unsigned        _quick_slot;
 };
 
 }
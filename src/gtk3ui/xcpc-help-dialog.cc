@@ -86,15 +86,15 @@ const char traits::secondary_markup[] = ""
     "    - F1                help"                                                            EOL
     "    - F2                load snapshot"                                                   EOL
     "    - F3                save snapshot"                                                   EOL
-    "    - F4                {not mapped}"                                                    EOL
+    "    - F4                rewind emulator"                                                 EOL
     "    - F5                reset emulator"                                                  EOL
     "    - F6                insert disk into drive A"                                        EOL
     "    - F7                remove disk from drive A"                                        EOL
     "    - F8                insert disk into drive B"                                        EOL
     "    - F9                remove disk from drive B"                                        EOL
-    "    - F10               {not mapped}"                                                    EOL
-    "    - F11               {not mapped}"                                                    EOL
-    "    - F12               {not mapped}"                                                    EOL
+    "    - F10               select next quick-save slot"                                     EOL
+    "    - F11               quick-save into the slot"                                        EOL
+    "    - F12               quick-load from the slot"                                        EOL
     "</tt>"                                                                                   NIL
     "</small>"                                                                                NIL
     ""                                                                                        EOL
@@ -59,6 +59,87 @@ struct traits
 
 }
 
+// ---------------------------------------------------------------------------
+// <anonymous>::Preview
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct Preview
+{
+    Preview(sna::Library& library, gtk3::FileChooserDialog& dialog)
+        : library(library)
+        , dialog(dialog)
+        , vbox()
+        , image()
+        , label()
+    {
+        vbox.pack_start(image, false, false, 0);
+        vbox.pack_start(label, false, false, 0);
+        vbox.show_all();
+        dialog.set_preview_widget(vbox);
+        dialog.add_update_preview_callback(G_CALLBACK(&on_update_preview), this);
+    }
+
+    auto update() -> void
+    {
+        const std::string filename(dialog.get_preview_filename());
+        sna::Preview      preview;
+
+        auto get_machine = [&]() -> const char*
+        {
+            switch(preview.cpc_type) {
+                case 0:
+                    return "CPC 464";
+                case 1:
+                    return "CPC 664";
+                case 2:
+                    return "CPC 6128";
+                default:
+                    break;
+            }
+            return "CPC";
+        };
+
+        auto set_details = [&]() -> void
+        {
+            char buffer[256];
+            static_cast<void>(::snprintf(buffer, sizeof(buffer), "%s, %dK, v%d", get_machine(), preview.ram_size, preview.version));
+            label.set_text(buffer);
+        };
+
+        auto set_thumbnail = [&]() -> void
+        {
+            gdk3::Pixbuf pixbuf;
+            pixbuf.create_from_data(preview.pixels.data(), preview.width, preview.height);
+            image.set_from_pixbuf(pixbuf);
+        };
+
+        if(filename.empty() || (library.lookup(filename, preview) == false)) {
+            dialog.set_preview_widget_active(false);
+            return;
+        }
+        set_thumbnail();
+        set_details();
+        dialog.set_preview_widget_active(true);
+    }
+
+    static auto on_update_preview(GtkFileChooser* file_chooser, Preview* preview) -> void
+    {
+        if(preview != nullptr) {
+            preview->update();
+        }
+    }
+
+    sna::Library&            library;
+    gtk3::FileChooserDialog& dialog;
+    gtk3::VBox               vbox;
+    gtk3::Image              image;
+    gtk3::Label              label;
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // xcpc::LoadSnapshotDialog
 // ---------------------------------------------------------------------------
@@ -75,6 +156,7 @@ void LoadSnapshotDialog::run()
     auto run_dialog = [&](gtk3::FileChooserOpenDialog& dialog) -> bool
     {
         dialog.set_title(_title);
+        dialog.set_current_folder(xcpc::Utils::get_snadir());
 
         return traits::run_dialog(dialog);
     };
@@ -82,6 +164,7 @@ void LoadSnapshotDialog::run()
     auto execute = [&]() -> void
     {
         gtk3::FileChooserOpenDialog dialog;
+        Preview                     preview(_application.get_snapshot_library(), dialog);
 
         if(run_dialog(dialog)) {
             _filename = dialog.get_filename();
@@ -0,0 +1,90 @@
+/*
+ * json.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "json.h"
+
+// ---------------------------------------------------------------------------
+// base::Json
+// ---------------------------------------------------------------------------
+
+namespace base {
+
+auto Json::quote(const std::string& string) -> std::string
+{
+    std::string result("\"");
+    for(const char character : string) {
+        const unsigned char code = static_cast<unsigned char>(character);
+        if((character == '"') || (character == '\\')) {
+            result += '\\';
+            result += character;
+        }
+        else if(code < 0x20) {
+            char buffer[8];
+            static_cast<void>(::snprintf(buffer, sizeof(buffer), "\\u%04x", code));
+            result += buffer;
+        }
+        else {
+            result += character;
+        }
+    }
+    return result += '"';
+}
+
+auto Json::field(const char* name, const std::string& value) -> std::string
+{
+    return quote(name) + ':' + quote(value);
+}
+
+auto Json::field(const char* name, const char* value) -> std::string
+{
+    return quote(name) + ':' + quote(value);
+}
+
+auto Json::field(const char* name, const unsigned long value) -> std::string
+{
+    return quote(name) + ':' + std::to_string(value);
+}
+
+auto Json::field(const char* name, const bool value) -> std::string
+{
+    return quote(name) + ':' + (value != false ? "true" : "false");
+}
+
+auto Json::error(const std::string& filename, const char* what) -> std::string
+{
+    return '{' + field("file", filename) + ',' + field("ok", false) + ',' + field("error", what) + '}';
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
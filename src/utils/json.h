@@ -0,0 +1,48 @@
+/*
+ * json.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __BASE_JSON_H__
+#define __BASE_JSON_H__
+
+// ---------------------------------------------------------------------------
+// base::Json
+// ---------------------------------------------------------------------------
+
+namespace base {
+
+class Json
+{
+public: // public interface
+    static auto quote(const std::string& string) -> std::string;
+
+    static auto field(const char* name, const std::string& value) -> std::string;
+
+    static auto field(const char* name, const char* value) -> std::string;
+
+    static auto field(const char* name, const unsigned long value) -> std::string;
+
+    static auto field(const char* name, const bool value) -> std::string;
+
+    static auto error(const std::string& filename, const char* what) -> std::string;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __BASE_JSON_H__ */
@@ -23,13 +23,331 @@
 #include <cstring>
 #include <cstdint>
 #include <climits>
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include <memory>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <exception>
 #include <iostream>
 #include <stdexcept>
 #include "xcpc-dsk.h"
 
+// ---------------------------------------------------------------------------
+// <anonymous>::BenchTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct BenchTraits
+{
+    using Clock = std::chrono::steady_clock;
+
+    class NullVisitor final
+        : public dsk::Visitor
+    {
+    public: // public interface
+        NullVisitor() = default;
+
+        virtual void on_disk_info(dsk::DiskRecord&) override final { }
+
+        virtual void on_track_info(dsk::TrackRecord&) override final { }
+
+        virtual void on_sector_info(dsk::SectorRecord&) override final { }
+
+        virtual void on_sector_data(dsk::SectorRecord&) override final { }
+    };
+
+    /* number of read() calls issued by the process so far, -1 if unknown */
+    static auto get_reads() -> long
+    {
+        long  reads = -1;
+        FILE* file  = ::fopen("/proc/self/io", "r");
+        if(file != nullptr) {
+            char line[128];
+            while(::fgets(line, sizeof(line), file) != nullptr) {
+                if(::strncmp(line, "syscr:", 6) == 0) {
+                    reads = ::atol(line + 6);
+                }
+            }
+            static_cast<void>(::fclose(file));
+        }
+        return reads;
+    }
+
+    /* the former dump path: one read() per record */
+    static auto parse_records(const std::string& filename) -> void
+    {
+        std::unique_ptr<dsk::ImageRecord> record(new dsk::ImageRecord);
+        const int file = ::open(filename.c_str(), O_RDONLY);
+        if(file < 0) {
+            throw std::runtime_error("open() has failed");
+        }
+        try {
+            dsk::ImageAdapter image(*record, file);
+            image.clear();
+            image.fetch();
+        }
+        catch(...) {
+            static_cast<void>(::close(file));
+            throw;
+        }
+        static_cast<void>(::close(file));
+    }
+
+    /* the whole-image loader */
+    static auto parse_image(const std::string& filename) -> void
+    {
+        NullVisitor visitor;
+        dsk::Disk   disk(filename);
+        disk.load(true);
+        disk.visit(visitor);
+        disk.close();
+    }
+
+    template <typename Function>
+    static auto measure(const char* name, const unsigned iterations, Function function) -> std::string
+    {
+        const long       reads = get_reads();
+        const auto       start = Clock::now();
+        try {
+            for(unsigned iteration = 0; iteration < iterations; ++iteration) {
+                function();
+            }
+        }
+        catch(const std::exception& e) {
+            return base::Json::quote(name) + ':' + '{' + base::Json::field("error", e.what()) + '}';
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        const long count   = (reads >= 0 ? (get_reads() - reads) / iterations : -1);
+        return base::Json::quote(name) + ':' + '{'
+             + base::Json::quote("reads") + ':' + std::to_string(count)
+             + ',' + base::Json::field("usec", static_cast<unsigned long>(elapsed.count() / iterations))
+             + '}';
+    }
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// <anonymous>::CatalogTraits
+// ---------------------------------------------------------------------------
+
+/*
+ * the AMSDOS formats are CP/M 2.2 filesystems with 1K blocks, 8-bit block
+ * pointers (one logical extent per directory entry) and a directory of 64
+ * entries stored in the first two blocks
+ */
+
+namespace {
+
+struct CatalogTraits
+{
+    struct Format
+    {
+        const char* name;
+        uint8_t     first_sector;
+        unsigned    reserved_tracks;
+        unsigned    sectors_per_track;
+    };
+
+    struct Entry
+    {
+        unsigned             user;
+        std::string          name;
+        bool                 readonly;
+        bool                 system;
+        unsigned             extent;
+        unsigned             records;
+        std::vector<uint8_t> blocks;
+    };
+
+    struct File
+    {
+        unsigned           user;
+        std::string        name;
+        bool               readonly;
+        bool               system;
+        std::vector<Entry> entries;
+    };
+
+    static constexpr size_t   SECTOR_SIZE       = 512;
+    static constexpr size_t   RECORD_SIZE       = 128;
+    static constexpr size_t   ENTRY_SIZE        = 32;
+    static constexpr unsigned SECTORS_PER_BLOCK = 2;
+    static constexpr unsigned DIRECTORY_SECTORS = 4;
+
+    static auto get_format(dsk::Disk& disk) -> Format
+    {
+        dsk::TrackIndex* track = disk.get_track(0, 0);
+        if((track == nullptr) || (track->count == 0)) {
+            throw std::runtime_error("the first track is not formatted");
+        }
+        uint8_t first_sector = 0xff;
+        for(unsigned index = 0; index < track->count; ++index) {
+            first_sector = std::min(first_sector, track->sector[index].info[2]);
+        }
+        switch(first_sector) {
+            case 0xc1:
+                return Format { "data", 0xc1, 0, 9 };
+            case 0x41:
+                return Format { "system", 0x41, 2, 9 };
+            case 0x01:
+                return Format { "ibm", 0x01, 1, 8 };
+            default:
+                break;
+        }
+        throw std::runtime_error("the disk format is not supported");
+    }
+
+    static auto read_sector(dsk::Disk& disk, const Format& format, const unsigned sector, std::vector<uint8_t>& data) -> void
+    {
+        const unsigned   track_number  = format.reserved_tracks + (sector / format.sectors_per_track);
+        const uint8_t    sector_id     = format.first_sector + (sector % format.sectors_per_track);
+        dsk::TrackIndex* track_index   = disk.get_track(track_number, 0);
+        dsk::SectorIndex* sector_index = (track_index != nullptr ? disk.get_sector(*track_index, sector_id) : nullptr);
+        if(sector_index == nullptr) {
+            throw std::runtime_error("sector " + std::to_string(sector_id) + " of track " + std::to_string(track_number) + " is missing");
+        }
+        const dsk::Span span(disk.get_sector_data(*sector_index, 0));
+        const size_t    size = std::min(span.size, SECTOR_SIZE);
+        data.insert(data.end(), span.data, span.data + size);
+        data.resize(data.size() + (SECTOR_SIZE - size), 0xe5);
+    }
+
+    static auto read_directory(dsk::Disk& disk, const Format& format) -> std::vector<File>
+    {
+        std::vector<uint8_t> directory;
+        std::vector<File>    files;
+
+        auto get_name = [&](const uint8_t* entry) -> std::string
+        {
+            std::string name, extension;
+            for(unsigned index = 1; index <= 8; ++index) {
+                const char character = static_cast<char>(entry[index] & 0x7f);
+                if(character != ' ') {
+                    name += character;
+                }
+            }
+            for(unsigned index = 9; index <= 11; ++index) {
+                const char character = static_cast<char>(entry[index] & 0x7f);
+                if(character != ' ') {
+                    extension += character;
+                }
+            }
+            return (extension.empty() ? name : name + '.' + extension);
+        };
+
+        auto is_valid = [&](const uint8_t* entry) -> bool
+        {
+            for(unsigned index = 1; index <= 11; ++index) {
+                if((entry[index] & 0x7f) < 0x20) {
+                    return false;
+                }
+            }
+            return entry[0] < 16;
+        };
+
+        auto add_entry = [&](const uint8_t* bytes) -> void
+        {
+            Entry entry;
+            entry.user     = bytes[0];
+            entry.name     = get_name(bytes);
+            entry.readonly = ((bytes[9]  & 0x80) != 0);
+            entry.system   = ((bytes[10] & 0x80) != 0);
+            entry.extent   = (bytes[12] & 0x1f) + ((bytes[14] & 0x3f) * 32);
+            entry.records  = std::min<unsigned>(bytes[15], 0x80);
+            for(unsigned index = 16; index < 32; ++index) {
+                if(bytes[index] != 0) {
+                    entry.blocks.push_back(bytes[index]);
+                }
+            }
+            for(auto& file : files) {
+                if((file.user == entry.user) && (file.name == entry.name)) {
+                    file.entries.push_back(entry);
+                    return;
+                }
+            }
+            files.push_back(File { entry.user, entry.name, entry.readonly, entry.system, { entry } });
+        };
+
+        for(unsigned sector = 0; sector < DIRECTORY_SECTORS; ++sector) {
+            read_sector(disk, format, sector, directory);
+        }
+        for(size_t offset = 0; offset < directory.size(); offset += ENTRY_SIZE) {
+            if(is_valid(&directory[offset])) {
+                add_entry(&directory[offset]);
+            }
+        }
+        for(auto& file : files) {
+            std::sort(file.entries.begin(), file.entries.end(), [](const Entry& lhs, const Entry& rhs) -> bool { return lhs.extent < rhs.extent; });
+        }
+        return files;
+    }
+
+    static auto get_size(const File& file) -> size_t
+    {
+        size_t records = 0;
+        for(auto& entry : file.entries) {
+            records += entry.records;
+        }
+        return records * RECORD_SIZE;
+    }
+
+    static auto read_file(dsk::Disk& disk, const Format& format, const File& file) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> data;
+        for(auto& entry : file.entries) {
+            std::vector<uint8_t> extent;
+            for(const uint8_t block : entry.blocks) {
+                for(unsigned sector = 0; sector < SECTORS_PER_BLOCK; ++sector) {
+                    read_sector(disk, format, (block * SECTORS_PER_BLOCK) + sector, extent);
+                }
+            }
+            extent.resize(std::min(extent.size(), (entry.records * RECORD_SIZE)));
+            data.insert(data.end(), extent.begin(), extent.end());
+        }
+        return data;
+    }
+
+    static auto get_amsdos(const std::vector<uint8_t>& data) -> std::string
+    {
+        if(data.size() < RECORD_SIZE) {
+            return std::string();
+        }
+        uint16_t checksum = 0;
+        for(unsigned index = 0; index < 67; ++index) {
+            checksum += data[index];
+        }
+        if((checksum != (data[67] | (data[68] << 8))) || (checksum == 0)) {
+            return std::string();
+        }
+        return '{' + base::Json::field("type", static_cast<unsigned long>(data[18]))
+             + ',' + base::Json::field("load", static_cast<unsigned long>(data[21] | (data[22] << 8)))
+             + ',' + base::Json::field("exec", static_cast<unsigned long>(data[26] | (data[27] << 8)))
+             + ',' + base::Json::field("length", static_cast<unsigned long>(data[64] | (data[65] << 8) | (data[66] << 16)))
+             + '}';
+    }
+};
+
+}
+
 // ---------------------------------------------------------------------------
 // Command
 // ---------------------------------------------------------------------------
@@ -62,6 +380,19 @@ void HelpCmd::run()
     _console.println("    help        display this help");
     _console.println("    dump        dump the content of an existing disk image");
     _console.println("    create      create a new disk image");
+    _console.println("    verify      check the structure of disk images");
+    _console.println("    catalog     list the AMSDOS / CP/M directory of disk images");
+    _console.println("    extract     extract the files of disk images");
+    _console.println("    bench       compare the record and whole-image parsers");
+    _console.println("");
+    _console.println("verify, catalog and extract print one JSON object per image and accept:");
+    _console.println("");
+    _console.println("    --jobs={count}     number of images processed concurrently");
+    _console.println("    --output={dir}     extract into {dir}/{image name}/ (default: .)");
+    _console.println("");
+    _console.println("bench prints the read() calls and the time per parse and accepts:");
+    _console.println("");
+    _console.println("    --iterations={count}   number of parses per image (default: 100)");
     _console.println("");
 }
 
@@ -153,6 +484,274 @@ void CreateCmd::run()
     }
 }
 
+// ---------------------------------------------------------------------------
+// BenchCmd
+// ---------------------------------------------------------------------------
+
+BenchCmd::BenchCmd(base::Console& console, const std::string& program)
+    : Command(console, program, "bench")
+{
+}
+
+void BenchCmd::run()
+{
+    unsigned iterations = 100;
+
+    auto bench = [&](const std::string& filename) -> std::string
+    {
+        return '{' + base::Json::field("file", filename)
+             + ',' + base::Json::field("iterations", static_cast<unsigned long>(iterations))
+             + ',' + BenchTraits::measure("records", iterations, [&]() -> void { BenchTraits::parse_records(filename); })
+             + ',' + BenchTraits::measure("image", iterations, [&]() -> void { BenchTraits::parse_image(filename); })
+             + '}';
+    };
+
+    std::vector<std::string> filenames;
+    for(auto& argument : _arguments) {
+        if(argument.compare(0, 13, "--iterations=") == 0) {
+            iterations = std::max(1, std::atoi(argument.c_str() + 13));
+        }
+        else {
+            filenames.push_back(argument);
+        }
+    }
+    for(auto& filename : filenames) {
+        _console.println("%s", bench(filename).c_str());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BatchCmd
+// ---------------------------------------------------------------------------
+
+BatchCmd::BatchCmd(base::Console& console, const std::string& program, const std::string& command)
+    : Command(console, program, command)
+    , _jobs(std::max(1U, std::thread::hardware_concurrency()))
+    , _output(".")
+{
+}
+
+void BatchCmd::run()
+{
+    std::vector<std::string> filenames;
+    std::atomic<size_t>      next(0);
+    std::mutex               mutex;
+
+    auto parse = [&]() -> void
+    {
+        for(auto& argument : _arguments) {
+            if(argument.compare(0, 7, "--jobs=") == 0) {
+                _jobs = std::max(1, std::atoi(argument.c_str() + 7));
+            }
+            else if(argument.compare(0, 9, "--output=") == 0) {
+                _output = argument.substr(9);
+            }
+            else {
+                filenames.push_back(argument);
+            }
+        }
+    };
+
+    auto worker = [&]() -> void
+    {
+        for(size_t index = next++; index < filenames.size(); index = next++) {
+            const std::string& filename(filenames[index]);
+            std::string        result;
+            try {
+                result = process(filename);
+            }
+            catch(const std::exception& e) {
+                result = base::Json::error(filename, e.what());
+            }
+            const std::lock_guard<std::mutex> lock(mutex);
+            _console.println("%s", result.c_str());
+        }
+    };
+
+    auto execute = [&]() -> void
+    {
+        std::vector<std::thread> threads;
+        const size_t count = std::min<size_t>(_jobs, filenames.size());
+        for(size_t index = 1; index < count; ++index) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    parse();
+    return execute();
+}
+
+// ---------------------------------------------------------------------------
+// VerifyCmd
+// ---------------------------------------------------------------------------
+
+VerifyCmd::VerifyCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "verify")
+{
+}
+
+auto VerifyCmd::process(const std::string& filename) -> std::string
+{
+    unsigned long sectors     = 0;
+    unsigned long errors      = 0;
+    unsigned long weak        = 0;
+    unsigned long truncated   = 0;
+    unsigned long unformatted = 0;
+
+    dsk::Disk disk(filename);
+    disk.load(true);
+
+    const unsigned tracks = disk.get_number_of_tracks();
+    const unsigned sides  = disk.get_number_of_sides();
+    for(unsigned track = 0; track < tracks; ++track) {
+        for(unsigned side = 0; side < sides; ++side) {
+            dsk::TrackIndex* index = disk.get_track(track, side);
+            if((index == nullptr) || (index->info == nullptr)) {
+                ++unformatted;
+                continue;
+            }
+            for(unsigned number = 0; number < index->count; ++number) {
+                const dsk::SectorIndex& sector(index->sector[number]);
+                const size_t nominal = (static_cast<size_t>(0x80) << (sector.info[3] & 7));
+                ++sectors;
+                if(((sector.info[4] & 0x37) != 0) || ((sector.info[5] & 0x21) != 0)) {
+                    ++errors;
+                }
+                if(sector.copies > 1) {
+                    ++weak;
+                }
+                if(sector.data.size < std::min<size_t>(nominal, 0x1800)) {
+                    ++truncated;
+                }
+            }
+        }
+    }
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", (truncated == 0))
+         + ',' + base::Json::field("extended", disk.is_extended())
+         + ',' + base::Json::field("compressed", disk.is_compressed())
+         + ',' + base::Json::field("tracks", static_cast<unsigned long>(tracks))
+         + ',' + base::Json::field("sides", static_cast<unsigned long>(sides))
+         + ',' + base::Json::field("sectors", sectors)
+         + ',' + base::Json::field("errors", errors)
+         + ',' + base::Json::field("weak", weak)
+         + ',' + base::Json::field("truncated", truncated)
+         + ',' + base::Json::field("unformatted", unformatted)
+         + '}';
+}
+
+// ---------------------------------------------------------------------------
+// CatalogCmd
+// ---------------------------------------------------------------------------
+
+CatalogCmd::CatalogCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "catalog")
+{
+}
+
+auto CatalogCmd::process(const std::string& filename) -> std::string
+{
+    dsk::Disk disk(filename);
+    disk.load(true);
+
+    const CatalogTraits::Format format(CatalogTraits::get_format(disk));
+    std::string                 entries;
+    for(auto& file : CatalogTraits::read_directory(disk, format)) {
+        std::string amsdos;
+        try {
+            amsdos = CatalogTraits::get_amsdos(CatalogTraits::read_file(disk, format, file));
+        }
+        catch(...) {
+            /* the catalog is still listed */
+        }
+        entries += (entries.empty() ? "{" : ",{");
+        entries += base::Json::field("user", static_cast<unsigned long>(file.user));
+        entries += ',' + base::Json::field("name", file.name);
+        entries += ',' + base::Json::field("size", static_cast<unsigned long>(CatalogTraits::get_size(file)));
+        entries += ',' + base::Json::field("readonly", file.readonly);
+        entries += ',' + base::Json::field("system", file.system);
+        if(amsdos.empty() == false) {
+            entries += ',' + base::Json::quote("amsdos") + ':' + amsdos;
+        }
+        entries += '}';
+    }
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", true)
+         + ',' + base::Json::field("format", format.name)
+         + ',' + base::Json::quote("entries") + ':' + '[' + entries + ']'
+         + '}';
+}
+
+// ---------------------------------------------------------------------------
+// ExtractCmd
+// ---------------------------------------------------------------------------
+
+ExtractCmd::ExtractCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "extract")
+{
+}
+
+auto ExtractCmd::process(const std::string& filename) -> std::string
+{
+    auto make_directory = [&](const std::string& dirname) -> void
+    {
+        if((::mkdir(dirname.c_str(), 0755) != 0) && (errno != EEXIST)) {
+            throw std::runtime_error(std::string() + '<' + dirname + '>' + ' ' + "could not be created");
+        }
+    };
+
+    auto get_basename = [&]() -> std::string
+    {
+        std::string basename(filename.substr(filename.find_last_of('/') + 1));
+        const size_t dot = basename.find('.');
+        if((dot != std::string::npos) && (dot != 0)) {
+            basename.erase(dot);
+        }
+        return basename;
+    };
+
+    auto write_file = [&](const std::string& pathname, const std::vector<uint8_t>& data) -> void
+    {
+        FILE* file = ::fopen(pathname.c_str(), "wb");
+        if(file == nullptr) {
+            throw std::runtime_error(std::string() + '<' + pathname + '>' + ' ' + "could not be opened");
+        }
+        const size_t count = ::fwrite(data.data(), 1, data.size(), file);
+        if((::fclose(file) != 0) || (count != data.size())) {
+            throw std::runtime_error(std::string() + '<' + pathname + '>' + ' ' + "could not be written");
+        }
+    };
+
+    dsk::Disk disk(filename);
+    disk.load(true);
+
+    const CatalogTraits::Format format(CatalogTraits::get_format(disk));
+    const std::string           dirname(_output + '/' + get_basename());
+    std::string                 files;
+    make_directory(dirname);
+    for(auto& file : CatalogTraits::read_directory(disk, format)) {
+        std::string pathname(dirname);
+        if(file.user != 0) {
+            pathname += "/user" + std::to_string(file.user);
+            make_directory(pathname);
+        }
+        std::string name(file.name);
+        std::replace(name.begin(), name.end(), '/', '_');
+        pathname += '/' + name;
+        write_file(pathname, CatalogTraits::read_file(disk, format, file));
+        files += (files.empty() ? "" : ",") + base::Json::quote(pathname);
+    }
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", true)
+         + ',' + base::Json::field("output", dirname)
+         + ',' + base::Json::quote("files") + ':' + '[' + files + ']'
+         + '}';
+}
+
 // ---------------------------------------------------------------------------
 // Program
 // ---------------------------------------------------------------------------
@@ -191,6 +790,26 @@ void Program::main()
         _command = std::make_unique<CreateCmd>(_console, _program);
     };
 
+    auto build_bench_cmd = [&]() -> void
+    {
+        _command = std::make_unique<BenchCmd>(_console, _program);
+    };
+
+    auto build_verify_cmd = [&]() -> void
+    {
+        _command = std::make_unique<VerifyCmd>(_console, _program);
+    };
+
+    auto build_catalog_cmd = [&]() -> void
+    {
+        _command = std::make_unique<CatalogCmd>(_console, _program);
+    };
+
+    auto build_extract_cmd = [&]() -> void
+    {
+        _command = std::make_unique<ExtractCmd>(_console, _program);
+    };
+
     auto build_command = [&](const std::string& command) -> void
     {
         if(command == "help") {
@@ -202,6 +821,18 @@ void Program::main()
         if(command == "create") {
             return build_create_cmd();
         }
+        if(command == "bench") {
+            return build_bench_cmd();
+        }
+        if(command == "verify") {
+            return build_verify_cmd();
+        }
+        if(command == "catalog") {
+            return build_catalog_cmd();
+        }
+        if(command == "extract") {
+            return build_extract_cmd();
+        }
         throw std::runtime_error(std::string() + '<' + command + '>' + ' ' + "is not a valid command");
     };
 
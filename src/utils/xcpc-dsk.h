@@ -20,6 +20,7 @@
 #include <xcpc/formats/dsk/dsk-format.h>
 #include "arglist.h"
 #include "console.h"
+#include "json.h"
 #include "program.h"
 
 // ---------------------------------------------------------------------------
@@ -101,6 +102,97 @@ public: // public interface
     virtual void run() override final;
 };
 
+// ---------------------------------------------------------------------------
+// BenchCmd
+// ---------------------------------------------------------------------------
+
+class BenchCmd final
+    : public Command
+{
+public: // public interface
+    BenchCmd ( base::Console&     console
+             , const std::string& program );
+
+    virtual ~BenchCmd() = default;
+
+    virtual void run() override final;
+};
+
+// ---------------------------------------------------------------------------
+// BatchCmd
+// ---------------------------------------------------------------------------
+
+class BatchCmd
+    : public Command
+{
+public: // public interface
+    BatchCmd ( base::Console&     console
+             , const std::string& program
+             , const std::string& command );
+
+    virtual ~BatchCmd() = default;
+
+    virtual void run() override;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string = 0;
+
+protected: // protected data
+    unsigned    _jobs;
+    std::string _output;
+};
+
+// ---------------------------------------------------------------------------
+// VerifyCmd
+// ---------------------------------------------------------------------------
+
+class VerifyCmd final
+    : public BatchCmd
+{
+public: // public interface
+    VerifyCmd ( base::Console&     console
+              , const std::string& program );
+
+    virtual ~VerifyCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
+// ---------------------------------------------------------------------------
+// CatalogCmd
+// ---------------------------------------------------------------------------
+
+class CatalogCmd final
+    : public BatchCmd
+{
+public: // public interface
+    CatalogCmd ( base::Console&     console
+               , const std::string& program );
+
+    virtual ~CatalogCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
+// ---------------------------------------------------------------------------
+// ExtractCmd
+// ---------------------------------------------------------------------------
+
+class ExtractCmd final
+    : public BatchCmd
+{
+public: // public interface
+    ExtractCmd ( base::Console&     console
+               , const std::string& program );
+
+    virtual ~ExtractCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
 // ---------------------------------------------------------------------------
 // Program
 // ---------------------------------------------------------------------------
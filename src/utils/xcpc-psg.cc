@@ -0,0 +1,361 @@
+/*
+ * xcpc-psg.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "xcpc-psg.h"
+
+// ---------------------------------------------------------------------------
+// some useful stuff
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t sample_rate = 44100;
+constexpr size_t   buffer_size = 4096;
+
+auto psg_type(const uint8_t chip) -> psg::Type
+{
+    switch(chip) {
+        case vgm::Chip::CHIP_AY8910:
+            return psg::Type::TYPE_AY8910;
+        case vgm::Chip::CHIP_AY8912:
+            return psg::Type::TYPE_AY8912;
+        case vgm::Chip::CHIP_AY8913:
+            return psg::Type::TYPE_AY8913;
+        case vgm::Chip::CHIP_YM2149:
+            return psg::Type::TYPE_YM2149;
+        default:
+            break;
+    }
+    return psg::Type::TYPE_AY8910;
+}
+
+auto wav_filename(const std::string& filename) -> std::string
+{
+    const std::string::size_type slash = filename.rfind('/');
+    const std::string::size_type dot   = filename.rfind('.');
+
+    if((dot != std::string::npos) && ((slash == std::string::npos) || (dot > slash))) {
+        return filename.substr(0, dot) + ".wav";
+    }
+    return filename + ".wav";
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// Command
+// ---------------------------------------------------------------------------
+
+Command::Command ( base::Console&     console
+                 , const std::string& program
+                 , const std::string& command )
+    : _console(console)
+    , _arguments()
+    , _program(program)
+    , _command(command)
+{
+}
+
+// ---------------------------------------------------------------------------
+// HelpCmd
+// ---------------------------------------------------------------------------
+
+HelpCmd::HelpCmd(base::Console& console, const std::string& program)
+    : Command(console, program, "help")
+{
+}
+
+void HelpCmd::run()
+{
+    _console.println("Usage: %s <command> [OPTIONS] [FILES]...", _program.c_str());
+    _console.println("");
+    _console.println("available commands:");
+    _console.println("");
+    _console.println("    help        display this help");
+    _console.println("    render      render a psg register log (vgm) into a wav file");
+    _console.println("");
+}
+
+// ---------------------------------------------------------------------------
+// RenderCmd
+// ---------------------------------------------------------------------------
+
+RenderCmd::RenderCmd(base::Console& console, const std::string& program)
+    : Command(console, program, "render")
+{
+}
+
+void RenderCmd::run()
+{
+    auto begin = [&](const std::string& filename)
+    {
+        _console.println("rendering '%s' ...", filename.c_str());
+    };
+
+    auto end = [&](const std::string& filename)
+    {
+        _console.println("rendered '%s'", filename.c_str());
+    };
+
+    auto render = [&](const std::string& filename)
+    {
+        vgm::Recording recording;
+        recording.load(filename);
+        Renderer renderer(recording, wav_filename(filename));
+        renderer.render();
+    };
+
+    auto error = [&](const std::string& filename, const char* what)
+    {
+        _console.errorln("error while rendering '%s': %s", filename.c_str(), what);
+    };
+
+    for(auto& filename : _arguments) {
+        begin(filename);
+        try {
+            render(filename);
+        }
+        catch(const std::exception& e) {
+            error(filename, e.what());
+        }
+        end(filename);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Renderer
+// ---------------------------------------------------------------------------
+
+Renderer::Renderer(vgm::Recording& recording, const std::string& filename)
+    : psg::Interface()
+    , vgm::Interface()
+    , _recording(recording)
+    , _psg(psg_type(recording.get_chip()), *this)
+    , _wave(filename, wav::Format::FORMAT_PCM16, 1, sample_rate)
+    , _clock(recording.get_clock())
+    , _ticks(0)
+    , _samples(0)
+    , _buffer()
+{
+    _buffer.reserve(buffer_size);
+}
+
+void Renderer::render()
+{
+    auto write = [&]()
+    {
+        _wave.write(_buffer.data(), _buffer.size());
+        _buffer.clear();
+    };
+
+    _recording.replay(*this);
+    write();
+    _wave.close();
+}
+
+auto Renderer::psg_port_a_rd(psg::Instance& instance, uint8_t data) -> uint8_t
+{
+    return data;
+}
+
+auto Renderer::psg_port_a_wr(psg::Instance& instance, uint8_t data) -> uint8_t
+{
+    return data;
+}
+
+auto Renderer::psg_port_b_rd(psg::Instance& instance, uint8_t data) -> uint8_t
+{
+    return data;
+}
+
+auto Renderer::psg_port_b_wr(psg::Instance& instance, uint8_t data) -> uint8_t
+{
+    return data;
+}
+
+auto Renderer::vgm_delay(vgm::Recording& recording, uint32_t samples) -> void
+{
+    auto advance = [&]()
+    {
+        const uint64_t ticks = (((_samples + 1) * _clock) / sample_rate);
+        _psg.defer(static_cast<uint32_t>(ticks - _ticks));
+        _psg.flush();
+        _ticks = ticks;
+        ++_samples;
+    };
+
+    auto mix = [&]()
+    {
+        const auto& output(_psg.get_output());
+        const int32_t mono = (output.channel0 * 1)
+                           + (output.channel1 * 1)
+                           + (output.channel2 * 1)
+                           ;
+        _buffer.push_back(static_cast<float>(mono) / (3.0f * 32768.0f));
+    };
+
+    auto write = [&]()
+    {
+        if(_buffer.size() >= buffer_size) {
+            _wave.write(_buffer.data(), _buffer.size());
+            _buffer.clear();
+        }
+    };
+
+    while(samples-- != 0) {
+        advance();
+        mix();
+        write();
+    }
+}
+
+auto Renderer::vgm_write(vgm::Recording& recording, uint8_t index, uint8_t value) -> void
+{
+    _psg.set_index(index);
+    _psg.set_value(value);
+}
+
+// ---------------------------------------------------------------------------
+// Program
+// ---------------------------------------------------------------------------
+
+Program::Program(base::ArgList& arglist, base::Console& console)
+    : base::Program(arglist, console)
+    , _program("xcpc-psg")
+    , _command()
+{
+}
+
+void Program::main()
+{
+    auto set_program = [&](const std::string& argument) -> void
+    {
+        const char* c_str = argument.c_str();
+        const char* slash = ::strrchr(c_str, '/');
+        if(slash != nullptr) {
+            c_str = slash + 1;
+            _program = c_str;
+        }
+    };
+
+    auto build_help_cmd = [&]() -> void
+    {
+        _command = std::make_unique<HelpCmd>(_console, _program);
+    };
+
+    auto build_render_cmd = [&]() -> void
+    {
+        _command = std::make_unique<RenderCmd>(_console, _program);
+    };
+
+    auto build_command = [&](const std::string& command) -> void
+    {
+        if(command == "help") {
+            return build_help_cmd();
+        }
+        if(command == "render") {
+            return build_render_cmd();
+        }
+        throw std::runtime_error(std::string() + '<' + command + '>' + ' ' + "is not a valid command");
+    };
+
+    auto add_argument = [&](const std::string& argument) -> void
+    {
+        if(_command) {
+            _command->addArgument(argument);
+        }
+    };
+
+    auto run_command = [&]() -> void
+    {
+        if(!_command) {
+            build_help_cmd();
+        }
+        return _command->run();
+    };
+
+    auto parse = [&]() -> void
+    {
+        int argi = 0;
+        for(auto& argument : _arglist) {
+            if(argi == 0) {
+                set_program(argument);
+            }
+            else if(argi == 1) {
+                build_command(argument);
+            }
+            else if(argi > 0) {
+                add_argument(argument);
+            }
+            ++argi;
+        }
+    };
+
+    auto execute = [&]() -> void
+    {
+        parse();
+        run_command();
+    };
+
+    return execute();
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    base::ArgList arglist ( argc
+                          , argv );
+
+    base::Console console ( std::cin
+                          , std::cout
+                          , std::cerr );
+
+    try {
+        Program program(arglist, console);
+
+        program.main();
+    }
+    catch(const std::exception& e) {
+        console.errorln("error: %s", e.what());
+        return EXIT_FAILURE;
+    }
+    catch(...) {
+        console.errorln("error: %s", "unhandled exception");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
@@ -0,0 +1,154 @@
+/*
+ * xcpc-psg.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_PSG_H__
+#define __XCPC_PSG_H__
+
+#include <xcpc/amstrad/psg/psg-core.h>
+#include <xcpc/formats/vgm/vgm-format.h>
+#include <xcpc/formats/wav/wav-format.h>
+#include "arglist.h"
+#include "console.h"
+#include "program.h"
+
+// ---------------------------------------------------------------------------
+// Command
+// ---------------------------------------------------------------------------
+
+class Command
+{
+public: // public interface
+    Command ( base::Console&     console
+            , const std::string& program
+            , const std::string& command );
+
+    Command(const Command&) = delete;
+
+    Command& operator=(const Command&) = delete;
+
+    virtual ~Command() = default;
+
+    virtual void run() = 0;
+
+    void addArgument(const std::string& argument)
+    {
+        _arguments.add(argument);
+    }
+
+protected: // protected data
+    base::Console&    _console;
+    base::ArgList     _arguments;
+    const std::string _program;
+    const std::string _command;
+};
+
+// ---------------------------------------------------------------------------
+// HelpCmd
+// ---------------------------------------------------------------------------
+
+class HelpCmd final
+    : public Command
+{
+public: // public interface
+    HelpCmd ( base::Console&     console
+            , const std::string& program );
+
+    virtual ~HelpCmd() = default;
+
+    virtual void run() override final;
+};
+
+// ---------------------------------------------------------------------------
+// RenderCmd
+// ---------------------------------------------------------------------------
+
+class RenderCmd final
+    : public Command
+{
+public: // public interface
+    RenderCmd ( base::Console&     console
+              , const std::string& program );
+
+    virtual ~RenderCmd() = default;
+
+    virtual void run() override final;
+};
+
+// ---------------------------------------------------------------------------
+// Renderer
+// ---------------------------------------------------------------------------
+
+class Renderer final
+    : private psg::Interface
+    , private vgm::Interface
+{
+public: // public interface
+    Renderer ( vgm::Recording&    recording
+             , const std::string& filename );
+
+    Renderer(const Renderer&) = delete;
+
+    Renderer& operator=(const Renderer&) = delete;
+
+    virtual ~Renderer() = default;
+
+    void render();
+
+private: // psg interface
+    virtual auto psg_port_a_rd(psg::Instance& instance, uint8_t data) -> uint8_t override final;
+    virtual auto psg_port_a_wr(psg::Instance& instance, uint8_t data) -> uint8_t override final;
+    virtual auto psg_port_b_rd(psg::Instance& instance, uint8_t data) -> uint8_t override final;
+    virtual auto psg_port_b_wr(psg::Instance& instance, uint8_t data) -> uint8_t override final;
+
+private: // vgm interface
+    virtual auto vgm_delay(vgm::Recording& recording, uint32_t samples) -> void override final;
+    virtual auto vgm_write(vgm::Recording& recording, uint8_t index, uint8_t value) -> void override final;
+
+private: // private data
+    vgm::Recording&    _recording;
+    psg::Instance      _psg;
+    wav::WaveWriter    _wave;
+    uint64_t           _clock;
+    uint64_t           _ticks;
+    uint64_t           _samples;
+    std::vector<float> _buffer;
+};
+
+// ---------------------------------------------------------------------------
+// Program
+// ---------------------------------------------------------------------------
+
+class Program final
+    : public base::Program
+{
+public: // public interface
+    Program ( base::ArgList& arglist
+            , base::Console& console );
+
+    virtual ~Program() = default;
+
+    virtual void main() override final;
+
+protected: // protected data
+    std::string              _program;
+    std::unique_ptr<Command> _command;
+};
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_PSG_H__ */
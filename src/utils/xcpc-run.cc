@@ -0,0 +1,647 @@
+/*
+ * xcpc-run.cc - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include "xcpc-run.h"
+
+// ---------------------------------------------------------------------------
+// <anonymous>::DigestTraits
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct DigestTraits
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        unsigned long frame;
+        uint64_t      video;
+        uint64_t      audio;
+    };
+
+    struct Golden
+    {
+        unsigned long            frames;
+        unsigned long            every;
+        std::vector<std::string> options;
+        std::vector<Entry>       entries;
+    };
+
+    static constexpr const char* MAGIC = "xcpc-digest 1";
+
+    static auto is_loglevel(const std::string& option) -> bool
+    {
+        return (option == "--quiet") || (option == "--trace") || (option == "--debug");
+    }
+
+    static auto to_hex(const uint64_t value) -> std::string
+    {
+        char buffer[32];
+
+        static_cast<void>(::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value)));
+
+        return buffer;
+    }
+
+    static auto has_suffix(const std::string& filename, const char* suffix) -> bool
+    {
+        const size_t length = ::strlen(suffix);
+
+        if(filename.size() < length) {
+            return false;
+        }
+        const char* string = filename.c_str() + (filename.size() - length);
+        for(size_t index = 0; index < length; ++index) {
+            if(::tolower(string[index]) != ::tolower(suffix[index])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static auto setup(cpc::Settings& settings, const std::vector<std::string>& options, const std::string& filename) -> void
+    {
+        std::string        program("xcpc-run");
+        std::vector<char*> arguments;
+
+        arguments.push_back(&program[0]);
+        for(auto& option : options) {
+            /* the loglevel is process-wide, it is never set by a worker */
+            if(is_loglevel(option) == false) {
+                arguments.push_back(const_cast<char*>(option.c_str()));
+            }
+        }
+        arguments.push_back(nullptr);
+        /* parse the emulator options */ {
+            int    argc = (arguments.size() - 1);
+            char** argv = arguments.data();
+            settings.parse(argc, argv);
+            if(argc > 1) {
+                throw std::runtime_error(std::string() + '<' + argv[1] + '>' + ' ' + "is not a valid option");
+            }
+        }
+        if(has_suffix(filename, ".sna")) {
+            settings.opt_snapshot = filename;
+        }
+        else if(has_suffix(filename, ".mov")) {
+            settings.opt_replay = filename;
+        }
+        else {
+            settings.opt_drive0 = filename;
+        }
+        /* the digest drains the audio ring in place of the audio device */ {
+            settings.opt_audio = false;
+        }
+    }
+
+    static auto run(const std::string& filename, Golden& golden) -> unsigned long
+    {
+        const auto         started = Clock::now();
+        cpc::Settings      settings;
+        cpc::FrameDigest   digest = { 0, 0 };
+
+        setup(settings, golden.options, filename);
+        cpc::Machine machine(settings);
+        golden.entries.clear();
+        for(unsigned long frame = 1; frame <= golden.frames; ++frame) {
+            machine.clock();
+            machine.digest_frame(digest);
+            if((frame % golden.every) == 0) {
+                golden.entries.push_back(Entry { frame, digest.video, digest.audio });
+            }
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started).count();
+    }
+
+    static auto load(const std::string& filename, Golden& golden) -> void
+    {
+        FILE* file = ::fopen(filename.c_str(), "r");
+        char  line[4096];
+
+        auto read_line = [&]() -> bool
+        {
+            if(::fgets(line, sizeof(line), file) == nullptr) {
+                return false;
+            }
+            line[::strcspn(line, "\r\n")] = '\0';
+            return true;
+        };
+
+        auto parse_line = [&]() -> void
+        {
+            unsigned long long video = 0;
+            unsigned long long audio = 0;
+            unsigned long      frame = 0;
+            if(::strncmp(line, "frames ", 7) == 0) {
+                golden.frames = ::strtoul(line + 7, nullptr, 10);
+            }
+            else if(::strncmp(line, "every ", 6) == 0) {
+                golden.every = ::strtoul(line + 6, nullptr, 10);
+            }
+            else if(::strncmp(line, "option ", 7) == 0) {
+                golden.options.push_back(line + 7);
+            }
+            else if(::sscanf(line, "%lu %llx %llx", &frame, &video, &audio) == 3) {
+                golden.entries.push_back(Entry { frame, video, audio });
+            }
+            else {
+                throw std::runtime_error(std::string() + "invalid line in <" + filename + '>');
+            }
+        };
+
+        auto parse = [&]() -> void
+        {
+            if((read_line() == false) || (::strcmp(line, MAGIC) != 0)) {
+                throw std::runtime_error(std::string() + '<' + filename + '>' + ' ' + "is not a digest file");
+            }
+            while(read_line() != false) {
+                parse_line();
+            }
+            if((golden.frames == 0) || (golden.every == 0)) {
+                throw std::runtime_error(std::string() + '<' + filename + '>' + ' ' + "has no frame count");
+            }
+        };
+
+        if(file == nullptr) {
+            throw std::runtime_error(std::string() + "unable to open <" + filename + '>');
+        }
+        try {
+            parse();
+        }
+        catch(...) {
+            file = (static_cast<void>(::fclose(file)), nullptr);
+            throw;
+        }
+        file = (static_cast<void>(::fclose(file)), nullptr);
+    }
+
+    static auto save(const std::string& filename, const Golden& golden) -> void
+    {
+        const std::string temporary(filename + ".new");
+        FILE*             file = ::fopen(temporary.c_str(), "w");
+        int               error = 0;
+
+        if(file == nullptr) {
+            throw std::runtime_error(std::string() + "unable to create <" + temporary + '>');
+        }
+        /* write header */ {
+            error |= (::fprintf(file, "%s\n", MAGIC) < 0);
+            error |= (::fprintf(file, "frames %lu\n", golden.frames) < 0);
+            error |= (::fprintf(file, "every %lu\n", golden.every) < 0);
+            for(auto& option : golden.options) {
+                error |= (::fprintf(file, "option %s\n", option.c_str()) < 0);
+            }
+        }
+        /* write entries */ {
+            for(auto& entry : golden.entries) {
+                error |= (::fprintf(file, "%lu %016llx %016llx\n", entry.frame, static_cast<unsigned long long>(entry.video), static_cast<unsigned long long>(entry.audio)) < 0);
+            }
+        }
+        error |= (::fclose(file) != 0);
+        if((error != 0) || (::rename(temporary.c_str(), filename.c_str()) != 0)) {
+            static_cast<void>(::remove(temporary.c_str()));
+            throw std::runtime_error(std::string() + "unable to write <" + filename + '>');
+        }
+    }
+};
+
+constexpr const char* DigestTraits::MAGIC;
+
+}
+
+// ---------------------------------------------------------------------------
+// Command
+// ---------------------------------------------------------------------------
+
+Command::Command ( base::Console&     console
+                 , const std::string& program
+                 , const std::string& command )
+    : _console(console)
+    , _arguments()
+    , _program(program)
+    , _command(command)
+{
+}
+
+// ---------------------------------------------------------------------------
+// HelpCmd
+// ---------------------------------------------------------------------------
+
+HelpCmd::HelpCmd(base::Console& console, const std::string& program)
+    : Command(console, program, "help")
+{
+}
+
+void HelpCmd::run()
+{
+    _console.println("Usage: %s <command> [OPTIONS] [FILES]...", _program.c_str());
+    _console.println("");
+    _console.println("available commands:");
+    _console.println("");
+    _console.println("    help        display this help");
+    _console.println("    record      run snapshots, disks or movies and write their golden digests");
+    _console.println("    verify      run snapshots, disks or movies and compare them to their golden digests");
+    _console.println("    batch       run snapshots, disks or movies and print their final digests");
+    _console.println("");
+    _console.println("each file boots a headless machine without audio output (.sna is loaded, .mov");
+    _console.println("is replayed, anything else is inserted into drive A), the machines are run in");
+    _console.println("this process by a pool of workers, one machine per worker, the results are");
+    _console.println("printed as one JSON object per file and the commands accept:");
+    _console.println("");
+    _console.println("    --jobs={count}     number of machines run concurrently");
+    _console.println("    --frames={count}   number of frames to emulate (default: 500)");
+    _console.println("    --every={count}    keep the digest of every {count} frames (default: 10)");
+    _console.println("    --golden={dir}     golden digests directory (default: next to the files)");
+    _console.println("");
+    _console.println("any other option is passed to the emulator (--machine=, --sysrom=, ...) and is");
+    _console.println("stored by record into the golden digest, verify replays the stored options.");
+    _console.println("--quiet, --trace and --debug apply to the whole process and are not stored.");
+    _console.println("");
+}
+
+// ---------------------------------------------------------------------------
+// BatchCmd
+// ---------------------------------------------------------------------------
+
+BatchCmd::BatchCmd(base::Console& console, const std::string& program, const std::string& command)
+    : Command(console, program, command)
+    , _jobs(std::max(1U, std::thread::hardware_concurrency()))
+    , _frames(500)
+    , _every(10)
+    , _golden()
+    , _options()
+    , _failures(0)
+{
+}
+
+void BatchCmd::run()
+{
+    std::vector<std::string> filenames;
+    std::atomic<size_t>      next(0);
+    std::mutex               mutex;
+
+    auto parse = [&]() -> void
+    {
+        for(auto& argument : _arguments) {
+            if(argument.compare(0, 7, "--jobs=") == 0) {
+                _jobs = std::max(1, std::atoi(argument.c_str() + 7));
+            }
+            else if(argument.compare(0, 9, "--frames=") == 0) {
+                _frames = std::max(1L, std::atol(argument.c_str() + 9));
+            }
+            else if(argument.compare(0, 8, "--every=") == 0) {
+                _every = std::max(1L, std::atol(argument.c_str() + 8));
+            }
+            else if(argument.compare(0, 9, "--golden=") == 0) {
+                _golden = argument.substr(9);
+            }
+            else if(argument == "--quiet") {
+                static_cast<void>(::xcpc_set_loglevel(XCPC_LOGLEVEL_QUIET));
+            }
+            else if(argument == "--trace") {
+                static_cast<void>(::xcpc_set_loglevel(XCPC_LOGLEVEL_TRACE));
+            }
+            else if(argument == "--debug") {
+                static_cast<void>(::xcpc_set_loglevel(XCPC_LOGLEVEL_DEBUG));
+            }
+            else if(argument.compare(0, 2, "--") == 0) {
+                _options.push_back(argument);
+            }
+            else {
+                filenames.push_back(argument);
+            }
+        }
+    };
+
+    auto worker = [&]() -> void
+    {
+        for(size_t index = next++; index < filenames.size(); index = next++) {
+            const std::string& filename(filenames[index]);
+            std::string        result;
+            try {
+                result = process(filename);
+            }
+            catch(const std::exception& e) {
+                result = base::Json::error(filename, e.what());
+                ++_failures;
+            }
+            const std::lock_guard<std::mutex> lock(mutex);
+            _console.println("%s", result.c_str());
+        }
+    };
+
+    auto execute = [&]() -> void
+    {
+        std::vector<std::thread> threads;
+        const size_t count = std::min<size_t>(_jobs, filenames.size());
+        for(size_t index = 1; index < count; ++index) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    auto check = [&]() -> void
+    {
+        if(_failures != 0) {
+            throw std::runtime_error(std::to_string(_failures) + " of " + std::to_string(filenames.size()) + " file(s) failed");
+        }
+    };
+
+    parse();
+    execute();
+    return check();
+}
+
+auto BatchCmd::golden_of(const std::string& filename) const -> std::string
+{
+    if(_golden.empty()) {
+        return filename + ".digest";
+    }
+    const std::string::size_type slash = filename.rfind('/');
+    if(slash != std::string::npos) {
+        return _golden + '/' + filename.substr(slash + 1) + ".digest";
+    }
+    return _golden + '/' + filename + ".digest";
+}
+
+// ---------------------------------------------------------------------------
+// RecordCmd
+// ---------------------------------------------------------------------------
+
+RecordCmd::RecordCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "record")
+{
+}
+
+auto RecordCmd::process(const std::string& filename) -> std::string
+{
+    const std::string    golden_file(golden_of(filename));
+    DigestTraits::Golden golden { _frames, _every, _options, {} };
+
+    const unsigned long msec = DigestTraits::run(filename, golden);
+    DigestTraits::save(golden_file, golden);
+
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", true)
+         + ',' + base::Json::field("golden", golden_file)
+         + ',' + base::Json::field("frames", golden.frames)
+         + ',' + base::Json::field("digests", static_cast<unsigned long>(golden.entries.size()))
+         + ',' + base::Json::field("msec", msec)
+         + '}';
+}
+
+// ---------------------------------------------------------------------------
+// VerifyCmd
+// ---------------------------------------------------------------------------
+
+VerifyCmd::VerifyCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "verify")
+{
+}
+
+auto VerifyCmd::process(const std::string& filename) -> std::string
+{
+    DigestTraits::Golden expected { 0, 0, {}, {} };
+    DigestTraits::load(golden_of(filename), expected);
+    DigestTraits::Golden actual { expected.frames, expected.every, expected.options, {} };
+    const unsigned long  msec = DigestTraits::run(filename, actual);
+
+    auto diverged = [&](const DigestTraits::Entry& wanted, const DigestTraits::Entry& got) -> std::string
+    {
+        std::string streams;
+        if(wanted.video != got.video) {
+            streams += "video";
+        }
+        if(wanted.audio != got.audio) {
+            streams += (streams.empty() ? "audio" : ",audio");
+        }
+        ++_failures;
+        return '{' + base::Json::field("file", filename)
+             + ',' + base::Json::field("ok", false)
+             + ',' + base::Json::field("diverged", wanted.frame)
+             + ',' + base::Json::field("streams", streams)
+             + ',' + base::Json::field("msec", msec)
+             + '}';
+    };
+
+    if(actual.entries.size() != expected.entries.size()) {
+        throw std::runtime_error("the golden digest does not match its frame count");
+    }
+    for(size_t index = 0; index < expected.entries.size(); ++index) {
+        const DigestTraits::Entry& wanted(expected.entries[index]);
+        const DigestTraits::Entry& got(actual.entries[index]);
+        if(wanted.frame != got.frame) {
+            throw std::runtime_error("the golden digest does not match its frame count");
+        }
+        if((wanted.video != got.video) || (wanted.audio != got.audio)) {
+            return diverged(wanted, got);
+        }
+    }
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", true)
+         + ',' + base::Json::field("frames", actual.frames)
+         + ',' + base::Json::field("digests", static_cast<unsigned long>(actual.entries.size()))
+         + ',' + base::Json::field("msec", msec)
+         + '}';
+}
+
+// ---------------------------------------------------------------------------
+// RunCmd
+// ---------------------------------------------------------------------------
+
+RunCmd::RunCmd(base::Console& console, const std::string& program)
+    : BatchCmd(console, program, "batch")
+{
+}
+
+auto RunCmd::process(const std::string& filename) -> std::string
+{
+    DigestTraits::Golden actual { _frames, _frames, _options, {} };
+    const unsigned long  msec = DigestTraits::run(filename, actual);
+    const auto&          last(actual.entries.back());
+
+    return '{' + base::Json::field("file", filename)
+         + ',' + base::Json::field("ok", true)
+         + ',' + base::Json::field("frames", actual.frames)
+         + ',' + base::Json::field("video", DigestTraits::to_hex(last.video))
+         + ',' + base::Json::field("audio", DigestTraits::to_hex(last.audio))
+         + ',' + base::Json::field("msec", msec)
+         + '}';
+}
+
+// ---------------------------------------------------------------------------
+// Program
+// ---------------------------------------------------------------------------
+
+Program::Program(base::ArgList& arglist, base::Console& console)
+    : base::Program(arglist, console)
+    , _program("xcpc-run")
+    , _command()
+{
+}
+
+void Program::main()
+{
+    auto set_program = [&](const std::string& argument) -> void
+    {
+        const char* c_str = argument.c_str();
+        const char* slash = ::strrchr(c_str, '/');
+        if(slash != nullptr) {
+            c_str = slash + 1;
+            _program = c_str;
+        }
+    };
+
+    auto build_help_cmd = [&]() -> void
+    {
+        _command = std::make_unique<HelpCmd>(_console, _program);
+    };
+
+    auto build_record_cmd = [&]() -> void
+    {
+        _command = std::make_unique<RecordCmd>(_console, _program);
+    };
+
+    auto build_verify_cmd = [&]() -> void
+    {
+        _command = std::make_unique<VerifyCmd>(_console, _program);
+    };
+
+    auto build_run_cmd = [&]() -> void
+    {
+        _command = std::make_unique<RunCmd>(_console, _program);
+    };
+
+    auto build_command = [&](const std::string& command) -> void
+    {
+        if(command == "help") {
+            return build_help_cmd();
+        }
+        if(command == "record") {
+            return build_record_cmd();
+        }
+        if(command == "verify") {
+            return build_verify_cmd();
+        }
+        if(command == "batch") {
+            return build_run_cmd();
+        }
+        throw std::runtime_error(std::string() + '<' + command + '>' + ' ' + "is not a valid command");
+    };
+
+    auto add_argument = [&](const std::string& argument) -> void
+    {
+        if(_command) {
+            _command->addArgument(argument);
+        }
+    };
+
+    auto run_command = [&]() -> void
+    {
+        if(!_command) {
+            build_help_cmd();
+        }
+        return _command->run();
+    };
+
+    auto parse = [&]() -> void
+    {
+        int argi = 0;
+        for(auto& argument : _arglist) {
+            if(argi == 0) {
+                set_program(argument);
+            }
+            else if(argi == 1) {
+                build_command(argument);
+            }
+            else if(argi > 0) {
+                add_argument(argument);
+            }
+            ++argi;
+        }
+    };
+
+    auto execute = [&]() -> void
+    {
+        parse();
+        run_command();
+    };
+
+    return execute();
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    base::ArgList arglist ( argc
+                          , argv );
+
+    base::Console console ( std::cin
+                          , std::cout
+                          , std::cerr );
+
+    int status = EXIT_SUCCESS;
+
+    ::xcpc_begin();
+    try {
+        Program program(arglist, console);
+
+        program.main();
+    }
+    catch(const std::exception& e) {
+        console.errorln("error: %s", e.what());
+        status = EXIT_FAILURE;
+    }
+    catch(...) {
+        console.errorln("error: %s", "unhandled exception");
+        status = EXIT_FAILURE;
+    }
+    ::xcpc_end();
+
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
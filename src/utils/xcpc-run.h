@@ -0,0 +1,178 @@
+/*
+ * xcpc-run.h - Copyright (c) 2001-2025 - Olivier Poncet
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __XCPC_RUN_H__
+#define __XCPC_RUN_H__
+
+#include <xcpc/amstrad/cpc/cpc-machine.h>
+#include "arglist.h"
+#include "console.h"
+#include "json.h"
+#include "program.h"
+
+// ---------------------------------------------------------------------------
+// Command
+// ---------------------------------------------------------------------------
+
+class Command
+{
+public: // public interface
+    Command ( base::Console&     console
+            , const std::string& program
+            , const std::string& command );
+
+    Command(const Command&) = delete;
+
+    Command& operator=(const Command&) = delete;
+
+    virtual ~Command() = default;
+
+    virtual void run() = 0;
+
+    void addArgument(const std::string& argument)
+    {
+        _arguments.add(argument);
+    }
+
+protected: // protected data
+    base::Console&    _console;
+    base::ArgList     _arguments;
+    const std::string _program;
+    const std::string _command;
+};
+
+// ---------------------------------------------------------------------------
+// HelpCmd
+// ---------------------------------------------------------------------------
+
+class HelpCmd final
+    : public Command
+{
+public: // public interface
+    HelpCmd ( base::Console&     console
+            , const std::string& program );
+
+    virtual ~HelpCmd() = default;
+
+    virtual void run() override final;
+};
+
+// ---------------------------------------------------------------------------
+// BatchCmd
+// ---------------------------------------------------------------------------
+
+class BatchCmd
+    : public Command
+{
+public: // public interface
+    BatchCmd ( base::Console&     console
+             , const std::string& program
+             , const std::string& command );
+
+    virtual ~BatchCmd() = default;
+
+    virtual void run() override;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string = 0;
+
+    auto golden_of(const std::string& filename) const -> std::string;
+
+protected: // protected data
+    unsigned                 _jobs;
+    unsigned long            _frames;
+    unsigned long            _every;
+    std::string              _golden;
+    std::vector<std::string> _options;
+    std::atomic<unsigned>    _failures;
+};
+
+// ---------------------------------------------------------------------------
+// RecordCmd
+// ---------------------------------------------------------------------------
+
+class RecordCmd final
+    : public BatchCmd
+{
+public: // public interface
+    RecordCmd ( base::Console&     console
+              , const std::string& program );
+
+    virtual ~RecordCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
+// ---------------------------------------------------------------------------
+// VerifyCmd
+// ---------------------------------------------------------------------------
+
+class VerifyCmd final
+    : public BatchCmd
+{
+public: // public interface
+    VerifyCmd ( base::Console&     console
+              , const std::string& program );
+
+    virtual ~VerifyCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
+// ---------------------------------------------------------------------------
+// RunCmd
+// ---------------------------------------------------------------------------
+
+class RunCmd final
+    : public BatchCmd
+{
+public: // public interface
+    RunCmd ( base::Console&     console
+           , const std::string& program );
+
+    virtual ~RunCmd() = default;
+
+protected: // protected interface
+    virtual auto process(const std::string& filename) -> std::string override final;
+};
+
+// ---------------------------------------------------------------------------
+// Program
+// ---------------------------------------------------------------------------
+
+class Program final
+    : public base::Program
+{
+public: // public interface
+    Program ( base::ArgList& arglist
+            , base::Console& console );
+
+    virtual ~Program() = default;
+
+    virtual void main() override final;
+
+protected: // protected data
+    std::string              _program;
+    std::unique_ptr<Command> _command;
+};
+
+// ---------------------------------------------------------------------------
+// End-Of-File
+// ---------------------------------------------------------------------------
+
+#endif /* __XCPC_RUN_H__ */
@@ -103,7 +103,9 @@ Application::Application(int& argc, char**& argv)
     , _argv(argv)
     , _settings(new cpc::Settings(argc, argv))
     , _machine(new cpc::Machine(*_settings))
+    , _library(new sna::Library(xcpc::Utils::get_snadir()))
 {
+    _library->start();
 }
 
 void Application::run_dialog(Dialog& dialog)
@@ -19,6 +19,7 @@
 
 #include <xcpc/libxcpc-cxx.h>
 #include <xcpc/amstrad/cpc/cpc-machine.h>
+#include <xcpc/formats/sna/sna-library.h>
 
 // ---------------------------------------------------------------------------
 // TranslationTraits
@@ -120,6 +121,11 @@ public: // public interface
         return _machine->get_backend();
     }
 
+    auto get_snapshot_library() const -> sna::Library&
+    {
+        return *_library;
+    }
+
 public: // public methods
     virtual auto load_snapshot(const std::string& filename) -> void = 0;
 
@@ -133,6 +139,14 @@ public: // public methods
 
     virtual auto reset_emulator() -> void = 0;
 
+    virtual auto rewind_emulator() -> void = 0;
+
+    virtual auto quick_save_emulator() -> void = 0;
+
+    virtual auto quick_load_emulator() -> void = 0;
+
+    virtual auto next_quick_slot() -> void = 0;
+
     virtual auto create_disk_into_drive0(const std::string& filename) -> void = 0;
 
     virtual auto insert_disk_into_drive0(const std::string& filename) -> void = 0;
@@ -174,6 +188,12 @@ public: // public signals
 
     virtual auto on_snapshot_save() -> void = 0;
 
+    virtual auto on_quick_save() -> void = 0;
+
+    virtual auto on_quick_load() -> void = 0;
+
+    virtual auto on_quick_slot() -> void = 0;
+
     virtual auto on_exit() -> void = 0;
 
     virtual auto on_emulator_play() -> void = 0;
@@ -182,6 +202,8 @@ public: // public signals
 
     virtual auto on_emulator_reset() -> void = 0;
 
+    virtual auto on_emulator_rewind() -> void = 0;
+
     virtual auto on_machine_cpc464() -> void = 0;
 
     virtual auto on_machine_cpc664() -> void = 0;
@@ -259,6 +281,7 @@ public: // public signals
 protected: // protected interface
     using SettingsPtr = std::unique_ptr<cpc::Settings>;
     using MachinePtr  = std::unique_ptr<cpc::Machine>;
+    using LibraryPtr  = std::unique_ptr<sna::Library>;
 
     virtual auto run_dialog(Dialog&) -> void;
 
@@ -267,6 +290,7 @@ protected: // protected data
     char**&           _argv;
     const SettingsPtr _settings;
     const MachinePtr  _machine;
+    const LibraryPtr  _library;
 };
 
 }